@@ -0,0 +1,298 @@
+/*
+ * AsyncQueue.hpp
+ *
+ * Header-only C++20 interface for a fixed-size Queue awaited from coroutines.
+ *
+ * co_await queue.deq() and co_await queue.enq(element) suspend the calling coroutine,
+ * not its thread, while the queue is empty or full. Two permit counters stand in for the
+ * C BlockingQueue's current_size and available semaphores, except that they may go
+ * negative: a negative count is the number of coroutines owed an element or a slot. A
+ * waiting coroutine links its awaiter, which lives in its own frame, onto a lock-free
+ * list, so waiting allocates nothing and makes no system call. Whoever releases a permit
+ * to a waiter hands its coroutine to the queue's AsyncScheduler to be resumed, oldest
+ * waiter first.
+ *
+ * Elements move through a ring of slots claimed by ticket, as in MpmcQueue; a permit
+ * guarantees the slot it leads to is ready or about to be, so neither side ever fails
+ * once it holds one.
+ *
+ */
+
+#ifndef ASYNC_QUEUE_HPP_
+#define ASYNC_QUEUE_HPP_
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <thread>
+#include <utility>
+
+namespace cqueue {
+
+/*
+ * Decides where a coroutine woken by an AsyncQueue runs next
+ */
+class AsyncScheduler {
+public:
+    virtual ~AsyncScheduler() = default;
+
+    /*
+     * Arranges for handle to be resumed, on this thread or another.
+     */
+    virtual void schedule(std::coroutine_handle<> handle) = 0;
+};
+
+/*
+ * Resumes woken coroutines straight away on the thread that woke them
+ */
+class InlineScheduler : public AsyncScheduler {
+public:
+    void schedule(std::coroutine_handle<> handle) override { handle.resume(); }
+
+    /*
+     * Returns the InlineScheduler shared by every AsyncQueue not given one.
+     */
+    static InlineScheduler& instance() {
+        static InlineScheduler scheduler;
+        return scheduler;
+    }
+};
+
+/*
+ * A suspended coroutine in a waiter list; embedded in the awaiter, so it lives in the coroutine frame
+ */
+struct AsyncWaiter {
+    std::coroutine_handle<> handle;
+    AsyncWaiter* next = nullptr;
+};
+
+/*
+ * Intrusive list of waiters, woken in the order they started waiting.
+ * Pushes go onto a lock-free stack. A pop takes the whole stack with one exchange only once
+ * the waiters it took last time are used up, and reverses it, so the oldest waiter comes out
+ * first. Pops are serialised by a spin flag; pushes never wait for them, and since a pop never
+ * compare-exchanges the stack's head, a waiter popped, resumed and pushed again cannot confuse
+ * it (ABA).
+ */
+class AsyncWaiterList {
+public:
+    void push(AsyncWaiter* waiter) {
+        waiter->next = incoming_.load(std::memory_order_relaxed);
+        while (!incoming_.compare_exchange_weak(waiter->next, waiter, std::memory_order_release,
+                                                std::memory_order_relaxed)) {
+        }
+    }
+
+    /*
+     * Removes and returns the oldest waiter. The caller must know one is on its way: a waiter
+     * takes its permit before it pushes itself, so this may briefly spin for the push.
+     */
+    AsyncWaiter* pop() {
+        while (popping_.test_and_set(std::memory_order_acquire))
+            std::this_thread::yield();
+
+        for (int spins = 0; ready_ == nullptr; spins++) {
+            // everything pushed since the last take, newest first, is newer than anything taken before
+            AsyncWaiter* list = incoming_.exchange(nullptr, std::memory_order_acquire);
+            while (list != nullptr) {
+                AsyncWaiter* next = list->next;
+                list->next = ready_;
+                ready_ = list;
+                list = next;
+            }
+            if (ready_ == nullptr && spins > 100)
+                std::this_thread::yield();
+        }
+        AsyncWaiter* waiter = ready_;
+        ready_ = waiter->next;
+
+        popping_.clear(std::memory_order_release);
+        return waiter;
+    }
+
+private:
+    std::atomic<AsyncWaiter*> incoming_{nullptr};
+    AsyncWaiter* ready_ = nullptr; // oldest first, only touched holding popping_
+    std::atomic_flag popping_;
+};
+
+template <typename T>
+class AsyncQueue {
+public:
+    /*
+     * Awaiter returned by enq; co_await on it completes once element is in the queue
+     */
+    class EnqAwaiter : private AsyncWaiter {
+    public:
+        bool await_ready() { return queue_.claim(queue_.available_); }
+        void await_suspend(std::coroutine_handle<> handle) {
+            this->handle = handle;
+            queue_.enq_waiters_.push(this); // may be resumed from here on, so touch nothing after
+        }
+        void await_resume() { queue_.store(std::move(element_)); }
+
+    private:
+        friend class AsyncQueue;
+        EnqAwaiter(AsyncQueue& queue, T&& element) : queue_(queue), element_(std::move(element)) {}
+
+        AsyncQueue& queue_;
+        T element_;
+    };
+
+    /*
+     * Awaiter returned by deq; co_await on it yields the element at the front of the queue
+     */
+    class DeqAwaiter : private AsyncWaiter {
+    public:
+        bool await_ready() { return queue_.claim(queue_.current_size_); }
+        void await_suspend(std::coroutine_handle<> handle) {
+            this->handle = handle;
+            queue_.deq_waiters_.push(this); // may be resumed from here on, so touch nothing after
+        }
+        T await_resume() { return queue_.load(); }
+
+    private:
+        friend class AsyncQueue;
+        explicit DeqAwaiter(AsyncQueue& queue) : queue_(queue) {}
+
+        AsyncQueue& queue_;
+    };
+
+    /*
+     * Creates an AsyncQueue for at most capacity elements, resuming woken coroutines
+     * through scheduler, which must outlive the queue.
+     */
+    explicit AsyncQueue(std::size_t capacity, AsyncScheduler& scheduler = InlineScheduler::instance())
+        : capacity_(capacity), slots_(new Slot[capacity]), scheduler_(scheduler),
+          current_size_(0), available_(static_cast<long>(capacity)) {
+        for (std::size_t i = 0; i < capacity; i++)
+            slots_[i].sequence.store(i, std::memory_order_relaxed); // slot i is free for enq ticket i
+    }
+
+    AsyncQueue(const AsyncQueue&) = delete;
+    AsyncQueue& operator=(const AsyncQueue&) = delete;
+
+    /*
+     * Destroys the elements still in this Queue. No coroutine may still be waiting on it.
+     */
+    ~AsyncQueue() {
+        while (tryDeq()) {
+        }
+    }
+
+    /*
+     * Returns an awaitable which enqueues element at the back of this Queue, suspending
+     * the awaiting coroutine while the queue is full.
+     */
+    EnqAwaiter enq(T element) { return EnqAwaiter(*this, std::move(element)); }
+
+    /*
+     * Returns an awaitable which dequeues the element at the front of this Queue,
+     * suspending the awaiting coroutine while the queue is empty.
+     */
+    DeqAwaiter deq() { return DeqAwaiter(*this); }
+
+    /*
+     * Moves element to the back of this Queue without waiting, for callers outside a coroutine.
+     * Returns true on success and false if the queue is full, leaving element untouched.
+     */
+    bool tryEnq(T&& element) {
+        if (!tryClaim(available_))
+            return false;
+        store(std::move(element));
+        return true;
+    }
+
+    /*
+     * Dequeues the element at the front of this Queue without waiting.
+     * Returns the element, or nothing if the queue is empty.
+     */
+    std::optional<T> tryDeq() {
+        if (!tryClaim(current_size_))
+            return std::nullopt;
+        return load();
+    }
+
+    /*
+     * Returns the number of elements in this Queue not yet claimed by a deq; 0 while
+     * coroutines are waiting for one.
+     */
+    std::size_t size() const {
+        long size = current_size_.load(std::memory_order_relaxed);
+        return size > 0 ? static_cast<std::size_t>(size) : 0;
+    }
+
+    /*
+     * Returns true if this Queue has no unclaimed element, false otherwise.
+     */
+    bool isEmpty() const { return size() == 0; }
+
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    // Takes a permit, going into debt (and so becoming a waiter) when there is none.
+    // Returns true if the permit was there already.
+    static bool claim(std::atomic<long>& permits) {
+        return permits.fetch_sub(1, std::memory_order_acq_rel) > 0;
+    }
+
+    // Takes a permit only if there is one. Returns true on success.
+    static bool tryClaim(std::atomic<long>& permits) {
+        long value = permits.load(std::memory_order_relaxed);
+        while (value > 0) {
+            if (permits.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel,
+                                              std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    // Returns a permit, passing it on to a waiter if any coroutine is owed one.
+    void release(std::atomic<long>& permits, AsyncWaiterList& waiters) {
+        if (permits.fetch_add(1, std::memory_order_acq_rel) < 0)
+            scheduler_.schedule(waiters.pop()->handle);
+    }
+
+    // Puts element into the next slot, called holding a permit for a free slot.
+    void store(T&& element) {
+        std::size_t ticket = head_.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = slots_[ticket % capacity_];
+        // the permit means this slot's last element is being taken, if it is not gone already
+        while (slot.sequence.load(std::memory_order_acquire) != ticket)
+            std::this_thread::yield();
+        ::new (static_cast<void*>(slot.storage)) T(std::move(element));
+        slot.sequence.store(ticket + 1, std::memory_order_release);
+        release(current_size_, deq_waiters_);
+    }
+
+    // Takes the element out of the next slot, called holding a permit for an element.
+    T load() {
+        std::size_t ticket = tail_.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = slots_[ticket % capacity_];
+        while (slot.sequence.load(std::memory_order_acquire) != ticket + 1)
+            std::this_thread::yield();
+        T* stored = std::launder(reinterpret_cast<T*>(slot.storage));
+        T element(std::move(*stored));
+        stored->~T();
+        slot.sequence.store(ticket + capacity_, std::memory_order_release);
+        release(available_, enq_waiters_);
+        return element;
+    }
+
+    const std::size_t capacity_;
+    std::unique_ptr<Slot[]> slots_;
+    AsyncScheduler& scheduler_;
+    std::atomic<std::size_t> head_{0}, tail_{0}; // next enq and deq tickets
+    std::atomic<long> current_size_, available_;
+    AsyncWaiterList enq_waiters_, deq_waiters_;
+};
+
+} // namespace cqueue
+
+#endif /* ASYNC_QUEUE_HPP_ */
@@ -0,0 +1,1177 @@
+/*
+ * BenchQueue.c
+ *
+ * Throughput and latency benchmark suite for the queue implementations.
+ *
+ * Each suite sweeps its own parameters and reports one result row per run with the
+ * elements transferred per second and the enqueue-to-dequeue latency percentiles.
+ *
+ * Usage: ./BenchQueue [options]
+ *   --suite=NAME         only run the named suite (default: all)
+ *   --format=FORMAT      table, csv or json (default: table)
+ *   --ops=N              elements sent by each producer (default: 50000)
+ *   --threads=LIST       producer and consumer counts to sweep (default: 1,2,4)
+ *   --capacities=LIST    queue capacities to sweep (default: 16,1024)
+ *   --batches=LIST       batch sizes to sweep (default: 1,32)
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#include "BlockingQueue.h"
+#include "PriorityBlockingQueue.h"
+#include "ShardedBlockingQueue.h"
+#include "MulticastRing.h"
+#include "ObjectPool.h"
+#include "Executor.h"
+
+
+#define MAX_SWEEP 16
+
+/*
+ * Sweep parameters shared by all suites
+ */
+typedef struct BenchConfig {
+    long ops;
+    int threads[MAX_SWEEP], thread_count;
+    int capacities[MAX_SWEEP], capacity_count;
+    int batches[MAX_SWEEP], batch_count;
+} BenchConfig;
+
+/*
+ * One result row; parameters that do not apply to a suite are left at 0
+ */
+typedef struct BenchResult {
+    const char* suite;
+    const char* variant;
+    int producers, consumers, capacity, batch;
+    long ops;
+    double seconds, ops_per_sec;
+    double p50_ns, p99_ns, p999_ns;
+} BenchResult;
+
+typedef enum BenchFormat { FORMAT_TABLE, FORMAT_CSV, FORMAT_JSON } BenchFormat;
+
+static BenchFormat format = FORMAT_TABLE;
+static int results_printed = 0;
+
+static uint64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static int compareU64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Sorts the count latency samples and fills in the result's percentiles.
+ */
+static void percentiles(BenchResult* result, uint64_t* samples, long count) {
+    if (count == 0) return;
+    qsort(samples, count, sizeof(uint64_t), compareU64);
+    result->p50_ns = samples[(long)(count * 0.50)];
+    result->p99_ns = samples[(long)(count * 0.99)];
+    result->p999_ns = samples[(long)(count * 0.999)];
+}
+
+static void printResult(BenchResult* r) {
+    switch (format) {
+    case FORMAT_CSV:
+        if (results_printed == 0)
+            printf("suite,variant,producers,consumers,capacity,batch,ops,seconds,ops_per_sec,p50_ns,p99_ns,p999_ns\n");
+        printf("%s,%s,%d,%d,%d,%d,%ld,%.6f,%.0f,%.0f,%.0f,%.0f\n", r->suite, r->variant,
+               r->producers, r->consumers, r->capacity, r->batch, r->ops, r->seconds,
+               r->ops_per_sec, r->p50_ns, r->p99_ns, r->p999_ns);
+        break;
+    case FORMAT_JSON:
+        printf("%s\n  {\"suite\": \"%s\", \"variant\": \"%s\", \"producers\": %d, \"consumers\": %d, "
+               "\"capacity\": %d, \"batch\": %d, \"ops\": %ld, \"seconds\": %.6f, \"ops_per_sec\": %.0f, "
+               "\"p50_ns\": %.0f, \"p99_ns\": %.0f, \"p999_ns\": %.0f}",
+               results_printed == 0 ? "[" : ",", r->suite, r->variant, r->producers, r->consumers,
+               r->capacity, r->batch, r->ops, r->seconds, r->ops_per_sec, r->p50_ns, r->p99_ns, r->p999_ns);
+        break;
+    default:
+        if (results_printed == 0)
+            printf("%-10s %-24s %5s %5s %6s %5s %14s %10s %10s %10s\n", "suite", "variant", "prod",
+                   "cons", "cap", "batch", "ops/s", "p50 ns", "p99 ns", "p99.9 ns");
+        printf("%-10s %-24s %5d %5d %6d %5d %14.0f %10.0f %10.0f %10.0f\n", r->suite, r->variant,
+               r->producers, r->consumers, r->capacity, r->batch, r->ops_per_sec, r->p50_ns,
+               r->p99_ns, r->p999_ns);
+    }
+    results_printed++;
+    fflush(stdout);
+}
+
+
+/*
+    **************** BlockingQueue suite ****************
+*/
+
+/*
+ * A message carries the time it was enqueued so the consumer can measure latency
+ */
+typedef struct BenchMsg {
+    uint64_t sent_ns;
+} BenchMsg;
+
+/*
+ * Per-thread arguments for one run; producers fill msgs, consumers fill latencies
+ */
+typedef struct BenchWorker {
+    BlockingQueue* queue;
+    int node; // NUMA node to pin the thread to, -1 to leave it unpinned
+    int batch;
+    long ops;
+    BenchMsg* msgs;
+    uint64_t* latencies;
+} BenchWorker;
+
+static void* producer(void* arg) {
+    BenchWorker *w = arg;
+    void *batch[w->batch];
+
+    if (w->node >= 0)
+        QueueAffinity_pinToNode(w->node);
+
+    for (long i = 0; i < w->ops; i += w->batch) {
+        int n = w->ops - i < w->batch ? (int)(w->ops - i) : w->batch;
+        uint64_t now = nowNs();
+        for (int j = 0; j < n; j++) {
+            w->msgs[i + j].sent_ns = now;
+            batch[j] = &w->msgs[i + j];
+        }
+        if (n == 1)
+            BlockingQueue_enq(w->queue, batch[0]);
+        else
+            BlockingQueue_enqBatch(w->queue, batch, n);
+    }
+    return NULL;
+}
+
+static void* consumer(void* arg) {
+    BenchWorker *w = arg;
+    void *batch[w->batch];
+
+    if (w->node >= 0)
+        QueueAffinity_pinToNode(w->node);
+
+    for (long i = 0; i < w->ops;) {
+        int max = w->ops - i < w->batch ? (int)(w->ops - i) : w->batch;
+        int n;
+        if (max == 1) {
+            batch[0] = BlockingQueue_deq(w->queue);
+            n = 1;
+        } else {
+            n = BlockingQueue_deqBatch(w->queue, batch, 1, max);
+        }
+        uint64_t now = nowNs();
+        for (int j = 0; j < n; j++) {
+            w->latencies[i++] = now - ((BenchMsg *)batch[j])->sent_ns;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Runs producers and consumers, pinned to node unless it is -1, against queue until every
+ * element has been transferred, then destroys queue.
+ */
+static void runTransfer(BenchResult* result, BlockingQueue* queue, int node, long ops) {
+    int producers = result->producers, consumers = result->consumers;
+    long total = producers * ops;
+    pthread_t threads[producers + consumers];
+    BenchWorker workers[producers + consumers];
+    BenchMsg *msgs = malloc(total * sizeof(BenchMsg));
+    uint64_t *latencies = malloc(total * sizeof(uint64_t));
+
+    if (msgs == NULL || latencies == NULL || queue == NULL) {
+        fprintf(stderr, "BenchQueue: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    long offset = 0;
+    for (int i = 0; i < producers + consumers; i++) {
+        workers[i].queue = queue;
+        workers[i].node = node;
+        workers[i].batch = result->batch;
+        if (i < producers) {
+            workers[i].ops = ops;
+            workers[i].msgs = msgs + i * ops;
+        } else {
+            // split the elements evenly, giving the remainder to the first consumer
+            int c = i - producers;
+            workers[i].ops = total / consumers + (c == 0 ? total % consumers : 0);
+            workers[i].latencies = latencies + offset;
+            offset += workers[i].ops;
+        }
+    }
+
+    uint64_t start = nowNs();
+    for (int i = 0; i < producers + consumers; i++) {
+        pthread_create(&threads[i], NULL, i < producers ? producer : consumer, &workers[i]);
+    }
+    for (int i = 0; i < producers + consumers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    result->seconds = (nowNs() - start) / 1e9;
+
+    result->ops = total;
+    result->ops_per_sec = total / result->seconds;
+    percentiles(result, latencies, total);
+
+    BlockingQueue_destroy(queue);
+    free(msgs);
+    free(latencies);
+}
+
+/*
+ * Runs producers and consumers against a new queue with the given backend.
+ */
+static void runBlockingQueue(BenchResult* result, BlockingQueueBackend backend, long ops) {
+    runTransfer(result, new_BlockingQueueWithBackend(result->capacity, backend), -1, ops);
+}
+
+static void benchBlockingQueue(BenchConfig* config) {
+    static const struct { const char* name; BlockingQueueBackend backend; } backends[] = {
+        { "mutex", BLOCKING_QUEUE_MUTEX },
+        { "lock-free", BLOCKING_QUEUE_LOCK_FREE },
+        { "unbounded", BLOCKING_QUEUE_UNBOUNDED },
+    };
+
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++)
+    for (int p = 0; p < config->thread_count; p++)
+    for (int c = 0; c < config->thread_count; c++)
+    for (int cap = 0; cap < config->capacity_count; cap++)
+    for (int bat = 0; bat < config->batch_count; bat++) {
+        BenchResult result = { "blocking", backends[b].name, config->threads[p], config->threads[c],
+                               config->capacities[cap], config->batches[bat], 0, 0, 0, 0, 0, 0 };
+        runBlockingQueue(&result, backends[b].backend, config->ops);
+        printResult(&result);
+    }
+}
+
+
+/*
+    **************** MulticastRing suite ****************
+*/
+
+#define MULTICAST_MAX_CONSUMERS 16
+
+/*
+ * Per-thread arguments for one fan-out run; every consumer receives every element
+ */
+typedef struct MulticastWorker {
+    BlockingQueue** queues; // one per consumer when copying, NULL when using the ring
+    int queue_count;
+    MulticastRing* ring;
+    MulticastCursor* cursor;
+    BlockingQueue* queue;
+    int batch;
+    long ops;
+    BenchMsg* msgs;
+    uint64_t* latencies;
+} MulticastWorker;
+
+static void* multicastProducer(void* arg) {
+    MulticastWorker *w = arg;
+    void *batch[w->batch];
+
+    for (long i = 0; i < w->ops; i += w->batch) {
+        int n = w->ops - i < w->batch ? (int)(w->ops - i) : w->batch;
+        uint64_t now = nowNs();
+        for (int j = 0; j < n; j++) {
+            w->msgs[i + j].sent_ns = now;
+            batch[j] = &w->msgs[i + j];
+        }
+        if (w->queues == NULL) {
+            MulticastRing_publishBatch(w->ring, batch, n);
+        } else {
+            for (int q = 0; q < w->queue_count; q++)
+                BlockingQueue_enqBatch(w->queues[q], batch, n);
+        }
+    }
+    return NULL;
+}
+
+static void* multicastConsumer(void* arg) {
+    MulticastWorker *w = arg;
+    void *batch[w->batch];
+
+    for (long i = 0; i < w->ops;) {
+        int max = w->ops - i < w->batch ? (int)(w->ops - i) : w->batch;
+        int n = w->queue == NULL ? MulticastCursor_read(w->cursor, batch, max)
+                                 : BlockingQueue_deqBatch(w->queue, batch, 1, max);
+        uint64_t now = nowNs();
+        for (int j = 0; j < n; j++) {
+            w->latencies[i++] = now - ((BenchMsg *)batch[j])->sent_ns;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Sends ops elements from one producer to every consumer, either through one MulticastRing
+ * or by copying each element into a BlockingQueue per consumer.
+ */
+static void runMulticast(BenchResult* result, bool use_ring, long ops) {
+    int consumers = result->consumers;
+    long total = ops * consumers;
+    pthread_t threads[1 + consumers];
+    MulticastWorker workers[1 + consumers];
+    BlockingQueue *queues[consumers];
+    BenchMsg *msgs = malloc(ops * sizeof(BenchMsg));
+    uint64_t *latencies = malloc(total * sizeof(uint64_t));
+    MulticastRing *ring = use_ring ? new_MulticastRing(result->capacity) : NULL;
+
+    if (msgs == NULL || latencies == NULL || (use_ring && ring == NULL)) {
+        fprintf(stderr, "BenchQueue: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < 1 + consumers; i++) {
+        workers[i].queues = use_ring ? NULL : queues;
+        workers[i].queue_count = consumers;
+        workers[i].ring = ring;
+        workers[i].cursor = NULL;
+        workers[i].queue = NULL;
+        workers[i].batch = result->batch;
+        workers[i].ops = ops;
+        workers[i].msgs = msgs;
+        if (i > 0) {
+            workers[i].latencies = latencies + (i - 1) * ops;
+            if (use_ring) {
+                workers[i].cursor = MulticastRing_addCursor(ring, NULL);
+            } else {
+                queues[i - 1] = new_BlockingQueue(result->capacity);
+                workers[i].queue = queues[i - 1];
+            }
+            if (workers[i].cursor == NULL && workers[i].queue == NULL) {
+                fprintf(stderr, "BenchQueue: out of memory\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    uint64_t start = nowNs();
+    for (int i = 0; i < 1 + consumers; i++) {
+        pthread_create(&threads[i], NULL, i == 0 ? multicastProducer : multicastConsumer, &workers[i]);
+    }
+    for (int i = 0; i < 1 + consumers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    result->seconds = (nowNs() - start) / 1e9;
+
+    result->ops = total;
+    result->ops_per_sec = total / result->seconds;
+    percentiles(result, latencies, total);
+
+    if (!use_ring) {
+        for (int i = 0; i < consumers; i++)
+            BlockingQueue_destroy(queues[i]);
+    }
+    MulticastRing_destroy(ring);
+    free(msgs);
+    free(latencies);
+}
+
+/*
+ * Fans one producer's elements out to every consumer, counting each delivery as one op.
+ */
+static void benchMulticast(BenchConfig* config) {
+    for (int use_ring = 0; use_ring <= 1; use_ring++)
+    for (int c = 0; c < config->thread_count; c++)
+    for (int cap = 0; cap < config->capacity_count; cap++)
+    for (int bat = 0; bat < config->batch_count; bat++) {
+        if (config->threads[c] > MULTICAST_MAX_CONSUMERS)
+            continue;
+        BenchResult result = { "multicast", use_ring ? "ring" : "copy-queues", 1, config->threads[c],
+                               config->capacities[cap], config->batches[bat], 0, 0, 0, 0, 0, 0 };
+        runMulticast(&result, use_ring, config->ops);
+        printResult(&result);
+    }
+}
+
+
+/*
+    **************** ObjectPool suite ****************
+*/
+
+#define POOL_PAYLOAD_SIZE 256
+
+/*
+ * A payload allocated per element; only the head is written, like a buffer filled in place
+ */
+typedef struct PoolPayload {
+    uint64_t sent_ns;
+    char body[POOL_PAYLOAD_SIZE - sizeof(uint64_t)];
+} PoolPayload;
+
+/*
+ * Per-thread arguments for one payload run; pool is NULL to malloc and free each payload
+ */
+typedef struct PoolWorker {
+    BlockingQueue* queue;
+    ObjectPool* pool;
+    long ops;
+    uint64_t* latencies;
+} PoolWorker;
+
+static void* poolProducer(void* arg) {
+    PoolWorker *w = arg;
+
+    for (long i = 0; i < w->ops; i++) {
+        PoolPayload *payload = w->pool == NULL ? malloc(sizeof(PoolPayload)) : ObjectPool_get(w->pool);
+        payload->sent_ns = nowNs();
+        BlockingQueue_enq(w->queue, payload);
+    }
+    return NULL;
+}
+
+static void* poolConsumer(void* arg) {
+    PoolWorker *w = arg;
+
+    for (long i = 0; i < w->ops; i++) {
+        PoolPayload *payload = BlockingQueue_deq(w->queue);
+        w->latencies[i] = nowNs() - payload->sent_ns;
+        if (w->pool == NULL)
+            free(payload);
+        else
+            ObjectPool_put(w->pool, payload);
+    }
+    return NULL;
+}
+
+/*
+ * Sends ops payloads from each producer to the consumers, allocating each payload with
+ * malloc and freeing it after use, or getting it from an ObjectPool and putting it back.
+ */
+static void runPool(BenchResult* result, bool use_pool, long ops) {
+    int producers = result->producers, consumers = result->consumers;
+    long total = producers * ops;
+    pthread_t threads[producers + consumers];
+    PoolWorker workers[producers + consumers];
+    uint64_t *latencies = malloc(total * sizeof(uint64_t));
+    BlockingQueue *queue = new_BlockingQueue(result->capacity);
+    // enough for a full queue plus what every thread's cache may hold
+    ObjectPool *pool = use_pool ? new_ObjectPool(result->capacity + 2 * POOL_DEFAULT_BATCH * (producers + consumers),
+                                                 sizeof(PoolPayload), POOL_DEFAULT_BATCH) : NULL;
+
+    if (latencies == NULL || queue == NULL || (use_pool && pool == NULL)) {
+        fprintf(stderr, "BenchQueue: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    long offset = 0;
+    for (int i = 0; i < producers + consumers; i++) {
+        workers[i].queue = queue;
+        workers[i].pool = pool;
+        if (i < producers) {
+            workers[i].ops = ops;
+        } else {
+            // split the elements evenly, giving the remainder to the first consumer
+            int c = i - producers;
+            workers[i].ops = total / consumers + (c == 0 ? total % consumers : 0);
+            workers[i].latencies = latencies + offset;
+            offset += workers[i].ops;
+        }
+    }
+
+    uint64_t start = nowNs();
+    for (int i = 0; i < producers + consumers; i++) {
+        pthread_create(&threads[i], NULL, i < producers ? poolProducer : poolConsumer, &workers[i]);
+    }
+    for (int i = 0; i < producers + consumers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    result->seconds = (nowNs() - start) / 1e9;
+
+    result->ops = total;
+    result->ops_per_sec = total / result->seconds;
+    percentiles(result, latencies, total);
+
+    BlockingQueue_destroy(queue);
+    ObjectPool_destroy(pool);
+    free(latencies);
+}
+
+/*
+ * Compares allocating every payload against recycling payloads through an ObjectPool.
+ */
+static void benchPool(BenchConfig* config) {
+    for (int use_pool = 0; use_pool <= 1; use_pool++)
+    for (int p = 0; p < config->thread_count; p++)
+    for (int c = 0; c < config->thread_count; c++)
+    for (int cap = 0; cap < config->capacity_count; cap++) {
+        BenchResult result = { "pool", use_pool ? "object-pool" : "malloc", config->threads[p], config->threads[c],
+                               config->capacities[cap], 1, 0, 0, 0, 0, 0, 0 };
+        runPool(&result, use_pool, config->ops);
+        printResult(&result);
+    }
+}
+
+
+/*
+    **************** NUMA placement suite ****************
+*/
+
+/*
+ * Transfers through a ring placed on each node with the threads pinned to each node, so
+ * local and remote placements can be compared, next to an unplaced queue and threads.
+ * Producers and consumers are swept together, as threads of each.
+ */
+static void benchNuma(BenchConfig* config) {
+    static const struct { const char* name; BlockingQueueBackend backend; } backends[] = {
+        { "mutex", BLOCKING_QUEUE_MUTEX },
+        { "lock-free", BLOCKING_QUEUE_LOCK_FREE },
+    };
+    int nodes = QueueAffinity_nodeCount();
+    char variant[64];
+
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++)
+    for (int t = 0; t < config->thread_count; t++)
+    for (int cap = 0; cap < config->capacity_count; cap++)
+    for (int placement = -1; placement < nodes * nodes; placement++) {
+        int ring_node = placement < 0 ? -1 : placement / nodes;
+        int thread_node = placement < 0 ? -1 : placement % nodes;
+        BlockingQueue *queue;
+
+        if (placement < 0) {
+            snprintf(variant, sizeof(variant), "%s/unplaced", backends[b].name);
+            queue = new_BlockingQueueWithBackend(config->capacities[cap], backends[b].backend);
+        } else {
+            if (QueueAffinity_firstCpu(thread_node) < 0)
+                continue; // no CPU of ours to pin the threads to
+            snprintf(variant, sizeof(variant), "%s/ring%d-threads%d", backends[b].name, ring_node, thread_node);
+            queue = new_BlockingQueueOnNode(config->capacities[cap], backends[b].backend, ring_node);
+            if (queue != NULL && BlockingQueue_node(queue) != ring_node) {
+                BlockingQueue_destroy(queue);
+                continue; // the ring could not be placed there
+            }
+        }
+
+        BenchResult result = { "numa", variant, config->threads[t], config->threads[t],
+                               config->capacities[cap], 1, 0, 0, 0, 0, 0, 0 };
+        runTransfer(&result, queue, thread_node, config->ops);
+        printResult(&result);
+    }
+}
+
+
+/*
+    **************** Queue layout suite ****************
+*/
+
+#define LAYOUT_RING_SIZE (4 * 1024 * 1024) // 32 MiB of slots, far beyond what the TLB covers with 4 KiB pages
+
+/*
+ * The two indices of a single-producer single-consumer ring, as Queue lays them out without
+ * QUEUE_ALIGNED, sharing one line, and with it, on a line each
+ */
+typedef struct PackedIndices {
+    atomic_long head, tail;
+} PackedIndices;
+
+typedef struct AlignedIndices {
+    _Alignas(QUEUE_CACHE_LINE) atomic_long head;
+    _Alignas(QUEUE_CACHE_LINE) atomic_long tail;
+} AlignedIndices;
+
+/*
+ * A lock-free ring handed from one producer to one consumer; head and tail point into
+ * either index layout, so both runs take exactly the same code path
+ */
+typedef struct HandoffRing {
+    BenchMsg** slots;
+    long capacity, ops;
+    atomic_long *head, *tail; // head written only by the producer, tail only by the consumer
+    uint64_t* latencies;
+} HandoffRing;
+
+static void* handoffProducer(void* arg) {
+    HandoffRing *ring = arg;
+    BenchMsg *msgs = malloc(ring->ops * sizeof(BenchMsg));
+
+    if (msgs == NULL) {
+        fprintf(stderr, "BenchQueue: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    for (long head = 0; head < ring->ops; head++) {
+        while (head - atomic_load_explicit(ring->tail, memory_order_acquire) == ring->capacity)
+            sched_yield(); // full
+        msgs[head].sent_ns = nowNs();
+        ring->slots[head % ring->capacity] = &msgs[head];
+        atomic_store_explicit(ring->head, head + 1, memory_order_release);
+    }
+    // the consumer has seen every message once tail catches up
+    while (atomic_load_explicit(ring->tail, memory_order_acquire) != ring->ops)
+        sched_yield();
+    free(msgs);
+    return NULL;
+}
+
+static void* handoffConsumer(void* arg) {
+    HandoffRing *ring = arg;
+
+    for (long tail = 0; tail < ring->ops; tail++) {
+        while (atomic_load_explicit(ring->head, memory_order_acquire) == tail)
+            sched_yield(); // empty
+        BenchMsg *msg = ring->slots[tail % ring->capacity];
+        ring->latencies[tail] = nowNs() - msg->sent_ns;
+        atomic_store_explicit(ring->tail, tail + 1, memory_order_release);
+    }
+    return NULL;
+}
+
+/*
+ * Hands ops messages from a producer thread to a consumer thread through a lock-free ring
+ * whose indices are packed together or aligned onto separate cache lines. The producer
+ * writes head and polls tail, the consumer the other way round, so with the packed layout
+ * every store invalidates the line the other side is polling.
+ */
+static void runIndexLayout(BenchResult* result, bool aligned, long ops) {
+    size_t bytes = aligned ? sizeof(AlignedIndices) : QUEUE_CACHE_LINE;
+    void *indices = aligned_alloc(QUEUE_CACHE_LINE, bytes);
+    HandoffRing ring = { malloc(result->capacity * sizeof(BenchMsg *)), result->capacity, ops,
+                         NULL, NULL, malloc(ops * sizeof(uint64_t)) };
+    pthread_t threads[2];
+
+    if (indices == NULL || ring.slots == NULL || ring.latencies == NULL) {
+        fprintf(stderr, "BenchQueue: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    if (aligned) {
+        AlignedIndices *a = indices;
+        ring.head = &a->head;
+        ring.tail = &a->tail;
+    } else {
+        PackedIndices *p = indices;
+        ring.head = &p->head;
+        ring.tail = &p->tail;
+    }
+    atomic_init(ring.head, 0);
+    atomic_init(ring.tail, 0);
+
+    uint64_t start = nowNs();
+    pthread_create(&threads[0], NULL, handoffProducer, &ring);
+    pthread_create(&threads[1], NULL, handoffConsumer, &ring);
+    for (int i = 0; i < 2; i++)
+        pthread_join(threads[i], NULL);
+    result->seconds = (nowNs() - start) / 1e9;
+
+    result->ops = ops;
+    result->ops_per_sec = ops / result->seconds;
+    percentiles(result, ring.latencies, ops);
+
+    free(ring.slots);
+    free(ring.latencies);
+    free(indices);
+}
+
+/*
+ * Fills and drains one large ring allocated with the given layout, timing each element's
+ * round trip, which is dominated by TLB and cache misses on the data array.
+ */
+static void runRingLayout(BenchResult* result, int layout, long ops) {
+    Queue *queue = new_QueueWithLayout(result->capacity, layout);
+    long passes = (ops + result->capacity - 1) / result->capacity;
+    static BenchMsg msg;
+
+    if (queue == NULL) {
+        fprintf(stderr, "BenchQueue: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    uint64_t start = nowNs();
+    for (long p = 0; p < passes; p++) {
+        for (int i = 0; i < result->capacity; i++)
+            Queue_enq(queue, &msg);
+        for (int i = 0; i < result->capacity; i++)
+            Queue_deq(queue);
+    }
+    result->seconds = (nowNs() - start) / 1e9;
+
+    result->ops = passes * result->capacity;
+    result->ops_per_sec = result->ops / result->seconds;
+    Queue_destroy(queue);
+}
+
+static void benchLayout(BenchConfig* config) {
+    static const struct { const char* name; int layout; } rings[] = {
+        { "ring", QUEUE_LAYOUT_DEFAULT },
+        { "ring-align", QUEUE_LAYOUT_ALIGNED },
+        { "ring-thp", QUEUE_LAYOUT_HUGE_PAGES },
+        { "ring-tlb", QUEUE_LAYOUT_HUGETLB },
+    };
+
+    // false sharing between the indices: the same lock-free handoff with both layouts
+    for (int cap = 0; cap < config->capacity_count; cap++)
+    for (int aligned = 0; aligned <= 1; aligned++) {
+        BenchResult result = { "layout", aligned ? "spsc-aligned" : "spsc-packed", 1, 1,
+                               config->capacities[cap], 1, 0, 0, 0, 0, 0, 0 };
+        runIndexLayout(&result, aligned, config->ops * 20);
+        printResult(&result);
+    }
+    // TLB cost of the data array, single-threaded, under each allocation layout
+    for (size_t r = 0; r < sizeof(rings) / sizeof(rings[0]); r++) {
+        BenchResult result = { "layout", rings[r].name, 1, 1, LAYOUT_RING_SIZE, 1, 0, 0, 0, 0, 0, 0 };
+        runRingLayout(&result, rings[r].layout, config->ops * 200);
+        printResult(&result);
+    }
+}
+
+
+/*
+    **************** ShardedBlockingQueue suite ****************
+*/
+
+/*
+ * Per-thread arguments for one run; producers fill msgs, consumers fill latencies
+ */
+typedef struct ShardedWorker {
+    ShardedBlockingQueue* queue;
+    long ops;
+    BenchMsg* msgs;
+    uint64_t* latencies;
+} ShardedWorker;
+
+static void* shardedProducer(void* arg) {
+    ShardedWorker *w = arg;
+
+    for (long i = 0; i < w->ops; i++) {
+        w->msgs[i].sent_ns = nowNs();
+        ShardedBlockingQueue_enq(w->queue, &w->msgs[i]);
+    }
+    return NULL;
+}
+
+static void* shardedConsumer(void* arg) {
+    ShardedWorker *w = arg;
+
+    for (long i = 0; i < w->ops; i++) {
+        BenchMsg *msg = ShardedBlockingQueue_deq(w->queue);
+        w->latencies[i] = nowNs() - msg->sent_ns;
+    }
+    return NULL;
+}
+
+/*
+ * Runs producers and consumers against one sharded queue until every element has been transferred.
+ */
+static void runSharded(BenchResult* result, int shard_count, long ops) {
+    int producers = result->producers, consumers = result->consumers;
+    long total = producers * ops;
+    pthread_t threads[producers + consumers];
+    ShardedWorker workers[producers + consumers];
+    BenchMsg *msgs = malloc(total * sizeof(BenchMsg));
+    uint64_t *latencies = malloc(total * sizeof(uint64_t));
+    ShardedBlockingQueue *queue = new_ShardedBlockingQueue(result->capacity, shard_count);
+
+    if (msgs == NULL || latencies == NULL || queue == NULL) {
+        fprintf(stderr, "BenchQueue: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    long offset = 0;
+    for (int i = 0; i < producers + consumers; i++) {
+        workers[i].queue = queue;
+        if (i < producers) {
+            workers[i].ops = ops;
+            workers[i].msgs = msgs + i * ops;
+        } else {
+            // split the elements evenly, giving the remainder to the first consumer
+            int c = i - producers;
+            workers[i].ops = total / consumers + (c == 0 ? total % consumers : 0);
+            workers[i].latencies = latencies + offset;
+            offset += workers[i].ops;
+        }
+    }
+
+    uint64_t start = nowNs();
+    for (int i = 0; i < producers + consumers; i++) {
+        pthread_create(&threads[i], NULL, i < producers ? shardedProducer : shardedConsumer, &workers[i]);
+    }
+    for (int i = 0; i < producers + consumers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    result->seconds = (nowNs() - start) / 1e9;
+
+    result->ops = total;
+    result->ops_per_sec = total / result->seconds;
+    percentiles(result, latencies, total);
+
+    ShardedBlockingQueue_destroy(queue);
+    free(msgs);
+    free(latencies);
+}
+
+static void benchSharded(BenchConfig* config) {
+    static const struct { const char* name; int shards; } variants[] = {
+        { "1-shard", 1 },
+        { "4-shards", 4 },
+        { "16-shards", 16 },
+    };
+
+    for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++)
+    for (int p = 0; p < config->thread_count; p++)
+    for (int c = 0; c < config->thread_count; c++)
+    for (int cap = 0; cap < config->capacity_count; cap++) {
+        BenchResult result = { "sharded", variants[v].name, config->threads[p], config->threads[c],
+                               config->capacities[cap], 1, 0, 0, 0, 0, 0, 0 };
+        runSharded(&result, variants[v].shards, config->ops);
+        printResult(&result);
+    }
+}
+
+
+/*
+    **************** PriorityBlockingQueue suite ****************
+*/
+
+#define BENCH_LEVELS 8
+
+typedef enum PriorityMode { PRIORITY_HEAP, PRIORITY_BUCKETED, PRIORITY_POLLED } PriorityMode;
+
+/*
+ * Per-thread arguments for one run; the polled baseline keeps one BlockingQueue per level
+ */
+typedef struct PriorityWorker {
+    PriorityMode mode;
+    PriorityBlockingQueue* queue;
+    BlockingQueue** levels;
+    long ops;
+    BenchMsg* msgs;
+    uint64_t* latencies;
+} PriorityWorker;
+
+static void* priorityProducer(void* arg) {
+    PriorityWorker *w = arg;
+
+    for (long i = 0; i < w->ops; i++) {
+        int priority = i % BENCH_LEVELS;
+        w->msgs[i].sent_ns = nowNs();
+        if (w->mode == PRIORITY_POLLED)
+            BlockingQueue_enq(w->levels[priority], &w->msgs[i]);
+        else
+            PriorityBlockingQueue_enq(w->queue, &w->msgs[i], priority);
+    }
+    return NULL;
+}
+
+/*
+ * Polls the per-level queues from the most urgent down until one has an element.
+ */
+static void* pollLevels(BlockingQueue** levels) {
+    void *element;
+
+    for (;;) {
+        for (int l = 0; l < BENCH_LEVELS; l++) {
+            if (BlockingQueue_deqBatch(levels[l], &element, 0, 1) == 1)
+                return element;
+        }
+        sched_yield();
+    }
+}
+
+static void* priorityConsumer(void* arg) {
+    PriorityWorker *w = arg;
+
+    for (long i = 0; i < w->ops; i++) {
+        BenchMsg *msg;
+        if (w->mode == PRIORITY_POLLED)
+            msg = pollLevels(w->levels);
+        else
+            msg = PriorityBlockingQueue_deq(w->queue);
+        w->latencies[i] = nowNs() - msg->sent_ns;
+    }
+    return NULL;
+}
+
+/*
+ * Runs producers and consumers against one priority queue, or one BlockingQueue per level,
+ * until every element has been transferred.
+ */
+static void runPriority(BenchResult* result, PriorityMode mode, long ops) {
+    int producers = result->producers, consumers = result->consumers;
+    long total = producers * ops;
+    pthread_t threads[producers + consumers];
+    PriorityWorker workers[producers + consumers];
+    BlockingQueue *levels[BENCH_LEVELS] = {0};
+    PriorityBlockingQueue *queue = NULL;
+    BenchMsg *msgs = malloc(total * sizeof(BenchMsg));
+    uint64_t *latencies = malloc(total * sizeof(uint64_t));
+    bool created = true;
+
+    if (mode == PRIORITY_HEAP)
+        created = (queue = new_PriorityBlockingQueue(result->capacity)) != NULL;
+    else if (mode == PRIORITY_BUCKETED)
+        created = (queue = new_BucketedPriorityBlockingQueue(result->capacity, BENCH_LEVELS)) != NULL;
+    for (int l = 0; mode == PRIORITY_POLLED && l < BENCH_LEVELS; l++)
+        created = created && (levels[l] = new_BlockingQueue(result->capacity)) != NULL;
+
+    if (msgs == NULL || latencies == NULL || !created) {
+        fprintf(stderr, "BenchQueue: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    long offset = 0;
+    for (int i = 0; i < producers + consumers; i++) {
+        workers[i].mode = mode;
+        workers[i].queue = queue;
+        workers[i].levels = levels;
+        if (i < producers) {
+            workers[i].ops = ops;
+            workers[i].msgs = msgs + i * ops;
+        } else {
+            // split the elements evenly, giving the remainder to the first consumer
+            int c = i - producers;
+            workers[i].ops = total / consumers + (c == 0 ? total % consumers : 0);
+            workers[i].latencies = latencies + offset;
+            offset += workers[i].ops;
+        }
+    }
+
+    uint64_t start = nowNs();
+    for (int i = 0; i < producers + consumers; i++) {
+        pthread_create(&threads[i], NULL, i < producers ? priorityProducer : priorityConsumer, &workers[i]);
+    }
+    for (int i = 0; i < producers + consumers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    result->seconds = (nowNs() - start) / 1e9;
+
+    result->ops = total;
+    result->ops_per_sec = total / result->seconds;
+    percentiles(result, latencies, total);
+
+    PriorityBlockingQueue_destroy(queue);
+    for (int l = 0; l < BENCH_LEVELS; l++)
+        BlockingQueue_destroy(levels[l]);
+    free(msgs);
+    free(latencies);
+}
+
+static void benchPriority(BenchConfig* config) {
+    static const struct { const char* name; PriorityMode mode; } modes[] = {
+        { "heap", PRIORITY_HEAP },
+        { "bucketed", PRIORITY_BUCKETED },
+        { "polled", PRIORITY_POLLED },
+    };
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+    for (int p = 0; p < config->thread_count; p++)
+    for (int c = 0; c < config->thread_count; c++)
+    for (int cap = 0; cap < config->capacity_count; cap++) {
+        BenchResult result = { "priority", modes[m].name, config->threads[p], config->threads[c],
+                               config->capacities[cap], 1, 0, 0, 0, 0, 0, 0 };
+        runPriority(&result, modes[m].mode, config->ops);
+        printResult(&result);
+    }
+}
+
+
+/*
+    **************** Executor suite ****************
+*/
+
+typedef enum DispatchMode { DISPATCH_RAW, DISPATCH_EXECUTE, DISPATCH_SUBMIT } DispatchMode;
+
+/*
+ * A task records how long it waited between being submitted and starting to run
+ */
+typedef struct BenchTask {
+    uint64_t sent_ns;
+    uint64_t* latency;
+} BenchTask;
+
+static void* benchTask(void* arg) {
+    BenchTask *task = arg;
+    *task->latency = nowNs() - task->sent_ns;
+    return NULL;
+}
+
+/*
+ * Enqueued once per raw worker to stop it
+ */
+static BenchTask stop_task;
+
+/*
+ * The hand-rolled baseline: worker threads looping on BlockingQueue_deq
+ */
+static void* rawWorker(void* arg) {
+    BlockingQueue *queue = arg;
+    BenchTask *task;
+
+    while ((task = BlockingQueue_deq(queue)) != &stop_task)
+        benchTask(task);
+    return NULL;
+}
+
+/*
+ * Dispatches ops tasks from the calling thread to result->consumers workers and waits for all of them.
+ */
+static void runExecutor(BenchResult* result, DispatchMode mode, long ops) {
+    int workers = result->consumers;
+    pthread_t threads[workers];
+    BenchTask *tasks = malloc(ops * sizeof(BenchTask));
+    uint64_t *latencies = malloc(ops * sizeof(uint64_t));
+    ExecutorFuture **futures = malloc(ops * sizeof(ExecutorFuture *));
+    BlockingQueue *queue = NULL;
+    Executor *executor = NULL;
+
+    if (mode == DISPATCH_RAW)
+        queue = new_UnboundedBlockingQueue(256);
+    else
+        executor = new_Executor(workers);
+    if (tasks == NULL || latencies == NULL || futures == NULL || (queue == NULL && executor == NULL)) {
+        fprintf(stderr, "BenchQueue: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    uint64_t start = nowNs();
+    if (mode == DISPATCH_RAW) {
+        for (int i = 0; i < workers; i++)
+            pthread_create(&threads[i], NULL, rawWorker, queue);
+    }
+    for (long i = 0; i < ops; i++) {
+        tasks[i].latency = &latencies[i];
+        tasks[i].sent_ns = nowNs();
+        if (mode == DISPATCH_RAW)
+            BlockingQueue_enq(queue, &tasks[i]);
+        else if (mode == DISPATCH_EXECUTE)
+            Executor_execute(executor, benchTask, &tasks[i]);
+        else
+            futures[i] = Executor_submit(executor, benchTask, &tasks[i]);
+    }
+    if (mode == DISPATCH_RAW) {
+        for (int i = 0; i < workers; i++)
+            BlockingQueue_enq(queue, &stop_task);
+        for (int i = 0; i < workers; i++)
+            pthread_join(threads[i], NULL);
+    } else if (mode == DISPATCH_SUBMIT) {
+        for (long i = 0; i < ops; i++) {
+            ExecutorFuture_get(futures[i]);
+            ExecutorFuture_destroy(futures[i]);
+        }
+    }
+    if (executor != NULL)
+        Executor_shutdown(executor);
+    result->seconds = (nowNs() - start) / 1e9;
+
+    result->ops = ops;
+    result->ops_per_sec = ops / result->seconds;
+    percentiles(result, latencies, ops);
+
+    Executor_destroy(executor);
+    BlockingQueue_destroy(queue);
+    free(tasks);
+    free(latencies);
+    free(futures);
+}
+
+static void benchExecutor(BenchConfig* config) {
+    static const struct { const char* name; DispatchMode mode; } modes[] = {
+        { "raw-queue", DISPATCH_RAW },
+        { "execute", DISPATCH_EXECUTE },
+        { "submit", DISPATCH_SUBMIT },
+    };
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+    for (int w = 0; w < config->thread_count; w++) {
+        BenchResult result = { "executor", modes[m].name, 1, config->threads[w], 0, 1, 0, 0, 0, 0, 0, 0 };
+        runExecutor(&result, modes[m].mode, config->ops);
+        printResult(&result);
+    }
+}
+
+
+/*
+    **************** Driver ****************
+*/
+
+/*
+ * A named group of benchmarks
+ */
+typedef struct BenchSuite {
+    const char* name;
+    void (*run)(BenchConfig* config);
+} BenchSuite;
+
+static const BenchSuite suites[] = {
+    { "blocking", benchBlockingQueue },
+    { "sharded", benchSharded },
+    { "layout", benchLayout },
+    { "priority", benchPriority },
+    { "executor", benchExecutor },
+    { "numa", benchNuma },
+    { "multicast", benchMulticast },
+    { "pool", benchPool },
+};
+
+/*
+ * Parses a comma separated list of positive integers into values.
+ * Returns the number of values parsed.
+ */
+static int parseList(const char* text, int* values) {
+    int count = 0;
+    char *end;
+
+    while (*text && count < MAX_SWEEP) {
+        long v = strtol(text, &end, 10);
+        if (end == text || v <= 0) break;
+        values[count++] = (int)v;
+        text = *end == ',' ? end + 1 : end;
+    }
+    return count;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [--suite=NAME] [--format=table|csv|json] [--ops=N] "
+                    "[--threads=LIST] [--capacities=LIST] [--batches=LIST]\n", prog);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char** argv) {
+    BenchConfig config = { 50000, {1, 2, 4}, 3, {16, 1024}, 2, {1, 32}, 2 };
+    const char *only = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strncmp(arg, "--suite=", 8) == 0) {
+            only = arg + 8;
+        } else if (strcmp(arg, "--format=table") == 0) {
+            format = FORMAT_TABLE;
+        } else if (strcmp(arg, "--format=csv") == 0) {
+            format = FORMAT_CSV;
+        } else if (strcmp(arg, "--format=json") == 0) {
+            format = FORMAT_JSON;
+        } else if (strncmp(arg, "--ops=", 6) == 0 && atol(arg + 6) > 0) {
+            config.ops = atol(arg + 6);
+        } else if (strncmp(arg, "--threads=", 10) == 0) {
+            if ((config.thread_count = parseList(arg + 10, config.threads)) == 0) usage(argv[0]);
+        } else if (strncmp(arg, "--capacities=", 13) == 0) {
+            if ((config.capacity_count = parseList(arg + 13, config.capacities)) == 0) usage(argv[0]);
+        } else if (strncmp(arg, "--batches=", 10) == 0) {
+            if ((config.batch_count = parseList(arg + 10, config.batches)) == 0) usage(argv[0]);
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(suites) / sizeof(suites[0]); i++) {
+        if (only == NULL || strcmp(only, suites[i].name) == 0)
+            suites[i].run(&config);
+    }
+    if (format == FORMAT_JSON)
+        printf(results_printed == 0 ? "[]\n" : "\n]\n");
+    return 0;
+}
@@ -7,6 +7,11 @@
 
 #include <stddef.h>
 #include <stdio.h>
+#include <limits.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
 #include "BlockingQueue.h"
 
 /*
@@ -16,44 +21,526 @@
 
 
 BlockingQueue *new_BlockingQueue(int max_size) {
+    return new_BlockingQueueWithBackend(max_size, BLOCKING_QUEUE_MUTEX);
+}
+
+BlockingQueue *new_BlockingQueueWithBackend(int max_size, BlockingQueueBackend backend) {
     BlockingQueue *bQueue = malloc(sizeof(BlockingQueue));
-    bQueue->queue = new_Queue(max_size);
-    
+    if (bQueue == NULL) return NULL;
+
+    bQueue->backend = backend;
+    bQueue->queue = NULL;
+    bQueue->segments = NULL;
+    bQueue->ring = NULL;
+    if (backend == BLOCKING_QUEUE_LOCK_FREE)
+        bQueue->ring = new_MpmcQueue(max_size);
+    else if (backend == BLOCKING_QUEUE_UNBOUNDED)
+        bQueue->segments = new_SegmentedQueue(max_size);
+    else
+        bQueue->queue = new_Queue(max_size);
+
+    if (bQueue->queue == NULL && bQueue->segments == NULL && bQueue->ring == NULL) {
+        free(bQueue);
+        return NULL;
+    }
+
     pthread_mutex_init(&bQueue->mutex, NULL);
-    sem_init(&bQueue->available, 0, max_size);
-    sem_init(&bQueue->current_size, 0, 0);
+    atomic_init(&bQueue->available, max_size);
+    atomic_init(&bQueue->current_size, 0);
+
+    EventCount_init(&bQueue->not_full, EVENT_COUNT_DEFAULT_SPIN);
+    EventCount_init(&bQueue->not_empty, EVENT_COUNT_DEFAULT_SPIN);
+    bQueue->event_fd = -1;
+    atomic_init(&bQueue->fd_signalled, false);
+    pthread_mutex_init(&bQueue->select_mutex, NULL);
+    bQueue->selectors = NULL;
+    atomic_init(&bQueue->selector_count, 0);
+    bQueue->node = -1;
+    bQueue->overflow = QUEUE_OVERFLOW_REJECT;
+    bQueue->reclaim = NULL;
+    atomic_init(&bQueue->dropped, 0);
+    bQueue->stats = NULL;
     return bQueue;
 }
 
+BlockingQueue *new_UnboundedBlockingQueue(int segment_size) {
+    return new_BlockingQueueWithBackend(segment_size, BLOCKING_QUEUE_UNBOUNDED);
+}
+
+/*
+ * Arguments and result of a construction run on a NUMA node
+ */
+typedef struct {
+    int max_size, node;
+    BlockingQueueBackend backend;
+    BlockingQueue* result;
+} NodeConstruction;
+
+/*
+ * Builds the queue and faults its ring in, called with the thread pinned to the node.
+ */
+static void constructOnNode(void* arg) {
+    NodeConstruction *c = arg;
+    BlockingQueue *bQueue = new_BlockingQueueWithBackend(c->max_size, c->backend);
+
+    if (bQueue != NULL) {
+        if (bQueue->queue != NULL)
+            QueueAffinity_placeMemory(bQueue->queue->data, bQueue->queue->max_size * sizeof(void *), c->node);
+        else if (bQueue->ring != NULL)
+            QueueAffinity_placeMemory(bQueue->ring->slots, bQueue->ring->max_size * sizeof(MpmcSlot), c->node);
+        else
+            QueueAffinity_placeMemory(bQueue->segments->first->data, bQueue->segments->segment_size * sizeof(void *), c->node);
+        bQueue->node = c->node;
+    }
+    c->result = bQueue;
+}
+
+BlockingQueue *new_BlockingQueueOnNode(int max_size, BlockingQueueBackend backend, int node) {
+    NodeConstruction c = { max_size, node, backend, NULL };
+
+    if (!QueueAffinity_runOnNode(node, constructOnNode, &c))
+        return new_BlockingQueueWithBackend(max_size, backend);
+    return c.result;
+}
+
+int BlockingQueue_node(BlockingQueue* this) {
+    return this->node;
+}
+
+bool BlockingQueue_pinNear(BlockingQueue* this) {
+    return this->node >= 0 && QueueAffinity_pinToNode(this->node);
+}
+
+void BlockingQueue_setSpin(BlockingQueue* this, int spin) {
+    this->not_full.spin = spin;
+    this->not_empty.spin = spin;
+}
+
+void BlockingQueue_setOverflow(BlockingQueue* this, QueueOverflow policy, QueueReclaim reclaim) {
+    this->overflow = policy;
+    this->reclaim = reclaim;
+}
+
+long BlockingQueue_dropped(BlockingQueue* this) {
+    return atomic_load(&(this->dropped));
+}
+
+#ifdef QUEUE_STATS
+static long nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+#endif
+
+/*
+ * Takes the mutex, counting a contention when statistics are enabled and it is already held.
+ */
+static void lockMutex(BlockingQueue* this) {
+#ifdef QUEUE_STATS
+    if (this->stats != NULL) {
+        if (pthread_mutex_trylock(&(this->mutex)) == 0)
+            return;
+        QUEUE_STATS_ADD(this->stats, contentions, 1);
+    }
+#endif
+    pthread_mutex_lock(&(this->mutex));
+}
+
+/*
+ * Blocks on event until ready(arg), recording the wait when statistics are enabled.
+ */
+static void waitFor(BlockingQueue* this, EventCount* event, bool (*ready)(void*), void* arg) {
+#ifdef QUEUE_STATS
+    if (this->stats != NULL) {
+        long start = nowNs();
+        if (event == &(this->not_full))
+            QUEUE_STATS_ADD(this->stats, full, 1);
+        else
+            QUEUE_STATS_ADD(this->stats, empty, 1);
+        EventCount_await(event, ready, arg);
+        QUEUE_STATS_ADD(this->stats, blocked_ns, nowNs() - start);
+        return;
+    }
+#else
+    (void)this;
+#endif
+    EventCount_await(event, ready, arg);
+}
+
+/*
+ * Claims up to want units of counter like EventCount_claim, recording a wait for the first
+ * one when statistics are enabled.
+ * Returns the number of units claimed.
+ */
+static int counterClaim(BlockingQueue* this, atomic_int* counter, EventCount* event, int want, bool block) {
+#ifdef QUEUE_STATS
+    if (this->stats != NULL && block) {
+        int claimed = EventCount_claim(event, counter, want, false);
+        if (claimed > 0)
+            return claimed;
+        long start = nowNs();
+        if (event == &(this->not_full))
+            QUEUE_STATS_ADD(this->stats, full, 1);
+        else
+            QUEUE_STATS_ADD(this->stats, empty, 1);
+        claimed = EventCount_claim(event, counter, want, true);
+        QUEUE_STATS_ADD(this->stats, blocked_ns, nowNs() - start);
+        return claimed;
+    }
+#else
+    (void)this;
+#endif
+    return EventCount_claim(event, counter, want, block);
+}
+
+/*
+ * Makes the eventfd readable after elements were enqueued, unless it already is.
+ */
+static void signalFd(BlockingQueue* this) {
+    if (this->event_fd < 0 || atomic_exchange(&(this->fd_signalled), true))
+        return;
+
+    // cannot fail: the counter never holds more than the one pending signal
+    uint64_t one = 1;
+    ssize_t written = write(this->event_fd, &one, sizeof(one));
+    (void)written;
+}
+
+/*
+ * Wakes every thread in BlockingQueue_deqAny registered with this queue.
+ */
+static void notifySelectors(BlockingQueue* this) {
+    if (atomic_load(&(this->selector_count)) == 0)
+        return;
+
+    pthread_mutex_lock(&(this->select_mutex));
+    for (QueueSelectLink *link = this->selectors; link != NULL; link = link->next)
+        EventCount_notify(&link->selector->ready, 0);
+    pthread_mutex_unlock(&(this->select_mutex));
+}
+
+/*
+ * Tells readers not blocked in deq itself that elements were enqueued.
+ */
+static void signalReaders(BlockingQueue* this) {
+    notifySelectors(this);
+    signalFd(this);
+}
+
+/*
+ * The storage behind the mutex-based backends, called with the mutex held.
+ */
+static int storeEnqMany(BlockingQueue* this, void** elements, int count) {
+    if (this->backend == BLOCKING_QUEUE_UNBOUNDED)
+        return SegmentedQueue_enqMany(this->segments, elements, count);
+    return Queue_enqMany(this->queue, elements, count);
+}
+
+static int storeDeqMany(BlockingQueue* this, void** out, int max) {
+    if (this->backend == BLOCKING_QUEUE_UNBOUNDED)
+        return SegmentedQueue_deqMany(this->segments, out, max);
+    return Queue_deqMany(this->queue, out, max);
+}
+
+static int storeSize(BlockingQueue* this) {
+    if (this->backend == BLOCKING_QUEUE_UNBOUNDED)
+        return SegmentedQueue_size(this->segments);
+    return Queue_size(this->queue);
+}
+
+/*
+ * Claims count free slots for an enq, blocking until they are available.
+ * Unbounded queues always have room, so nothing is claimed.
+ */
+static int claimSpace(BlockingQueue* this, int count) {
+    if (this->backend == BLOCKING_QUEUE_UNBOUNDED)
+        return count;
+    return counterClaim(this, &(this->available), &(this->not_full), count, true);
+}
+
+static void releaseSpace(BlockingQueue* this, int count) {
+    if (this->backend != BLOCKING_QUEUE_UNBOUNDED && count > 0)
+        EventCount_release(&(this->not_full), &(this->available), count);
+}
+
+/*
+ * Counts element as dropped by the overflow policy and hands it to the reclaim callback.
+ */
+static void dropElement(BlockingQueue* this, void* element) {
+    atomic_fetch_add_explicit(&(this->dropped), 1, memory_order_relaxed);
+    if (this->reclaim != NULL)
+        this->reclaim(element);
+}
+
+/*
+ * Returns true if QUEUE_OVERFLOW_SAMPLE turns away an element arriving with size of capacity
+ * elements queued. Each thread draws from its own random state, seeded the first time it is
+ * needed, so producers share nothing and do not all drop the same elements of a burst.
+ */
+static bool sampleRejects(BlockingQueue* this, int size, int capacity) {
+    static _Thread_local unsigned seed;
+
+    if (this->overflow != QUEUE_OVERFLOW_SAMPLE)
+        return false;
+    if (seed == 0)
+        seed = QueueOverflow_newSeed(&seed); // the address differs per thread
+    return !QueueOverflow_sampleAdmits(size, capacity, &seed);
+}
+
+/*
+ * Claims a free slot for an enq under an overflow policy, without blocking, when the queue
+ * is bounded. When there is none, element is dropped, or under QUEUE_OVERFLOW_OVERWRITE_OLDEST
+ * swapped in for the oldest element.
+ * Returns true if a slot was claimed for element, false if element has been dealt with.
+ */
+static bool claimSpaceOrOverflow(BlockingQueue* this, void* element) {
+    int capacity = this->queue->max_size - 1;
+
+    for (;;) {
+        if (sampleRejects(this, atomic_load_explicit(&(this->current_size), memory_order_relaxed), capacity)) {
+            dropElement(this, element);
+            return false;
+        }
+        if (counterClaim(this, &(this->available), &(this->not_full), 1, false) == 1)
+            return true;
+        QUEUE_STATS_ADD(this->stats, full, 1);
+        if (this->overflow != QUEUE_OVERFLOW_OVERWRITE_OLDEST) {
+            dropElement(this, element);
+            return false;
+        }
+
+        // claim the oldest element like a deq would, and put element in its place
+        if (counterClaim(this, &(this->current_size), &(this->not_empty), 1, false) == 1) {
+            void *oldest = NULL;
+            lockMutex(this);
+            Queue_deqMany(this->queue, &oldest, 1);
+            Queue_enqMany(this->queue, &element, 1);
+            pthread_mutex_unlock(&(this->mutex));
+
+            EventCount_release(&(this->not_empty), &(this->current_size), 1);
+            signalReaders(this);
+            QUEUE_STATS_ADD(this->stats, enqs, 1);
+            dropElement(this, oldest);
+            return false;
+        }
+        // every element is claimed by a deq about to free its slot, so try again
+        sched_yield();
+    }
+}
+
+/*
+ * Stores element in the lock-free ring under an overflow policy, without blocking.
+ * Returns true if element was stored and false if it was dropped.
+ */
+static bool lockFreeOverflowEnq(BlockingQueue* this, void* element) {
+    for (;;) {
+        if (sampleRejects(this, MpmcQueue_size(this->ring), (int)this->ring->max_size)) {
+            dropElement(this, element);
+            return false;
+        }
+        if (MpmcQueue_tryEnq(this->ring, element))
+            return true;
+        QUEUE_STATS_ADD(this->stats, full, 1);
+        if (this->overflow != QUEUE_OVERFLOW_OVERWRITE_OLDEST) {
+            dropElement(this, element);
+            return false;
+        }
+        void *oldest = MpmcQueue_tryDeq(this->ring);
+        if (oldest != NULL)
+            dropElement(this, oldest);
+    }
+}
+
+static bool ringNotFull(void* this) {
+    MpmcQueue *ring = ((BlockingQueue *)this)->ring;
+    return MpmcQueue_size(ring) < (int)ring->max_size;
+}
+
+static bool ringNotEmpty(void* this) {
+    return !MpmcQueue_isEmpty(((BlockingQueue *)this)->ring);
+}
+
+static bool lockFreeEnq(BlockingQueue* this, void* element) {
+    if (this->overflow != QUEUE_OVERFLOW_REJECT) {
+        if (!lockFreeOverflowEnq(this, element))
+            return true;
+    } else {
+        while (!MpmcQueue_tryEnq(this->ring, element))
+            waitFor(this, &(this->not_full), ringNotFull, this);
+    }
+
+    EventCount_notify(&(this->not_empty), 1);
+    signalReaders(this);
+    QUEUE_STATS_ADD(this->stats, enqs, 1);
+    QUEUE_STATS_MAX(this->stats, high_water, MpmcQueue_size(this->ring));
+    return true;
+}
+
+static void* lockFreeDeq(BlockingQueue* this) {
+    void *element;
+
+    while ((element = MpmcQueue_tryDeq(this->ring)) == NULL)
+        waitFor(this, &(this->not_empty), ringNotEmpty, this);
+
+    EventCount_notify(&(this->not_full), 1);
+    QUEUE_STATS_ADD(this->stats, deqs, 1);
+    return element;
+}
+
 bool BlockingQueue_enq(BlockingQueue* this, void* element) {
-    sem_wait(&(this->available)); // Wait for space in the queue
+    if (element == NULL)
+        return false;
+    if (this->backend == BLOCKING_QUEUE_LOCK_FREE)
+        return lockFreeEnq(this, element);
 
-    pthread_mutex_lock(&(this->mutex)); 
-    bool result = Queue_enq(this->queue, element);
+    if (this->overflow != QUEUE_OVERFLOW_REJECT && this->backend == BLOCKING_QUEUE_MUTEX) {
+        if (!claimSpaceOrOverflow(this, element))
+            return true;
+    } else {
+        claimSpace(this, 1); // Wait for space in the queue
+    }
+
+    lockMutex(this); 
+    bool result = storeEnqMany(this, &element, 1) == 1;
+    QUEUE_STATS_MAX(this->stats, high_water, storeSize(this));
     pthread_mutex_unlock(&(this->mutex));
 
-    if (result) sem_post(&(this->current_size)); // Signal that there is an element in the queue
+    if (result) {
+        EventCount_release(&(this->not_empty), &(this->current_size), 1); // Signal that there is an element in the queue
+        signalReaders(this);
+    }
+    QUEUE_STATS_ADD(this->stats, enqs, result);
 
     return result;
 }
 
 void* BlockingQueue_deq(BlockingQueue* this) {
-    sem_wait(&(this->current_size)); // Wait for an element in the queue, current size above 0
-    pthread_mutex_lock(&(this->mutex)); 
+    if (this->backend == BLOCKING_QUEUE_LOCK_FREE)
+        return lockFreeDeq(this);
+
+    counterClaim(this, &(this->current_size), &(this->not_empty), 1, true); // Wait for an element in the queue, current size above 0
+    lockMutex(this); 
 
-    void* element = Queue_deq(this->queue);
+    void* element = NULL;
+    storeDeqMany(this, &element, 1);
 
     pthread_mutex_unlock(&(this->mutex));
-    sem_post(&(this->available)); // Signal that there is space in the queue
+    releaseSpace(this, 1); // Signal that there is space in the queue
+    QUEUE_STATS_ADD(this->stats, deqs, 1);
 
     return element;
 }
 
+static bool lockFreeEnqBatch(BlockingQueue* this, void** elements, int count) {
+    int done = 0;
+
+    while (done < count) {
+        int moved = 0;
+        while (done < count && MpmcQueue_tryEnq(this->ring, elements[done])) {
+            done++;
+            moved++;
+        }
+        if (moved > 0) {
+            EventCount_notify(&(this->not_empty), moved);
+            signalReaders(this);
+            QUEUE_STATS_ADD(this->stats, enqs, moved);
+            QUEUE_STATS_MAX(this->stats, high_water, MpmcQueue_size(this->ring));
+        }
+        if (done < count)
+            waitFor(this, &(this->not_full), ringNotFull, this);
+    }
+    return true;
+}
+
+static int lockFreeDeqBatch(BlockingQueue* this, void** out, int min, int max) {
+    int done = 0;
+
+    for (;;) {
+        int moved = 0;
+        while (done < max && (out[done] = MpmcQueue_tryDeq(this->ring)) != NULL) {
+            done++;
+            moved++;
+        }
+        if (moved > 0) {
+            EventCount_notify(&(this->not_full), moved);
+            QUEUE_STATS_ADD(this->stats, deqs, moved);
+        }
+        if (done >= min)
+            return done;
+        waitFor(this, &(this->not_empty), ringNotEmpty, this);
+    }
+}
+
+bool BlockingQueue_enqBatch(BlockingQueue* this, void** elements, int count) {
+    int done = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (elements[i] == NULL)
+            return false;
+    }
+    if (this->overflow != QUEUE_OVERFLOW_REJECT && this->backend != BLOCKING_QUEUE_UNBOUNDED) {
+        // the policy decides element by element, and none of them waits
+        for (int i = 0; i < count; i++)
+            BlockingQueue_enq(this, elements[i]);
+        return true;
+    }
+    if (this->backend == BLOCKING_QUEUE_LOCK_FREE)
+        return lockFreeEnqBatch(this, elements, count);
+
+    while (done < count) {
+        int claimed = claimSpace(this, count - done); // Wait for space in the queue
+
+        lockMutex(this);
+        int moved = storeEnqMany(this, elements + done, claimed);
+        QUEUE_STATS_MAX(this->stats, high_water, storeSize(this));
+        pthread_mutex_unlock(&(this->mutex));
+
+        if (moved > 0) {
+            EventCount_release(&(this->not_empty), &(this->current_size), moved); // Signal the elements now in the queue
+            signalReaders(this);
+        }
+        QUEUE_STATS_ADD(this->stats, enqs, moved);
+        done += moved;
+        if (moved < claimed)
+            return false; // only an unbounded queue can fall short, when out of memory
+    }
+    return true;
+}
+
+int BlockingQueue_deqBatch(BlockingQueue* this, void** out, int min, int max) {
+    int done = 0;
+
+    if (min > max)
+        min = max;
+    if (this->backend == BLOCKING_QUEUE_LOCK_FREE)
+        return lockFreeDeqBatch(this, out, min, max);
+
+    while (done < max) {
+        // Wait for elements in the queue until min is satisfied, then only take what is available
+        int claimed = counterClaim(this, &(this->current_size), &(this->not_empty), max - done, done < min);
+        if (claimed == 0)
+            break;
+
+        lockMutex(this);
+        storeDeqMany(this, out + done, claimed);
+        pthread_mutex_unlock(&(this->mutex));
+
+        releaseSpace(this, claimed); // Signal the space freed in the queue
+        QUEUE_STATS_ADD(this->stats, deqs, claimed);
+        done += claimed;
+    }
+    return done;
+}
+
 int BlockingQueue_size(BlockingQueue* this) {
     int size;
 
-    pthread_mutex_lock(&(this->mutex));
-    size = Queue_size(this->queue);
+    if (this->backend == BLOCKING_QUEUE_LOCK_FREE)
+        return MpmcQueue_size(this->ring);
+
+    lockMutex(this);
+    size = storeSize(this);
     pthread_mutex_unlock(&(this->mutex));
 
     return size;
@@ -62,25 +549,211 @@ int BlockingQueue_size(BlockingQueue* this) {
 bool BlockingQueue_isEmpty(BlockingQueue* this) {
     bool isEmpty;
 
-    pthread_mutex_lock(&(this->mutex));
-    isEmpty = Queue_isEmpty(this->queue);
+    if (this->backend == BLOCKING_QUEUE_LOCK_FREE)
+        return MpmcQueue_isEmpty(this->ring);
+
+    lockMutex(this);
+    isEmpty = storeSize(this) == 0;
     pthread_mutex_unlock(&(this->mutex));
 
     return isEmpty;
 }
 
 void BlockingQueue_clear(BlockingQueue* this) {
-    pthread_mutex_lock(&(this->mutex));
-    Queue_clear(this->queue);
+    int claimed;
+
+    if (this->backend == BLOCKING_QUEUE_LOCK_FREE) {
+        MpmcQueue_clear(this->ring);
+        EventCount_notify(&(this->not_full), 0);
+        return;
+    }
+
+    // claim every unclaimed element like a deq would, so in-flight deqs keep theirs
+    claimed = counterClaim(this, &(this->current_size), &(this->not_empty), INT_MAX, false);
+
+    lockMutex(this);
+    for (int i = 0; i < claimed; i++) {
+        void *discard;
+        storeDeqMany(this, &discard, 1);
+    }
     pthread_mutex_unlock(&(this->mutex));
+
+    releaseSpace(this, claimed);
+}
+
+void* BlockingQueue_tryDeq(BlockingQueue* this) {
+    void *element;
+
+    if (BlockingQueue_deqBatch(this, &element, 0, 1) == 0)
+        return NULL;
+    return element;
+}
+
+bool BlockingQueue_enableFd(BlockingQueue* this) {
+    if (this->event_fd < 0)
+        this->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return this->event_fd >= 0;
+}
+
+int BlockingQueue_fd(BlockingQueue* this) {
+    return this->event_fd;
+}
+
+int BlockingQueue_drain(BlockingQueue* this, void** out, int max) {
+    if (this->event_fd >= 0) {
+        // reset the fd before looking at the queue, so an enq racing with us signals it again;
+        // the read fails with EAGAIN when it was not signalled, which is fine
+        uint64_t count;
+        ssize_t got = read(this->event_fd, &count, sizeof(count));
+        (void)got;
+        atomic_store(&(this->fd_signalled), false);
+    }
+
+    int done = BlockingQueue_deqBatch(this, out, 0, max);
+    if (done == max && !BlockingQueue_isEmpty(this))
+        signalFd(this);
+    return done;
+}
+
+/*
+ * Returns true if this queue holds an element not yet claimed by a deq, without locking.
+ */
+static bool hasElement(BlockingQueue* this) {
+    if (this->backend == BLOCKING_QUEUE_LOCK_FREE)
+        return !MpmcQueue_isEmpty(this->ring);
+    return atomic_load(&(this->current_size)) > 0;
+}
+
+/*
+ * The queues a selector waits on
+ */
+typedef struct SelectSet {
+    BlockingQueue** queues;
+    int n;
+} SelectSet;
+
+static bool anyHasElement(void* arg) {
+    SelectSet *set = arg;
+    for (int i = 0; i < set->n; i++) {
+        if (hasElement(set->queues[i]))
+            return true;
+    }
+    return false;
+}
+
+/*
+ * Tries each queue once, from start round to start - 1.
+ * Returns the dequeued element and sets *index, or returns NULL if every queue is empty.
+ */
+static void* tryDeqAny(BlockingQueue** queues, int n, int start, int* index) {
+    for (int i = 0; i < n; i++) {
+        int q = (start + i) % n;
+        void *element = BlockingQueue_tryDeq(queues[q]);
+        if (element != NULL) {
+            *index = q;
+            return element;
+        }
+    }
+    return NULL;
+}
+
+static void* deqAny(BlockingQueue** queues, int n, int start, int* index) {
+    QueueSelector selector;
+    QueueSelectLink links[n];
+    SelectSet set = { queues, n };
+    void *element;
+
+    if ((element = tryDeqAny(queues, n, start, index)) != NULL)
+        return element;
+
+    // register with every queue before waiting, so an enq after our last check wakes us
+    EventCount_init(&selector.ready, queues[0]->not_empty.spin);
+    for (int i = 0; i < n; i++) {
+        links[i].selector = &selector;
+        pthread_mutex_lock(&(queues[i]->select_mutex));
+        links[i].next = queues[i]->selectors;
+        queues[i]->selectors = &links[i];
+        atomic_fetch_add(&(queues[i]->selector_count), 1);
+        pthread_mutex_unlock(&(queues[i]->select_mutex));
+    }
+
+    // another consumer may take the element we were woken for, in which case wait again
+    while ((element = tryDeqAny(queues, n, start, index)) == NULL)
+        EventCount_await(&selector.ready, anyHasElement, &set);
+
+    for (int i = 0; i < n; i++) {
+        pthread_mutex_lock(&(queues[i]->select_mutex));
+        QueueSelectLink **link = &(queues[i]->selectors);
+        while (*link != &links[i])
+            link = &(*link)->next;
+        *link = links[i].next;
+        atomic_fetch_sub(&(queues[i]->selector_count), 1);
+        pthread_mutex_unlock(&(queues[i]->select_mutex));
+    }
+    return element;
+}
+
+void* BlockingQueue_deqAny(BlockingQueue** queues, int n, int* index) {
+    if (queues == NULL || n <= 0)
+        return NULL;
+
+    int found;
+    void *element = deqAny(queues, n, 0, &found);
+
+    if (index != NULL)
+        *index = found;
+    return element;
+}
+
+void* BlockingQueue_deqAnyFair(BlockingQueue** queues, int n, int* index, int* cursor) {
+    if (queues == NULL || n <= 0 || cursor == NULL)
+        return NULL;
+
+    int found, start = *cursor % n;
+    void *element = deqAny(queues, n, start < 0 ? start + n : start, &found);
+
+    *cursor = (found + 1) % n;
+    if (index != NULL)
+        *index = found;
+    return element;
+}
+
+bool BlockingQueue_enableStats(BlockingQueue* this) {
+#ifdef QUEUE_STATS
+    if (this->stats == NULL)
+        this->stats = new_QueueStats();
+    return this->stats != NULL;
+#else
+    (void)this;
+    return false;
+#endif
+}
+
+bool BlockingQueue_getStats(BlockingQueue* this, QueueStatsSnapshot* out) {
+#ifdef QUEUE_STATS
+    if (this->stats == NULL)
+        return false;
+    QueueStats_snapshot(this->stats, out);
+    return true;
+#else
+    (void)this;
+    (void)out;
+    return false;
+#endif
 }
 
 void BlockingQueue_destroy(BlockingQueue* this) {
-    pthread_mutex_destroy(&(this->mutex));
-    sem_destroy(&(this->available));
-    sem_destroy(&(this->current_size));
-    Queue_destroy(this->queue);
-    free(this);
+    if(this) {
+        free(this->stats);
+        if (this->event_fd >= 0)
+            close(this->event_fd);
+        pthread_mutex_destroy(&(this->select_mutex));
+        pthread_mutex_destroy(&(this->mutex));
+        Queue_destroy(this->queue);
+        SegmentedQueue_destroy(this->segments);
+        MpmcQueue_destroy(this->ring);
+        free(this);
+    }
 }
 
 // int main() {
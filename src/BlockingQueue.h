@@ -11,17 +11,81 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <pthread.h>
-#include <semaphore.h>
+#include <stdatomic.h>
 
 #include "Queue.h"
+#include "MpmcQueue.h"
+#include "SegmentedQueue.h"
+#include "EventCount.h"
+#include "QueueAffinity.h"
 
 typedef struct BlockingQueue BlockingQueue;
+typedef struct QueueSelector QueueSelector;
+typedef struct QueueSelectLink QueueSelectLink;
+
+/*
+ * A thread blocked in BlockingQueue_deqAny, woken by an enq on any queue it is registered with
+ */
+struct QueueSelector {
+    EventCount ready;
+};
+
+/*
+ * A selector's registration with one queue
+ */
+struct QueueSelectLink {
+    QueueSelector* selector;
+    QueueSelectLink* next;
+};
+
+/*
+ * Storage used behind the BlockingQueue API.
+ * BLOCKING_QUEUE_MUTEX serialises every operation on one mutex around a Queue.
+ * BLOCKING_QUEUE_LOCK_FREE uses an MpmcQueue and only blocks when the ring is full or empty.
+ * BLOCKING_QUEUE_UNBOUNDED serialises operations like BLOCKING_QUEUE_MUTEX around a SegmentedQueue,
+ * so enq never blocks and max_size is the number of elements per segment.
+ */
+typedef enum BlockingQueueBackend {
+    BLOCKING_QUEUE_MUTEX,
+    BLOCKING_QUEUE_LOCK_FREE,
+    BLOCKING_QUEUE_UNBOUNDED
+} BlockingQueueBackend;
 
 /* You should define your struct BlockingQueue here */
 struct BlockingQueue {
+    BlockingQueueBackend backend;
+
+    // BLOCKING_QUEUE_MUTEX and BLOCKING_QUEUE_UNBOUNDED; current_size and available count the
+    // elements and free slots not yet claimed by a deq or enq, and act as counting semaphores
+    // (available is unused when unbounded)
     Queue* queue;
+    SegmentedQueue* segments;
     pthread_mutex_t mutex;
-    sem_t current_size, available;
+    atomic_int current_size, available;
+
+    // BLOCKING_QUEUE_LOCK_FREE
+    MpmcQueue* ring;
+
+    // threads park here only when the queue is full or empty
+    EventCount not_full, not_empty;
+
+    // eventfd made readable by the first enq after a drain, -1 unless enabled
+    int event_fd;
+    atomic_bool fd_signalled;
+
+    // threads in BlockingQueue_deqAny waiting on this queue among others
+    pthread_mutex_t select_mutex;
+    QueueSelectLink* selectors;
+    atomic_int selector_count;
+
+    int node; // NUMA node the ring was placed on, -1 if not placed
+
+    // what a bounded enq does when the queue is full
+    QueueOverflow overflow;
+    QueueReclaim reclaim; // NULL to just drop
+    atomic_long dropped;
+
+    QueueStats* stats; // NULL unless enabled, kept without QUEUE_STATS so the layout never changes
 };
 
 /*
@@ -30,10 +94,69 @@ struct BlockingQueue {
  */
 BlockingQueue* new_BlockingQueue(int max_size);
 
+/*
+ * Creates a new BlockingQueue for at most max_size void* elements using the given backend.
+ * new_BlockingQueue(max_size) is equivalent to passing BLOCKING_QUEUE_MUTEX.
+ * Returns a pointer to a new BlockingQueue on success and NULL on failure.
+ */
+BlockingQueue* new_BlockingQueueWithBackend(int max_size, BlockingQueueBackend backend);
+
+/*
+ * Creates a new unbounded BlockingQueue which grows segment_size void* elements at a time.
+ * Equivalent to new_BlockingQueueWithBackend(segment_size, BLOCKING_QUEUE_UNBOUNDED).
+ * Returns a pointer to a new BlockingQueue on success and NULL on failure.
+ */
+BlockingQueue* new_UnboundedBlockingQueue(int segment_size);
+
+/*
+ * Creates a new BlockingQueue like new_BlockingQueueWithBackend, with its ring allocated and
+ * faulted in on NUMA node node (see QueueAffinity.h), so threads on that node enq and deq
+ * through local memory. An unbounded queue places its first segment; later segments land
+ * wherever the enq that needs them runs, so pin producers with BlockingQueue_pinNear.
+ * If the calling thread cannot run on node the queue is still created, unplaced, and
+ * BlockingQueue_node returns -1.
+ * Returns a pointer to a new BlockingQueue on success and NULL on failure.
+ */
+BlockingQueue* new_BlockingQueueOnNode(int max_size, BlockingQueueBackend backend, int node);
+
+/*
+ * Returns the NUMA node this Queue was placed on, or -1 if it was not placed.
+ */
+int BlockingQueue_node(BlockingQueue* this);
+
+/*
+ * Pins the calling thread to the CPUs of the node this Queue was placed on, for producers
+ * and consumers that should use the queue through local memory.
+ * Returns true on success and false if the queue was not placed or the thread cannot be moved.
+ */
+bool BlockingQueue_pinNear(BlockingQueue* this);
+
+/*
+ * Sets how many times a blocked enq or deq re-checks this Queue, with a pause in between,
+ * before parking the calling thread in the kernel. Defaults to EVENT_COUNT_DEFAULT_SPIN.
+ * Must not be called while other threads are using the queue.
+ */
+void BlockingQueue_setSpin(BlockingQueue* this, int spin);
+
+/*
+ * Sets what an enq on this Queue does when it is full (see QueueOverflow in Queue.h), and the
+ * function dropped elements are passed to, which may be NULL. Under any policy but the default
+ * QUEUE_OVERFLOW_REJECT, enq and enqBatch never block. An unbounded queue is never full, so
+ * the policy has no effect on it.
+ * Must not be called while other threads are using the queue.
+ */
+void BlockingQueue_setOverflow(BlockingQueue* this, QueueOverflow policy, QueueReclaim reclaim);
+
+/*
+ * Returns the number of elements this Queue's overflow policy has dropped so far.
+ */
+long BlockingQueue_dropped(BlockingQueue* this);
+
 /*
  * Enqueues the given void* element at the back of this Queue.
- * If the queue is full, the function will block the calling thread until there is space in the queue.
- * Returns false when element is NULL and true on success.
+ * If the queue is full, the function will block the calling thread until there is space in the queue,
+ * unless an overflow policy is set, in which case it stores or drops element without blocking.
+ * Returns false when element is NULL (or an unbounded queue is out of memory) and true on success.
  */
 bool BlockingQueue_enq(BlockingQueue* this, void* element);
 
@@ -44,6 +167,22 @@ bool BlockingQueue_enq(BlockingQueue* this, void* element);
  */
 void* BlockingQueue_deq(BlockingQueue* this);
 
+/*
+ * Enqueues all count void* elements from the elements array at the back of this Queue, in order.
+ * Elements are moved in as few critical sections as the free space allows; if the queue is full,
+ * the function will block the calling thread until there is space for the rest.
+ * Returns false without enqueuing anything when any element is NULL and true on success
+ * (an unbounded queue that runs out of memory returns false with a prefix enqueued).
+ */
+bool BlockingQueue_enqBatch(BlockingQueue* this, void** elements, int count);
+
+/*
+ * Dequeues between min and max elements from the front of this Queue into the out array, in order.
+ * Blocks until at least min elements have been dequeued, then takes whatever else is available up to max.
+ * Returns the number of elements dequeued.
+ */
+int BlockingQueue_deqBatch(BlockingQueue* this, void** out, int min, int max);
+
 /*
  * Returns the number of elements currently in this Queue.
  */
@@ -59,6 +198,64 @@ bool BlockingQueue_isEmpty(BlockingQueue* this);
  */
 void BlockingQueue_clear(BlockingQueue* this);
 
+/*
+ * Dequeues an element from the front of this Queue without blocking.
+ * Returns the dequeued void* element, or NULL if the queue is empty.
+ */
+void* BlockingQueue_tryDeq(BlockingQueue* this);
+
+/*
+ * Creates an eventfd for this Queue which becomes readable when elements are available,
+ * for waiting on the queue with poll, select or epoll.
+ * Enqueues signal it only when it is not already signalled, so a burst costs one write().
+ * Must not be called while other threads are using the queue.
+ * Returns true on success and false when the eventfd cannot be created.
+ */
+bool BlockingQueue_enableFd(BlockingQueue* this);
+
+/*
+ * Returns the eventfd of this Queue, or -1 if BlockingQueue_enableFd has not been called.
+ */
+int BlockingQueue_fd(BlockingQueue* this);
+
+/*
+ * Acknowledges this Queue's eventfd, then dequeues up to max elements into the out array,
+ * in order, without blocking. If elements remain afterwards the eventfd is signalled again,
+ * so a readiness loop should call this until it returns less than max or the fd is quiet.
+ * Returns the number of elements dequeued, which is 0 if the queue is empty.
+ */
+int BlockingQueue_drain(BlockingQueue* this, void** out, int max);
+
+/*
+ * Dequeues an element from whichever of the n queues has one, blocking until one does.
+ * Queues are tried in array order, so an earlier queue is always preferred.
+ * A blocked caller registers with every queue and is woken by the next enq on any of them.
+ * Stores the position in queues of the queue dequeued from in index, unless index is NULL.
+ * Returns the dequeued void* element, or NULL straight away when queues is NULL or n <= 0.
+ */
+void* BlockingQueue_deqAny(BlockingQueue** queues, int n, int* index);
+
+/*
+ * Like BlockingQueue_deqAny, but tries the queues round-robin starting at *cursor, and
+ * moves *cursor past the queue dequeued from, so a busy queue cannot starve the others.
+ * *cursor should start at 0 and be kept between calls.
+ * Returns NULL straight away when queues or cursor is NULL or n <= 0.
+ */
+void* BlockingQueue_deqAnyFair(BlockingQueue** queues, int n, int* index, int* cursor);
+
+/*
+ * Starts recording statistics for this Queue, including time blocked and mutex contention.
+ * Must not be called while other threads are using the queue.
+ * Returns true on success and false when out of memory or not compiled with QUEUE_STATS.
+ */
+bool BlockingQueue_enableStats(BlockingQueue* this);
+
+/*
+ * Copies the statistics recorded for this Queue into out without locking the queue.
+ * Returns true on success and false when statistics are not enabled for this Queue.
+ */
+bool BlockingQueue_getStats(BlockingQueue* this, QueueStatsSnapshot* out);
+
 /*
  * Destroys this Queue by freeing the memory used by the Queue.
  */
@@ -0,0 +1,135 @@
+/*
+ * BlockingQueue.hpp
+ *
+ * Header-only C++ interface for a typed fixed-size Blocking Queue whose capacity is a
+ * template argument.
+ *
+ * A cqueue::Queue<T, Capacity> guarded by one mutex, with producers waiting for space and
+ * consumers waiting for elements on condition variables. Like the C BlockingQueue with the
+ * BLOCKING_QUEUE_MUTEX backend, but the ring lives inside the object and holds T by value.
+ *
+ */
+
+#ifndef BLOCKING_QUEUE_HPP_
+#define BLOCKING_QUEUE_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+#include "Queue.hpp"
+
+namespace cqueue {
+
+template <typename T, std::size_t Capacity>
+class BlockingQueue {
+public:
+    BlockingQueue() = default;
+    BlockingQueue(const BlockingQueue&) = delete;
+    BlockingQueue& operator=(const BlockingQueue&) = delete;
+
+    /*
+     * Returns the number of elements this Queue can hold.
+     */
+    static constexpr std::size_t capacity() { return Capacity; }
+
+    /*
+     * Copies element to the back of this Queue.
+     * If the queue is full, blocks the calling thread until there is space in the queue.
+     */
+    void enq(const T& element) { emplace(element); }
+
+    /*
+     * Moves element to the back of this Queue.
+     * If the queue is full, blocks the calling thread until there is space in the queue.
+     */
+    void enq(T&& element) { emplace(std::move(element)); }
+
+    /*
+     * Constructs an element from args in place at the back of this Queue.
+     * If the queue is full, blocks the calling thread until there is space in the queue.
+     */
+    template <typename... Args>
+    void emplace(Args&&... args) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this] { return !queue_.isFull(); });
+        queue_.emplace(std::forward<Args>(args)...);
+        lock.unlock();
+        not_empty_.notify_one();
+    }
+
+    /*
+     * Moves element to the back of this Queue without blocking.
+     * Returns true on success and false if the queue is full, leaving element untouched.
+     */
+    bool tryEnq(T&& element) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!queue_.enq(std::move(element)))
+            return false;
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    /*
+     * Dequeues the element at the front of this Queue.
+     * If the queue is empty, blocks the calling thread until an element can be dequeued.
+     * Returns the dequeued element.
+     */
+    T deq() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return !queue_.isEmpty(); });
+        T element(std::move(*queue_.peek()));
+        queue_.pop();
+        lock.unlock();
+        not_full_.notify_one();
+        return element;
+    }
+
+    /*
+     * Moves the element at the front of this Queue into out without blocking.
+     * Returns true on success and false if the queue is empty, leaving out untouched.
+     */
+    bool tryDeq(T& out) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!queue_.deq(out))
+            return false;
+        lock.unlock();
+        not_full_.notify_one();
+        return true;
+    }
+
+    /*
+     * Returns the number of elements currently in this Queue.
+     */
+    std::size_t size() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.size();
+    }
+
+    /*
+     * Returns true if this Queue is empty, false otherwise.
+     */
+    bool isEmpty() { return size() == 0; }
+
+    /*
+     * Clears this Queue returning it to an empty state, destroying every element.
+     */
+    void clear() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.clear();
+        }
+        not_full_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable not_full_, not_empty_;
+    Queue<T, Capacity> queue_;
+};
+
+} // namespace cqueue
+
+#endif /* BLOCKING_QUEUE_HPP_ */
@@ -0,0 +1,289 @@
+/*
+ * DelayQueue.c
+ *
+ * Fixed-size blocking delay queue implementation over a hierarchical timer wheel.
+ *
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "DelayQueue.h"
+
+#define NO_EVENT UINT64_MAX
+
+
+DelayQueue *new_DelayQueue(int max_size, long tick_ns) {
+    if (max_size <= 0 || tick_ns <= 0) return NULL;
+
+    DelayQueue *dQueue = malloc(sizeof(DelayQueue));
+    if (dQueue == NULL) return NULL;
+
+    // every node the queue will ever need, so enq never allocates
+    dQueue->nodes = malloc(max_size * sizeof(DelayNode));
+    if (dQueue->nodes == NULL) {
+        free(dQueue);
+        return NULL;
+    }
+    for (int i = 0; i < max_size; i++) {
+        dQueue->nodes[i].element = NULL;
+        dQueue->nodes[i].next = i + 1 < max_size ? &dQueue->nodes[i + 1] : NULL;
+    }
+    dQueue->free_nodes = dQueue->nodes;
+    dQueue->max_size = max_size;
+    dQueue->size = 0;
+
+    dQueue->tick_ns = tick_ns;
+    dQueue->now_tick = DelayQueue_nowNs() / tick_ns;
+    for (int l = 0; l < DELAY_WHEEL_LEVELS; l++) {
+        for (int s = 0; s < DELAY_WHEEL_SLOTS; s++)
+            dQueue->wheel[l][s].head = dQueue->wheel[l][s].tail = NULL;
+        dQueue->occupied[l] = 0;
+    }
+    dQueue->overflow.head = dQueue->overflow.tail = NULL;
+    dQueue->ready.head = dQueue->ready.tail = NULL;
+
+    // timed waits measure against the same clock as the deadlines
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&dQueue->not_empty, &attr);
+    pthread_cond_init(&dQueue->not_full, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&dQueue->mutex, NULL);
+    dQueue->sleeping = 0;
+    return dQueue;
+}
+
+long DelayQueue_nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static void listAppend(DelayList* list, DelayNode* node) {
+    node->next = NULL;
+    if (list->tail == NULL)
+        list->head = node;
+    else
+        list->tail->next = node;
+    list->tail = node;
+}
+
+/*
+ * Inserts node into list, kept in tick order, after any nodes with the same tick.
+ * Nodes coming due arrive in tick order, so only an element enqueued with a deadline already
+ * passed has to walk the list.
+ */
+static void listInsertByTick(DelayList* list, DelayNode* node) {
+    if (list->tail == NULL || list->tail->tick <= node->tick) {
+        listAppend(list, node);
+        return;
+    }
+
+    DelayNode **link = &list->head;
+    while ((*link)->tick <= node->tick)
+        link = &(*link)->next;
+    node->next = *link;
+    *link = node;
+}
+
+/*
+ * Empties list, returning its nodes as a chain.
+ */
+static DelayNode* listTake(DelayList* list) {
+    DelayNode *head = list->head;
+    list->head = list->tail = NULL;
+    return head;
+}
+
+/*
+ * Files node by its deadline relative to now_tick: into the ready list when it has passed,
+ * otherwise at the level of the highest digit in which the deadline differs from now_tick,
+ * in the slot that digit names. That digit is always ahead of now_tick's, so a slot only ever
+ * holds deadlines in the level's current rotation.
+ */
+static void insertNode(DelayQueue* this, DelayNode* node) {
+    if (node->tick <= this->now_tick) {
+        listInsertByTick(&this->ready, node);
+        return;
+    }
+
+    int level = (63 - __builtin_clzll(node->tick ^ this->now_tick)) / DELAY_WHEEL_BITS;
+    if (level >= DELAY_WHEEL_LEVELS) {
+        listAppend(&this->overflow, node);
+        return;
+    }
+    int slot = (node->tick >> (level * DELAY_WHEEL_BITS)) & (DELAY_WHEEL_SLOTS - 1);
+    listAppend(&this->wheel[level][slot], node);
+    this->occupied[level] |= 1ULL << slot;
+}
+
+/*
+ * Re-files every node of list against the current now_tick.
+ */
+static void reinsertAll(DelayQueue* this, DelayList* list) {
+    DelayNode *node = listTake(list);
+
+    while (node != NULL) {
+        DelayNode *next = node->next;
+        insertNode(this, node);
+        node = next;
+    }
+}
+
+/*
+ * Returns the first tick after now_tick at which a slot comes due, or NO_EVENT when nothing
+ * is pending. Occupied slots are all ahead of now_tick's digit, and those at a lower level
+ * all come before any at a higher one, so it is the first occupied slot of the lowest level.
+ */
+static uint64_t nextEvent(DelayQueue* this) {
+    for (int level = 0; level < DELAY_WHEEL_LEVELS; level++) {
+        if (this->occupied[level] == 0)
+            continue;
+        int shift = level * DELAY_WHEEL_BITS;
+        uint64_t rotation = this->now_tick >> (shift + DELAY_WHEEL_BITS) << (shift + DELAY_WHEEL_BITS);
+        return rotation + ((uint64_t)__builtin_ctzll(this->occupied[level]) << shift);
+    }
+    if (this->overflow.head != NULL) {
+        int shift = DELAY_WHEEL_LEVELS * DELAY_WHEEL_BITS;
+        return ((this->now_tick >> shift) + 1) << shift;
+    }
+    return NO_EVENT;
+}
+
+/*
+ * Moves the wheel on to target, cascading and expiring each slot that comes due on the way
+ * and jumping straight over empty ones.
+ */
+static void advance(DelayQueue* this, uint64_t target) {
+    uint64_t event;
+
+    while ((event = nextEvent(this)) <= target) {
+        this->now_tick = event;
+
+        // cascade from the top, so nodes re-filed from a higher level land in lower slots still to come
+        if ((event & ((1ULL << (DELAY_WHEEL_LEVELS * DELAY_WHEEL_BITS)) - 1)) == 0)
+            reinsertAll(this, &this->overflow);
+        for (int level = DELAY_WHEEL_LEVELS - 1; level >= 0; level--) {
+            int shift = level * DELAY_WHEEL_BITS;
+            if ((event & ((1ULL << shift) - 1)) != 0)
+                continue;
+            int slot = (event >> shift) & (DELAY_WHEEL_SLOTS - 1);
+            if (this->occupied[level] & (1ULL << slot)) {
+                this->occupied[level] &= ~(1ULL << slot);
+                reinsertAll(this, &this->wheel[level][slot]); // level 0 nodes all go to ready
+            }
+        }
+    }
+    if (target > this->now_tick)
+        this->now_tick = target;
+}
+
+static uint64_t currentTick(DelayQueue* this) {
+    return DelayQueue_nowNs() / this->tick_ns;
+}
+
+bool DelayQueue_enq(DelayQueue* this, void* element, long ready_at_ns) {
+    if (element == NULL)
+        return false;
+
+    pthread_mutex_lock(&this->mutex);
+    while (this->free_nodes == NULL)
+        pthread_cond_wait(&this->not_full, &this->mutex); // Wait for a deq
+
+    DelayNode *node = this->free_nodes;
+    this->free_nodes = node->next;
+    node->element = element;
+    node->tick = ready_at_ns <= 0 ? 0 : ((uint64_t)ready_at_ns + this->tick_ns - 1) / this->tick_ns;
+
+    // sleeping consumers are timed to the next event, so they only need waking to move it earlier
+    uint64_t wake = this->ready.head != NULL ? this->now_tick : nextEvent(this);
+    insertNode(this, node);
+    this->size++;
+    if (this->sleeping > 0) {
+        if (node->tick <= this->now_tick)
+            pthread_cond_signal(&this->not_empty);
+        else if (node->tick < wake)
+            pthread_cond_broadcast(&this->not_empty);
+    }
+    pthread_mutex_unlock(&this->mutex);
+    return true;
+}
+
+bool DelayQueue_enqAfter(DelayQueue* this, void* element, long delay_ns) {
+    return DelayQueue_enq(this, element, DelayQueue_nowNs() + delay_ns);
+}
+
+/*
+ * Takes the first ready element, if any, with the mutex held.
+ * Returns the element, or NULL if none is ready.
+ */
+static void* takeReady(DelayQueue* this) {
+    advance(this, currentTick(this));
+
+    DelayNode *node = this->ready.head;
+    if (node == NULL)
+        return NULL;
+    this->ready.head = node->next;
+    if (this->ready.head == NULL)
+        this->ready.tail = NULL;
+
+    void *element = node->element;
+    node->element = NULL;
+    node->next = this->free_nodes;
+    this->free_nodes = node;
+    this->size--;
+
+    pthread_cond_signal(&this->not_full);
+    if (this->ready.head != NULL && this->sleeping > 0)
+        pthread_cond_signal(&this->not_empty); // pass the rest on to another consumer
+    return element;
+}
+
+void* DelayQueue_deq(DelayQueue* this) {
+    void *element;
+
+    pthread_mutex_lock(&this->mutex);
+    while ((element = takeReady(this)) == NULL) {
+        uint64_t event = nextEvent(this);
+
+        // Wait for the next slot to come due, or an enq to bring it forward
+        this->sleeping++;
+        if (event == NO_EVENT) {
+            pthread_cond_wait(&this->not_empty, &this->mutex);
+        } else {
+            long wake_ns = (long)(event * this->tick_ns);
+            struct timespec deadline = { wake_ns / 1000000000L, wake_ns % 1000000000L };
+            pthread_cond_timedwait(&this->not_empty, &this->mutex, &deadline);
+        }
+        this->sleeping--;
+    }
+    pthread_mutex_unlock(&this->mutex);
+    return element;
+}
+
+void* DelayQueue_tryDeq(DelayQueue* this) {
+    pthread_mutex_lock(&this->mutex);
+    void *element = takeReady(this);
+    pthread_mutex_unlock(&this->mutex);
+    return element;
+}
+
+int DelayQueue_size(DelayQueue* this) {
+    pthread_mutex_lock(&this->mutex);
+    int size = this->size;
+    pthread_mutex_unlock(&this->mutex);
+    return size;
+}
+
+void DelayQueue_destroy(DelayQueue* this) {
+    if(this) {
+        pthread_mutex_destroy(&this->mutex);
+        pthread_cond_destroy(&this->not_full);
+        pthread_cond_destroy(&this->not_empty);
+        free(this->nodes);
+        free(this);
+    }
+}
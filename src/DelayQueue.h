@@ -0,0 +1,112 @@
+/*
+ * DelayQueue.h
+ *
+ * Module interface for a fixed-size blocking queue whose elements only become dequeueable
+ * once the time they were enqueued with has passed, for retries and timeouts.
+ *
+ * Pending elements are kept in a hierarchical timer wheel: DELAY_WHEEL_LEVELS levels of
+ * DELAY_WHEEL_SLOTS slots each, where a slot at level l covers DELAY_WHEEL_SLOTS^l ticks.
+ * Enqueueing picks a level and slot from the deadline with a few bit operations, so it costs
+ * the same however many elements are pending. As time passes, a slot coming due at a higher
+ * level is cascaded into the lower levels, and a level 0 slot coming due moves its elements to
+ * a ready list which deq serves in deadline order, ties in the order they were enqueued. A consumer with nothing ready
+ * sleeps until the wheel's next slot comes due, skipping empty slots, and an enq with an
+ * earlier deadline wakes it to sleep for less. Deadlines are rounded up to whole ticks, so an
+ * element is never returned early and at most one tick late.
+ *
+ */
+
+#ifndef DELAY_QUEUE_H_
+#define DELAY_QUEUE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#define DELAY_WHEEL_BITS 6
+#define DELAY_WHEEL_SLOTS (1 << DELAY_WHEEL_BITS)
+#define DELAY_WHEEL_LEVELS 6
+#define DELAY_QUEUE_DEFAULT_TICK_NS 1000000L
+
+typedef struct DelayNode DelayNode;
+typedef struct DelayList DelayList;
+typedef struct DelayQueue DelayQueue;
+
+/*
+ * One element waiting in the wheel, or a free node when element is NULL
+ */
+struct DelayNode {
+    void* element;
+    uint64_t tick; // deadline in ticks, rounded up
+    DelayNode* next;
+};
+
+struct DelayList {
+    DelayNode *head, *tail;
+};
+
+struct DelayQueue {
+    DelayNode* nodes; // max_size of them, allocated with the queue
+    DelayNode* free_nodes;
+    int max_size, size;
+
+    long tick_ns;
+    uint64_t now_tick; // how far the wheel has been advanced
+    DelayList wheel[DELAY_WHEEL_LEVELS][DELAY_WHEEL_SLOTS];
+    uint64_t occupied[DELAY_WHEEL_LEVELS]; // a bit per non-empty slot
+    DelayList overflow; // deadlines beyond the top level, re-sorted each time it wraps
+    DelayList ready; // deadline passed, in the order they came due
+
+    pthread_mutex_t mutex;
+    pthread_cond_t not_full, not_empty; // not_empty waits are timed on CLOCK_MONOTONIC
+    int sleeping; // consumers waiting on not_empty
+};
+
+/*
+ * Creates a new DelayQueue for at most max_size pending void* elements, with deadlines
+ * rounded up to tick_ns nanoseconds, such as DELAY_QUEUE_DEFAULT_TICK_NS.
+ * Returns a pointer to a new DelayQueue on success and NULL on failure.
+ */
+DelayQueue* new_DelayQueue(int max_size, long tick_ns);
+
+/*
+ * Returns the current CLOCK_MONOTONIC time in nanoseconds, the clock deadlines are measured on.
+ */
+long DelayQueue_nowNs();
+
+/*
+ * Enqueues the given void* element into this queue, to be dequeued once DelayQueue_nowNs()
+ * reaches ready_at_ns. If the queue is full, blocks the calling thread until an element is dequeued.
+ * Returns false when element is NULL and true on success.
+ */
+bool DelayQueue_enq(DelayQueue* this, void* element, long ready_at_ns);
+
+/*
+ * Enqueues element like DelayQueue_enq, to be dequeued delay_ns nanoseconds from now.
+ */
+bool DelayQueue_enqAfter(DelayQueue* this, void* element, long delay_ns);
+
+/*
+ * Dequeues the element with the earliest passed deadline from this queue.
+ * If no deadline has passed, blocks the calling thread until the earliest one does.
+ * Returns the element.
+ */
+void* DelayQueue_deq(DelayQueue* this);
+
+/*
+ * Dequeues like DelayQueue_deq without blocking.
+ * Returns the element, or NULL if no deadline has passed.
+ */
+void* DelayQueue_tryDeq(DelayQueue* this);
+
+/*
+ * Returns the number of elements in this queue, whether their deadline has passed or not.
+ */
+int DelayQueue_size(DelayQueue* this);
+
+/*
+ * Destroys this queue by freeing the memory used by it. Elements still in it are not freed.
+ */
+void DelayQueue_destroy(DelayQueue* this);
+
+#endif /* DELAY_QUEUE_H_ */
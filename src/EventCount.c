@@ -0,0 +1,104 @@
+/*
+ * EventCount.c
+ *
+ * Linux futex-based eventcount implementation.
+ *
+ */
+
+#include <stddef.h>
+#include <limits.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include "EventCount.h"
+
+/*
+ * Tells the CPU we are in a spin-wait loop so it can yield resources to a sibling hyperthread.
+ */
+static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#else
+    atomic_signal_fence(memory_order_seq_cst);
+#endif
+}
+
+// Private futexes skip the shared-mapping lookup but only match waiters in the same process
+static void futexWait(EventCount* this, unsigned int expected) {
+    syscall(SYS_futex, &this->epoch, this->shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+static void futexWake(EventCount* this, int count) {
+    syscall(SYS_futex, &this->epoch, this->shared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+void EventCount_init(EventCount* this, int spin) {
+    atomic_init(&this->epoch, 0);
+    atomic_init(&this->waiters, 0);
+    this->spin = spin;
+    this->shared = false;
+}
+
+void EventCount_initShared(EventCount* this, int spin) {
+    EventCount_init(this, spin);
+    this->shared = true;
+}
+
+void EventCount_await(EventCount* this, bool (*ready)(void*), void* arg) {
+    for (int i = 0; i < this->spin; i++) {
+        if (ready(arg))
+            return;
+        cpuRelax();
+    }
+
+    for (;;) {
+        // register before sampling the epoch and re-checking, pairing with the fence in notify
+        atomic_fetch_add(&this->waiters, 1);
+        unsigned int key = atomic_load(&this->epoch);
+        if (ready(arg)) {
+            atomic_fetch_sub(&this->waiters, 1);
+            return;
+        }
+        futexWait(this, key); // returns at once if a notify bumped the epoch since key
+        atomic_fetch_sub(&this->waiters, 1);
+        if (ready(arg))
+            return;
+    }
+}
+
+void EventCount_notify(EventCount* this, int count) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&this->waiters, memory_order_relaxed) == 0)
+        return;
+
+    atomic_fetch_add(&this->epoch, 1);
+    futexWake(this, count > 0 ? count : INT_MAX);
+}
+
+static bool counterPositive(void* counter) {
+    return atomic_load((atomic_int *)counter) > 0;
+}
+
+int EventCount_claim(EventCount* this, atomic_int* counter, int want, bool block) {
+    int value = atomic_load_explicit(counter, memory_order_relaxed);
+
+    for (;;) {
+        if (value > 0) {
+            int claimed = value < want ? value : want;
+            if (atomic_compare_exchange_weak(counter, &value, value - claimed))
+                return claimed;
+            continue;
+        }
+        if (!block)
+            return 0;
+        EventCount_await(this, counterPositive, counter);
+        value = atomic_load(counter);
+    }
+}
+
+void EventCount_release(EventCount* this, atomic_int* counter, int count) {
+    atomic_fetch_add(counter, count);
+    EventCount_notify(this, count);
+}
@@ -0,0 +1,66 @@
+/*
+ * EventCount.h
+ *
+ * Module interface for a futex-based eventcount used to park threads until a condition holds.
+ *
+ * A waiter first spins on its condition, then registers itself, re-checks the condition and
+ * sleeps on the epoch futex word. Notifiers bump the epoch and issue a futex wake only when a
+ * waiter is registered, so the uncontended path is a fence and a load with no syscall.
+ *
+ * EventCount_claim and EventCount_release pair an eventcount with an atomic counter to make
+ * the counting semaphore the blocking queues use for their free slots and elements.
+ *
+ */
+
+#ifndef EVENT_COUNT_H_
+#define EVENT_COUNT_H_
+
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#define EVENT_COUNT_DEFAULT_SPIN 100
+
+typedef struct EventCount EventCount;
+
+struct EventCount {
+    atomic_uint epoch; // futex word, bumped by every notify that finds a waiter
+    atomic_int waiters;
+    int spin; // condition checks with a pause in between before parking
+    bool shared; // may be waited on from several processes
+};
+
+/*
+ * Initialises this EventCount with no waiters, spinning spin times before a waiter parks.
+ */
+void EventCount_init(EventCount* this, int spin);
+
+/*
+ * Initialises this EventCount like EventCount_init, for use in memory shared between processes.
+ */
+void EventCount_initShared(EventCount* this, int spin);
+
+/*
+ * Blocks the calling thread until ready(arg) returns true.
+ * ready is called repeatedly and must only read shared state.
+ */
+void EventCount_await(EventCount* this, bool (*ready)(void*), void* arg);
+
+/*
+ * Wakes up to count threads parked in EventCount_await, or all of them when count is 0.
+ * Must be called after the state that ready() checks has been updated.
+ */
+void EventCount_notify(EventCount* this, int count);
+
+/*
+ * Claims up to want units of counter. When block is true, waits on this EventCount for the
+ * first unit; the rest are only taken if immediately available.
+ * Returns the number of units claimed, which is 0 only when block is false.
+ */
+int EventCount_claim(EventCount* this, atomic_int* counter, int want, bool block);
+
+/*
+ * Returns count units to counter and wakes as many threads waiting on this EventCount to claim them.
+ */
+void EventCount_release(EventCount* this, atomic_int* counter, int count);
+
+#endif /* EVENT_COUNT_H_ */
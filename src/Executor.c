@@ -0,0 +1,360 @@
+/*
+ * Executor.c
+ *
+ * Thread pool implementation over a shared BlockingQueue and per-worker WorkStealingDeques.
+ *
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "Executor.h"
+
+#define EXECUTOR_SHARED_SEGMENT 256 // elements per segment of the shared queue
+#define EXECUTOR_LOCAL_SIZE 64 // initial capacity of each worker's deque
+
+/*
+ * Enqueued once per worker on shutdown, once no task is left to run
+ */
+static ExecutorFuture shutdown_task;
+
+/*
+ * Enqueued to wake a parked worker for a task pushed onto another worker's deque
+ */
+static ExecutorFuture wake_task;
+
+/*
+ * The worker the calling thread runs as, if any
+ */
+static _Thread_local ExecutorWorker* current_worker = NULL;
+
+static void maybeGrow(Executor* this);
+
+
+static void releaseTask(ExecutorFuture* task) {
+    if (atomic_fetch_sub(&task->refs, 1) == 1)
+        free(task);
+}
+
+static void runTask(Executor* executor, ExecutorFuture* task) {
+    task->result = task->func(task->arg);
+    atomic_store(&task->done, true);
+    EventCount_notify(&task->completed, 0);
+    releaseTask(task);
+
+    if (atomic_fetch_sub(&executor->pending, 1) == 1)
+        EventCount_notify(&executor->drained, 0);
+}
+
+/*
+ * Finds a task without blocking: the worker's own deque first, then the shared queue,
+ * then the other workers' deques.
+ * Returns NULL if there is no work anywhere.
+ */
+static ExecutorFuture* findTask(ExecutorWorker* worker) {
+    Executor *executor = worker->executor;
+    void *task = WorkStealingDeque_pop(worker->local);
+
+    if (task == NULL && BlockingQueue_deqBatch(executor->shared, &task, 0, 1) == 0)
+        task = NULL;
+
+    for (int i = 0; task == NULL && i < executor->max_workers; i++) {
+        ExecutorWorker *victim = &executor->workers[i];
+        if (victim != worker && atomic_load(&victim->active))
+            task = WorkStealingDeque_steal(victim->local);
+    }
+    return task;
+}
+
+/*
+ * Retires this worker if it is surplus to an elastic executor's minimum.
+ * Returns true if the worker should exit.
+ */
+static bool retire(ExecutorWorker* worker) {
+    Executor *executor = worker->executor;
+    int count = atomic_load(&executor->worker_count);
+
+    while (count > executor->min_workers) {
+        if (atomic_compare_exchange_weak(&executor->worker_count, &count, count - 1)) {
+            atomic_store(&worker->active, false);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void* workerMain(void* arg) {
+    ExecutorWorker *worker = arg;
+    Executor *executor = worker->executor;
+    ExecutorFuture *task;
+
+    current_worker = worker;
+    for (;;) {
+        task = findTask(worker);
+        if (task == NULL) {
+            if (retire(worker))
+                break;
+            // look again once counted idle, pairing with the fence in enqueueTask, so a
+            // task pushed locally either is found here or makes the submitter wake us
+            atomic_fetch_add(&executor->idle_count, 1);
+            atomic_thread_fence(memory_order_seq_cst);
+            task = findTask(worker);
+            if (task == NULL)
+                task = BlockingQueue_deq(executor->shared);
+            atomic_fetch_sub(&executor->idle_count, 1);
+        }
+
+        if (task == &shutdown_task)
+            break;
+        if (task == &wake_task)
+            continue;
+
+        // a burst submitted while this worker still counted as idle started nobody else
+        if (!BlockingQueue_isEmpty(executor->shared))
+            maybeGrow(executor);
+        runTask(executor, task);
+    }
+    current_worker = NULL;
+
+    pthread_mutex_lock(&executor->mutex);
+    if (--executor->live_threads == 0)
+        pthread_cond_broadcast(&executor->all_exited);
+    pthread_mutex_unlock(&executor->mutex);
+    return NULL;
+}
+
+/*
+ * Starts a worker thread in a free slot. Called with the mutex held.
+ * Returns true on success.
+ */
+static bool startWorker(Executor* this) {
+    pthread_t thread;
+    pthread_attr_t attr;
+
+    for (int i = 0; i < this->max_workers; i++) {
+        ExecutorWorker *worker = &this->workers[i];
+        if (atomic_load(&worker->active))
+            continue;
+
+        atomic_store(&worker->active, true);
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        bool started = pthread_create(&thread, &attr, workerMain, worker) == 0;
+        pthread_attr_destroy(&attr);
+
+        if (!started) {
+            atomic_store(&worker->active, false);
+            return false;
+        }
+        this->live_threads++;
+        return true;
+    }
+    return false;
+}
+
+Executor *new_ElasticExecutor(int min_workers, int max_workers) {
+    if (min_workers <= 0 || max_workers < min_workers) return NULL;
+
+    Executor *E = malloc(sizeof(Executor));
+    if (E == NULL) return NULL;
+
+    E->shared = new_UnboundedBlockingQueue(EXECUTOR_SHARED_SEGMENT);
+    E->workers = calloc(max_workers, sizeof(ExecutorWorker));
+    if (E->shared == NULL || E->workers == NULL) {
+        BlockingQueue_destroy(E->shared);
+        free(E->workers);
+        free(E);
+        return NULL;
+    }
+
+    E->min_workers = min_workers;
+    E->max_workers = max_workers;
+    atomic_init(&E->worker_count, 0);
+    atomic_init(&E->idle_count, 0);
+    atomic_init(&E->pending, 0);
+    atomic_init(&E->shutting_down, false);
+    EventCount_init(&E->drained, EVENT_COUNT_DEFAULT_SPIN);
+    pthread_mutex_init(&E->mutex, NULL);
+    pthread_cond_init(&E->all_exited, NULL);
+    E->live_threads = 0;
+
+    // every slot gets its deque up front so thieves never see one being created
+    for (int i = 0; i < max_workers; i++) {
+        E->workers[i].executor = E;
+        atomic_init(&E->workers[i].active, false);
+        E->workers[i].local = new_WorkStealingDeque(EXECUTOR_LOCAL_SIZE);
+        if (E->workers[i].local == NULL) {
+            Executor_destroy(E);
+            return NULL;
+        }
+    }
+
+    pthread_mutex_lock(&E->mutex);
+    for (int i = 0; i < min_workers; i++) {
+        if (!startWorker(E)) {
+            pthread_mutex_unlock(&E->mutex);
+            Executor_destroy(E);
+            return NULL;
+        }
+        atomic_fetch_add(&E->worker_count, 1);
+    }
+    pthread_mutex_unlock(&E->mutex);
+    return E;
+}
+
+Executor *new_Executor(int worker_count) {
+    return new_ElasticExecutor(worker_count, worker_count);
+}
+
+/*
+ * Starts another worker if every worker is busy and the executor may still grow.
+ */
+static void maybeGrow(Executor* this) {
+    if (this->min_workers == this->max_workers || atomic_load(&this->idle_count) > 0)
+        return;
+
+    pthread_mutex_lock(&this->mutex);
+    int count = atomic_load(&this->worker_count);
+    if (count < this->max_workers && !atomic_load(&this->shutting_down)) {
+        // count the worker first so a retiring worker can't take us below the minimum
+        atomic_fetch_add(&this->worker_count, 1);
+        if (!startWorker(this))
+            atomic_fetch_sub(&this->worker_count, 1);
+    }
+    pthread_mutex_unlock(&this->mutex);
+}
+
+static bool enqueueTask(Executor* this, ExecutorFuture* task) {
+    ExecutorWorker *worker = current_worker;
+    bool queued;
+
+    // counted before checking for shutdown, so shutdown either sees this task or rejects it;
+    // a task submitted by a task is always accepted, as its parent is still pending
+    atomic_fetch_add(&this->pending, 1);
+    bool internal = worker != NULL && worker->executor == this;
+    if (!internal && atomic_load(&this->shutting_down)) {
+        queued = false;
+    } else if (internal && atomic_load(&this->idle_count) == 0) {
+        // keep work submitted by a task local unless someone is idle and could take it now,
+        // waking a worker that went idle after the check so it can steal the task
+        queued = WorkStealingDeque_push(worker->local, task);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (queued && atomic_load(&this->idle_count) > 0)
+            BlockingQueue_enq(this->shared, &wake_task);
+    } else {
+        queued = BlockingQueue_enq(this->shared, task);
+        if (queued)
+            maybeGrow(this);
+    }
+
+    if (!queued && atomic_fetch_sub(&this->pending, 1) == 1)
+        EventCount_notify(&this->drained, 0);
+    return queued;
+}
+
+static ExecutorFuture* newTask(void* (*func)(void*), void* arg, bool detached) {
+    ExecutorFuture *task = malloc(sizeof(ExecutorFuture));
+    if (task == NULL) return NULL;
+
+    task->func = func;
+    task->arg = arg;
+    task->result = NULL;
+    atomic_init(&task->refs, detached ? 1 : 2);
+    atomic_init(&task->done, false);
+    EventCount_init(&task->completed, EVENT_COUNT_DEFAULT_SPIN);
+    return task;
+}
+
+ExecutorFuture *Executor_submit(Executor* this, void* (*func)(void*), void* arg) {
+    ExecutorFuture *task = newTask(func, arg, false);
+    if (task == NULL) return NULL;
+
+    if (!enqueueTask(this, task)) {
+        free(task);
+        return NULL;
+    }
+    return task;
+}
+
+bool Executor_execute(Executor* this, void* (*func)(void*), void* arg) {
+    ExecutorFuture *task = newTask(func, arg, true);
+    if (task == NULL) return false;
+
+    if (!enqueueTask(this, task)) {
+        free(task);
+        return false;
+    }
+    return true;
+}
+
+int Executor_workerCount(Executor* this) {
+    return atomic_load(&this->worker_count);
+}
+
+static bool drained(void* this) {
+    return atomic_load(&((Executor *)this)->pending) == 0;
+}
+
+void Executor_shutdown(Executor* this) {
+    pthread_mutex_lock(&this->mutex);
+    if (atomic_exchange(&this->shutting_down, true)) {
+        // another caller is draining the pool; wait for it to finish, as Executor_destroy relies on
+        while (this->live_threads > 0)
+            pthread_cond_wait(&this->all_exited, &this->mutex);
+        pthread_mutex_unlock(&this->mutex);
+        return;
+    }
+    pthread_mutex_unlock(&this->mutex);
+
+    // once nothing is pending no task is running, so nothing can be queued behind the sentinels
+    EventCount_await(&this->drained, drained, this);
+
+    pthread_mutex_lock(&this->mutex);
+    // one sentinel per live thread; spares left behind by a retiring worker are harmless
+    for (int i = 0; i < this->live_threads; i++)
+        BlockingQueue_enq(this->shared, &shutdown_task);
+    while (this->live_threads > 0)
+        pthread_cond_wait(&this->all_exited, &this->mutex);
+    pthread_mutex_unlock(&this->mutex);
+}
+
+void Executor_destroy(Executor* this) {
+    if(this) {
+        Executor_shutdown(this);
+        for (int i = 0; i < this->max_workers; i++)
+            WorkStealingDeque_destroy(this->workers[i].local);
+        pthread_cond_destroy(&this->all_exited);
+        pthread_mutex_destroy(&this->mutex);
+        free(this->workers);
+        BlockingQueue_destroy(this->shared);
+        free(this);
+    }
+}
+
+static bool futureDone(void* this) {
+    return atomic_load(&((ExecutorFuture *)this)->done);
+}
+
+void* ExecutorFuture_get(ExecutorFuture* this) {
+    ExecutorWorker *worker = current_worker;
+
+    // a worker waiting on a task runs other tasks meanwhile, as the one it waits for may
+    // be sitting in its own deque with no other worker free to take it
+    while (worker != NULL && !futureDone(this)) {
+        ExecutorFuture *task = findTask(worker);
+        if (task == NULL)
+            break;
+        if (task != &wake_task)
+            runTask(worker->executor, task);
+    }
+    EventCount_await(&this->completed, futureDone, this);
+    return this->result;
+}
+
+bool ExecutorFuture_isDone(ExecutorFuture* this) {
+    return futureDone(this);
+}
+
+void ExecutorFuture_destroy(ExecutorFuture* this) {
+    releaseTask(this);
+}
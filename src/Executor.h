@@ -0,0 +1,120 @@
+/*
+ * Executor.h
+ *
+ * Module interface for a thread pool which runs submitted function calls on worker threads.
+ *
+ * Tasks submitted from outside the pool go to a shared unbounded BlockingQueue. Tasks
+ * submitted by a running task go to its worker's own WorkStealingDeque, where the worker
+ * pops them without locking and idle workers can steal them. An elastic executor starts
+ * extra workers while every worker is busy and retires them once they run out of work.
+ *
+ */
+
+#ifndef EXECUTOR_H_
+#define EXECUTOR_H_
+
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "BlockingQueue.h"
+#include "WorkStealingDeque.h"
+#include "EventCount.h"
+
+typedef struct Executor Executor;
+typedef struct ExecutorWorker ExecutorWorker;
+typedef struct ExecutorFuture ExecutorFuture;
+
+/*
+ * A submitted call, which doubles as the handle used to wait for its result
+ */
+struct ExecutorFuture {
+    void* (*func)(void*);
+    void* arg;
+    void* result;
+    atomic_int refs; // the worker's and the submitter's; whoever drops the last one frees it
+    atomic_bool done;
+    EventCount completed;
+};
+
+struct ExecutorWorker {
+    Executor* executor;
+    WorkStealingDeque* local;
+    atomic_bool active;
+};
+
+struct Executor {
+    BlockingQueue* shared;
+    ExecutorWorker* workers; // max_workers slots, active or not
+    int min_workers, max_workers;
+    atomic_int worker_count, idle_count;
+    atomic_int pending; // tasks accepted but not yet finished
+    atomic_bool shutting_down;
+    EventCount drained; // notified when pending reaches 0
+
+    pthread_mutex_t mutex; // guards starting and retiring workers
+    pthread_cond_t all_exited;
+    int live_threads;
+};
+
+/*
+ * Creates a new Executor with a fixed set of worker_count worker threads.
+ * Returns a pointer to a new Executor on success and NULL on failure.
+ */
+Executor* new_Executor(int worker_count);
+
+/*
+ * Creates a new Executor which keeps min_workers worker threads and starts more, up to
+ * max_workers, while all of them are busy. Extra workers exit once they find no work.
+ * Returns a pointer to a new Executor on success and NULL on failure.
+ */
+Executor* new_ElasticExecutor(int min_workers, int max_workers);
+
+/*
+ * Submits func(arg) to run on a worker thread.
+ * Returns a future to wait on with ExecutorFuture_get, or NULL if this Executor is
+ * shutting down or out of memory. The future must be released with ExecutorFuture_destroy.
+ */
+ExecutorFuture* Executor_submit(Executor* this, void* (*func)(void*), void* arg);
+
+/*
+ * Submits func(arg) to run on a worker thread without a future; its result is discarded.
+ * Returns true on success and false if this Executor is shutting down or out of memory.
+ */
+bool Executor_execute(Executor* this, void* (*func)(void*), void* arg);
+
+/*
+ * Returns the number of worker threads currently running.
+ */
+int Executor_workerCount(Executor* this);
+
+/*
+ * Stops accepting tasks from outside the pool, waits for every queued task (and any
+ * tasks those submit) to finish, then stops the worker threads.
+ * May be called by several threads at once; each call returns once the workers have stopped.
+ * Must not be called from a worker thread.
+ */
+void Executor_shutdown(Executor* this);
+
+/*
+ * Shuts down this Executor if needed and frees the memory used by it.
+ */
+void Executor_destroy(Executor* this);
+
+/*
+ * Blocks until the task behind this future has run, then returns the value its function returned.
+ * Called from a task, runs other pending tasks on the calling worker while it waits.
+ */
+void* ExecutorFuture_get(ExecutorFuture* this);
+
+/*
+ * Returns true if the task behind this future has run, false otherwise.
+ */
+bool ExecutorFuture_isDone(ExecutorFuture* this);
+
+/*
+ * Releases this future. The task still runs if it has not yet; the future is freed once it has.
+ */
+void ExecutorFuture_destroy(ExecutorFuture* this);
+
+#endif /* EXECUTOR_H_ */
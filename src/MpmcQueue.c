@@ -0,0 +1,124 @@
+/*
+ * MpmcQueue.c
+ *
+ * Fixed-size generic array-based lock-free multi-producer/multi-consumer Queue implementation.
+ *
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "MpmcQueue.h"
+
+
+MpmcQueue *new_MpmcQueue(int max_size) {
+    if (max_size <= 0) return NULL;
+
+    // aligned_alloc needs a size that is a multiple of the alignment
+    size_t bytes = (sizeof(MpmcQueue) + MPMC_CACHE_LINE - 1) / MPMC_CACHE_LINE * MPMC_CACHE_LINE;
+    MpmcQueue *Q = aligned_alloc(MPMC_CACHE_LINE, bytes);
+    if (Q == NULL) return NULL;
+
+    // sequence numbers tell full from empty, so no extra slot is needed
+    Q->max_size = (size_t)max_size;
+    Q->slots = malloc(Q->max_size * sizeof(MpmcSlot));
+    if (Q->slots == NULL) {
+        free(Q);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < Q->max_size; i++) {
+        atomic_init(&Q->slots[i].sequence, i); // slot i is free for enq ticket i
+        Q->slots[i].element = NULL;
+    }
+    atomic_init(&Q->head, 0);
+    atomic_init(&Q->tail, 0);
+    return Q;
+}
+
+bool MpmcQueue_tryEnq(MpmcQueue* this, void* element) {
+    MpmcSlot *slot;
+    size_t pos;
+
+    if (element == NULL)
+        return false;
+
+    pos = atomic_load_explicit(&this->head, memory_order_relaxed);
+    for (;;) {
+        slot = &this->slots[pos % this->max_size];
+        size_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            // slot is free for this ticket; try to claim it (pos is reloaded on failure)
+            if (atomic_compare_exchange_weak_explicit(&this->head, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            return false; // slot still holds the element from the previous lap: full
+        } else {
+            pos = atomic_load_explicit(&this->head, memory_order_relaxed);
+        }
+    }
+
+    slot->element = element;
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release); // publish to consumers
+    return true;
+}
+
+void* MpmcQueue_tryDeq(MpmcQueue* this) {
+    MpmcSlot *slot;
+    size_t pos;
+    void *elem;
+
+    pos = atomic_load_explicit(&this->tail, memory_order_relaxed);
+    for (;;) {
+        slot = &this->slots[pos % this->max_size];
+        size_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+        if (diff == 0) {
+            // slot has been published for this ticket; try to claim it
+            if (atomic_compare_exchange_weak_explicit(&this->tail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            return NULL; // producer has not written this slot yet: empty
+        } else {
+            pos = atomic_load_explicit(&this->tail, memory_order_relaxed);
+        }
+    }
+
+    elem = slot->element;
+    atomic_store_explicit(&slot->sequence, pos + this->max_size, memory_order_release); // free for next lap
+    return elem;
+}
+
+int MpmcQueue_size(MpmcQueue* this) {
+    size_t tail = atomic_load_explicit(&this->tail, memory_order_acquire);
+    size_t head = atomic_load_explicit(&this->head, memory_order_acquire);
+
+    // the two loads are not taken together, so clamp a momentarily inconsistent view
+    if (head <= tail) return 0;
+    if (head - tail > this->max_size) return (int)this->max_size;
+    return (int)(head - tail);
+}
+
+bool MpmcQueue_isEmpty(MpmcQueue* this) {
+    return MpmcQueue_size(this) == 0;
+}
+
+void MpmcQueue_clear(MpmcQueue* this) {
+    if(this) {
+        while (MpmcQueue_tryDeq(this) != NULL)
+            ;
+    }
+}
+
+void MpmcQueue_destroy(MpmcQueue* this) {
+    if(this) {
+        free(this->slots);
+        free(this);
+    }
+}
@@ -0,0 +1,77 @@
+/*
+ * MpmcQueue.h
+ *
+ * Module interface for a generic fixed-size lock-free multi-producer/multi-consumer Queue.
+ *
+ * Each slot of the ring carries a sequence number which tells producers and consumers
+ * whether the slot is free to write or ready to read for their ticket. Producers and
+ * consumers claim tickets with a CAS on head and tail respectively, so neither side
+ * ever takes a lock. Operations never block; see BlockingQueue for blocking wrappers.
+ *
+ */
+
+#ifndef MPMC_QUEUE_H_
+#define MPMC_QUEUE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#define MPMC_CACHE_LINE 64
+
+typedef struct MpmcQueue MpmcQueue;
+
+typedef struct MpmcSlot {
+    atomic_size_t sequence;
+    void* element;
+} MpmcSlot;
+
+struct MpmcQueue {
+    MpmcSlot* slots;
+    size_t max_size;
+
+    _Alignas(MPMC_CACHE_LINE) atomic_size_t head; // next enq ticket
+    _Alignas(MPMC_CACHE_LINE) atomic_size_t tail; // next deq ticket
+};
+
+/*
+ * Creates a new MpmcQueue for at most max_size void* elements.
+ * Returns a pointer to a new MpmcQueue on success and NULL on failure.
+ */
+MpmcQueue* new_MpmcQueue(int max_size);
+
+/*
+ * Enqueues the given void* element at the back of this Queue without blocking.
+ * Returns true on success and false when element is NULL or the queue is full.
+ */
+bool MpmcQueue_tryEnq(MpmcQueue* this, void* element);
+
+/*
+ * Dequeues an element from the front of this Queue without blocking.
+ * Returns dequeued void* element on success or NULL if queue is empty.
+ */
+void* MpmcQueue_tryDeq(MpmcQueue* this);
+
+/*
+ * Returns the number of elements currently in this Queue.
+ * The result is only a snapshot when other threads are using the queue.
+ */
+int MpmcQueue_size(MpmcQueue* this);
+
+/*
+ * Returns true if this Queue is empty, false otherwise.
+ */
+bool MpmcQueue_isEmpty(MpmcQueue* this);
+
+/*
+ * Clears this Queue returning it to an empty state.
+ * Safe to call concurrently with other operations; elements enqueued during the clear may survive it.
+ */
+void MpmcQueue_clear(MpmcQueue* this);
+
+/*
+ * Destroys this Queue by freeing the memory used by the Queue.
+ */
+void MpmcQueue_destroy(MpmcQueue* this);
+
+#endif /* MPMC_QUEUE_H_ */
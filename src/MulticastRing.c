@@ -0,0 +1,198 @@
+/*
+ * MulticastRing.c
+ *
+ * Single-producer broadcast ring implementation with a sequence cursor per consumer.
+ *
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "MulticastRing.h"
+
+
+MulticastRing *new_MulticastRing(int size) {
+    if (size <= 0 || size > (1 << 30)) return NULL;
+
+    // aligned_alloc needs a size that is a multiple of the alignment
+    size_t bytes = (sizeof(MulticastRing) + MULTICAST_CACHE_LINE - 1) / MULTICAST_CACHE_LINE * MULTICAST_CACHE_LINE;
+    MulticastRing *R = aligned_alloc(MULTICAST_CACHE_LINE, bytes);
+    if (R == NULL) return NULL;
+
+    // a power of two, so a sequence maps to its slot with a mask
+    R->size = 1;
+    while (R->size < size)
+        R->size <<= 1;
+    R->mask = R->size - 1;
+    R->slots = calloc(R->size, sizeof(void *));
+    if (R->slots == NULL) {
+        free(R);
+        return NULL;
+    }
+
+    atomic_init(&R->published, 0);
+    R->gate = 0;
+    R->cursor_count = 0;
+    R->has_dependents = false;
+    EventCount_init(&R->published_event, EVENT_COUNT_DEFAULT_SPIN);
+    EventCount_init(&R->consumed_event, EVENT_COUNT_DEFAULT_SPIN);
+    return R;
+}
+
+MulticastCursor* MulticastRing_addCursor(MulticastRing* this, MulticastCursor* upstream) {
+    if (this->cursor_count == MULTICAST_MAX_CURSORS || (upstream != NULL && upstream->ring != this))
+        return NULL;
+
+    size_t bytes = (sizeof(MulticastCursor) + MULTICAST_CACHE_LINE - 1) / MULTICAST_CACHE_LINE * MULTICAST_CACHE_LINE;
+    MulticastCursor *cursor = aligned_alloc(MULTICAST_CACHE_LINE, bytes);
+    if (cursor == NULL) return NULL;
+
+    long start = atomic_load(&this->published);
+    atomic_init(&cursor->sequence, start);
+    cursor->ring = this;
+    cursor->upstream = upstream;
+    cursor->available = start;
+    if (upstream != NULL)
+        this->has_dependents = true;
+    this->cursors[this->cursor_count++] = cursor;
+    return cursor;
+}
+
+/*
+ * Returns the lowest sequence of any cursor, or published when there is none.
+ */
+static long slowestCursor(MulticastRing* this) {
+    long min = atomic_load_explicit(&this->published, memory_order_relaxed);
+
+    for (int i = 0; i < this->cursor_count; i++) {
+        long sequence = atomic_load_explicit(&this->cursors[i]->sequence, memory_order_acquire);
+        if (sequence < min)
+            min = sequence;
+    }
+    return min;
+}
+
+/*
+ * Returns how many slots the producer may write now, refreshing its cached gate only when
+ * the cached value says the ring is full.
+ */
+static long freeSlots(MulticastRing* this) {
+    long next = atomic_load_explicit(&this->published, memory_order_relaxed);
+
+    if (next - this->gate >= this->size)
+        this->gate = slowestCursor(this);
+    return this->size - (next - this->gate);
+}
+
+static bool ringHasSpace(void* this) {
+    MulticastRing *ring = this;
+    long next = atomic_load_explicit(&ring->published, memory_order_relaxed);
+    return next - slowestCursor(ring) < ring->size;
+}
+
+/*
+ * Writes count elements into the free slots after published and makes them visible at once.
+ */
+static void publishMany(MulticastRing* this, void** elements, long count) {
+    long next = atomic_load_explicit(&this->published, memory_order_relaxed);
+
+    for (long i = 0; i < count; i++)
+        this->slots[(next + i) & this->mask] = elements[i];
+    atomic_store_explicit(&this->published, next + count, memory_order_release);
+    EventCount_notify(&this->published_event, 0);
+}
+
+bool MulticastRing_tryPublish(MulticastRing* this, void* element) {
+    if (element == NULL || freeSlots(this) == 0)
+        return false;
+    publishMany(this, &element, 1);
+    return true;
+}
+
+bool MulticastRing_publish(MulticastRing* this, void* element) {
+    return MulticastRing_publishBatch(this, &element, 1);
+}
+
+bool MulticastRing_publishBatch(MulticastRing* this, void** elements, int count) {
+    for (int i = 0; i < count; i++) {
+        if (elements[i] == NULL)
+            return false;
+    }
+
+    for (int done = 0; done < count;) {
+        long space = freeSlots(this);
+        if (space == 0) {
+            EventCount_await(&this->consumed_event, ringHasSpace, this); // Wait for the slowest cursor
+            continue;
+        }
+        long n = count - done < space ? count - done : space;
+        publishMany(this, elements + done, n);
+        done += n;
+    }
+    return true;
+}
+
+long MulticastRing_published(MulticastRing* this) {
+    return atomic_load(&this->published);
+}
+
+long MulticastRing_readMin(MulticastRing* this) {
+    return slowestCursor(this);
+}
+
+/*
+ * Returns the sequence this cursor may read up to: what is published, or what its upstream has read.
+ */
+static long cursorLimit(MulticastCursor* this) {
+    if (this->upstream != NULL)
+        return atomic_load_explicit(&this->upstream->sequence, memory_order_acquire);
+    return atomic_load_explicit(&this->ring->published, memory_order_acquire);
+}
+
+long MulticastCursor_available(MulticastCursor* this) {
+    return cursorLimit(this) - atomic_load_explicit(&this->sequence, memory_order_relaxed);
+}
+
+static bool cursorReadable(void* this) {
+    return MulticastCursor_available(this) > 0;
+}
+
+int MulticastCursor_tryRead(MulticastCursor* this, void** out, int max) {
+    MulticastRing *ring = this->ring;
+    long sequence = atomic_load_explicit(&this->sequence, memory_order_relaxed);
+
+    if (this->available <= sequence)
+        this->available = cursorLimit(this);
+    long n = this->available - sequence < max ? this->available - sequence : max;
+    if (n <= 0)
+        return 0;
+
+    for (long i = 0; i < n; i++)
+        out[i] = ring->slots[(sequence + i) & ring->mask];
+    atomic_store_explicit(&this->sequence, sequence + n, memory_order_release);
+
+    // the producer may be waiting for this cursor, and so may cursors downstream of it
+    EventCount_notify(&ring->consumed_event, 0);
+    if (ring->has_dependents)
+        EventCount_notify(&ring->published_event, 0);
+    return (int)n;
+}
+
+int MulticastCursor_read(MulticastCursor* this, void** out, int max) {
+    int n;
+
+    if (max <= 0)
+        return 0;
+    while ((n = MulticastCursor_tryRead(this, out, max)) == 0)
+        EventCount_await(&this->ring->published_event, cursorReadable, this); // Wait for an element
+    return n;
+}
+
+void MulticastRing_destroy(MulticastRing* this) {
+    if(this) {
+        for (int i = 0; i < this->cursor_count; i++)
+            free(this->cursors[i]);
+        free(this->slots);
+        free(this);
+    }
+}
@@ -0,0 +1,129 @@
+/*
+ * MulticastRing.h
+ *
+ * Module interface for a Disruptor-style broadcast ring in which every consumer sees every element.
+ *
+ * A single producer writes each void* element into the ring once and publishes it by moving
+ * one sequence counter forward. Each consumer has a cursor of its own, counting the elements
+ * it has read, and reads straight out of the ring up to the published sequence without taking
+ * a lock; a batch read costs one acquire load and one release store however many elements it
+ * takes. A cursor may depend on another, so it only reads what that one has finished with.
+ * The producer only waits when the slowest cursor is a whole ring behind. Elements are shared,
+ * not copied, so consumers must treat them as read-only, and the producer must keep each one
+ * alive until MulticastRing_readMin says every cursor has passed it.
+ *
+ */
+
+#ifndef MULTICAST_RING_H_
+#define MULTICAST_RING_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#include "EventCount.h"
+
+#define MULTICAST_CACHE_LINE 64
+#define MULTICAST_MAX_CURSORS 32
+
+typedef struct MulticastRing MulticastRing;
+typedef struct MulticastCursor MulticastCursor;
+
+/*
+ * One consumer's position in the ring; only its owner moves it
+ */
+struct MulticastCursor {
+    _Alignas(MULTICAST_CACHE_LINE) atomic_long sequence; // elements read so far
+    MulticastRing* ring;
+    MulticastCursor* upstream; // cursor this one must stay behind, NULL for the producer's
+    long available; // owner's cached limit, so most reads skip the shared loads
+};
+
+struct MulticastRing {
+    void** slots;
+    long size, mask; // size is a power of two
+
+    // written by the producer alone
+    _Alignas(MULTICAST_CACHE_LINE) atomic_long published; // elements published so far
+    long gate; // producer's cached sequence of the slowest cursor
+
+    MulticastCursor* cursors[MULTICAST_MAX_CURSORS];
+    int cursor_count;
+    bool has_dependents;
+
+    // consumers park on published and the producer on consumed, only when they must wait
+    EventCount published_event, consumed_event;
+};
+
+/*
+ * Creates a new MulticastRing for at least size void* elements, rounded up to a power of two.
+ * Returns a pointer to a new MulticastRing on success and NULL on failure.
+ */
+MulticastRing* new_MulticastRing(int size);
+
+/*
+ * Adds a consumer to this ring, starting at the next element to be published. If upstream is
+ * not NULL, the new consumer only reads elements upstream has already read.
+ * Must be called before publishing starts.
+ * Returns a pointer to the new consumer's cursor, or NULL on failure or with
+ * MULTICAST_MAX_CURSORS cursors already added.
+ */
+MulticastCursor* MulticastRing_addCursor(MulticastRing* this, MulticastCursor* upstream);
+
+/*
+ * Publishes the given void* element to every consumer of this ring.
+ * Must only be called from one producer thread. If the slowest cursor is a whole ring
+ * behind, blocks the calling thread until it moves on.
+ * Returns false when element is NULL and true on success.
+ */
+bool MulticastRing_publish(MulticastRing* this, void* element);
+
+/*
+ * Publishes element like MulticastRing_publish, without blocking.
+ * Returns true on success and false when element is NULL or the ring is full.
+ */
+bool MulticastRing_tryPublish(MulticastRing* this, void* element);
+
+/*
+ * Publishes all count void* elements from the elements array to every consumer, in order,
+ * making as many visible at once as the slowest cursor allows, and blocking for the rest.
+ * Returns false without publishing anything when any element is NULL and true on success.
+ */
+bool MulticastRing_publishBatch(MulticastRing* this, void** elements, int count);
+
+/*
+ * Returns the number of elements published to this ring so far.
+ */
+long MulticastRing_published(MulticastRing* this);
+
+/*
+ * Returns the number of elements every cursor of this ring has read, so elements published
+ * before that point are no longer referenced by the ring's consumers.
+ */
+long MulticastRing_readMin(MulticastRing* this);
+
+/*
+ * Reads up to max elements after this cursor into the out array, in order, and moves the
+ * cursor past them. Blocks until at least one element is readable.
+ * Must only be called from the cursor's consumer thread.
+ * Returns the number of elements read.
+ */
+int MulticastCursor_read(MulticastCursor* this, void** out, int max);
+
+/*
+ * Reads like MulticastCursor_read without blocking.
+ * Returns the number of elements read, which is 0 if none is readable.
+ */
+int MulticastCursor_tryRead(MulticastCursor* this, void** out, int max);
+
+/*
+ * Returns the number of elements this cursor could read now without blocking.
+ */
+long MulticastCursor_available(MulticastCursor* this);
+
+/*
+ * Destroys this ring by freeing the memory used by it and its cursors.
+ */
+void MulticastRing_destroy(MulticastRing* this);
+
+#endif /* MULTICAST_RING_H_ */
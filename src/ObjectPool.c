@@ -0,0 +1,235 @@
+/*
+ * ObjectPool.c
+ *
+ * Fixed-size object pool implementation over one slab, with per-thread caches refilled and
+ * drained in batches.
+ *
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ObjectPool.h"
+
+/*
+ * Hands each thread a slot the first time it uses any ObjectPool; a thread's cache is its
+ * slot modulo POOL_CACHES, so threads only share a cache when there are more of them
+ */
+static atomic_uint next_slot = 0;
+static _Thread_local int thread_slot = -1;
+
+
+ObjectPool *new_ObjectPool(int count, size_t object_size, int batch) {
+    if (count <= 0 || object_size == 0 || batch <= 0) return NULL;
+
+    // aligned_alloc needs a size that is a multiple of the alignment
+    size_t bytes = (sizeof(ObjectPool) + POOL_CACHE_LINE - 1) / POOL_CACHE_LINE * POOL_CACHE_LINE;
+    ObjectPool *pool = aligned_alloc(POOL_CACHE_LINE, bytes);
+    if (pool == NULL) return NULL;
+
+    // every object starts on a boundary suitable for any type
+    pool->object_size = (object_size + _Alignof(max_align_t) - 1) / _Alignof(max_align_t) * _Alignof(max_align_t);
+    pool->slab_bytes = (count * pool->object_size + POOL_CACHE_LINE - 1) / POOL_CACHE_LINE * POOL_CACHE_LINE;
+    pool->capacity = count;
+    pool->batch = batch < count ? batch : count;
+
+    pool->slab = aligned_alloc(POOL_CACHE_LINE, pool->slab_bytes);
+    pool->free_objects = malloc(count * sizeof(void *));
+    void **cached = malloc(POOL_CACHES * 2 * pool->batch * sizeof(void *));
+    if (pool->slab == NULL || pool->free_objects == NULL || cached == NULL) {
+        free(pool->slab);
+        free(pool->free_objects);
+        free(cached);
+        free(pool);
+        return NULL;
+    }
+
+    // all objects start on the central stack, the first one on top
+    for (int i = 0; i < count; i++)
+        pool->free_objects[i] = pool->slab + (size_t)(count - 1 - i) * pool->object_size;
+    atomic_init(&pool->free_count, count);
+    pthread_mutex_init(&pool->mutex, NULL);
+
+    for (int i = 0; i < POOL_CACHES; i++) {
+        PoolCache *cache = &pool->caches[i];
+        pthread_mutex_init(&cache->mutex, NULL);
+        cache->objects = cached + i * 2 * pool->batch;
+        atomic_init(&cache->count, 0);
+    }
+
+    EventCount_init(&pool->returned, EVENT_COUNT_DEFAULT_SPIN);
+    return pool;
+}
+
+static PoolCache* homeCache(ObjectPool* this) {
+    if (thread_slot < 0)
+        thread_slot = atomic_fetch_add(&next_slot, 1) & 0x7fffffff;
+    return &this->caches[thread_slot % POOL_CACHES];
+}
+
+/*
+ * Moves up to a batch of objects from the central stack into cache, which must be empty and locked.
+ */
+static void refillCache(ObjectPool* this, PoolCache* cache) {
+    pthread_mutex_lock(&this->mutex);
+    int available = atomic_load_explicit(&this->free_count, memory_order_relaxed);
+    int n = available < this->batch ? available : this->batch;
+    memcpy(cache->objects, this->free_objects + available - n, n * sizeof(void *));
+    atomic_store_explicit(&this->free_count, available - n, memory_order_release);
+    pthread_mutex_unlock(&this->mutex);
+
+    atomic_store_explicit(&cache->count, n, memory_order_release);
+}
+
+/*
+ * Moves a batch of objects from the bottom of cache, which must be full and locked, onto the
+ * central stack, keeping the most recently returned objects in the cache.
+ */
+static void drainCache(ObjectPool* this, PoolCache* cache) {
+    int kept = atomic_load_explicit(&cache->count, memory_order_relaxed) - this->batch;
+
+    pthread_mutex_lock(&this->mutex);
+    int available = atomic_load_explicit(&this->free_count, memory_order_relaxed);
+    // only a double put that slipped past heldObjects can leave less room than a batch; the
+    // surplus is dropped rather than written past the end of free_objects
+    int n = this->capacity - available < this->batch ? this->capacity - available : this->batch;
+    memcpy(this->free_objects + available, cache->objects, n * sizeof(void *));
+    atomic_store_explicit(&this->free_count, available + n, memory_order_release);
+    pthread_mutex_unlock(&this->mutex);
+
+    memmove(cache->objects, cache->objects + this->batch, kept * sizeof(void *));
+    atomic_store_explicit(&cache->count, kept, memory_order_release);
+}
+
+/*
+ * Pops one object from cache, which must be locked and not empty.
+ */
+static void* popCache(PoolCache* cache) {
+    int n = atomic_load_explicit(&cache->count, memory_order_relaxed) - 1;
+    atomic_store_explicit(&cache->count, n, memory_order_release);
+    return cache->objects[n];
+}
+
+/*
+ * Takes one object out of any cache but home, for when home and the central stack are both
+ * empty because other threads hold the free objects in their caches.
+ */
+static void* stealObject(ObjectPool* this, PoolCache* home) {
+    for (int i = 0; i < POOL_CACHES; i++) {
+        PoolCache *cache = &this->caches[i];
+        if (cache == home || atomic_load_explicit(&cache->count, memory_order_relaxed) == 0)
+            continue;
+
+        pthread_mutex_lock(&cache->mutex);
+        void *object = atomic_load_explicit(&cache->count, memory_order_relaxed) > 0 ? popCache(cache) : NULL;
+        pthread_mutex_unlock(&cache->mutex);
+        if (object != NULL)
+            return object;
+    }
+    return NULL;
+}
+
+void* ObjectPool_tryGet(ObjectPool* this) {
+    PoolCache *home = homeCache(this);
+    void *object = NULL;
+
+    pthread_mutex_lock(&home->mutex);
+    if (atomic_load_explicit(&home->count, memory_order_relaxed) == 0)
+        refillCache(this, home);
+    if (atomic_load_explicit(&home->count, memory_order_relaxed) > 0)
+        object = popCache(home);
+    pthread_mutex_unlock(&home->mutex);
+
+    // never hold two cache locks at once, so stealing threads cannot deadlock each other
+    return object != NULL ? object : stealObject(this, home);
+}
+
+static bool objectAvailable(void* this) {
+    return ObjectPool_available(this) > 0;
+}
+
+void* ObjectPool_get(ObjectPool* this) {
+    void *object;
+
+    while ((object = ObjectPool_tryGet(this)) == NULL)
+        EventCount_await(&this->returned, objectAvailable, this); // Wait for an object to come back
+    return object;
+}
+
+bool ObjectPool_owns(ObjectPool* this, void* object) {
+    char *address = object;
+
+    if (address < this->slab || address >= this->slab + (size_t)this->capacity * this->object_size)
+        return false;
+    return (size_t)(address - this->slab) % this->object_size == 0;
+}
+
+/*
+ * Returns the exact number of objects the pool holds, counted with every lock taken, in the
+ * same cache then central order refillCache and drainCache use.
+ */
+static int heldObjects(ObjectPool* this) {
+    for (int i = 0; i < POOL_CACHES; i++)
+        pthread_mutex_lock(&this->caches[i].mutex);
+    pthread_mutex_lock(&this->mutex);
+
+    int held = ObjectPool_available(this);
+
+    pthread_mutex_unlock(&this->mutex);
+    for (int i = POOL_CACHES - 1; i >= 0; i--)
+        pthread_mutex_unlock(&this->caches[i].mutex);
+    return held;
+}
+
+bool ObjectPool_put(ObjectPool* this, void* object) {
+    return ObjectPool_putBatch(this, &object, 1);
+}
+
+bool ObjectPool_putBatch(ObjectPool* this, void** objects, int count) {
+    for (int i = 0; i < count; i++) {
+        if (!ObjectPool_owns(this, objects[i]))
+            return false;
+    }
+    // more objects than the pool has room for means some were put back twice; the lock-free
+    // count can overshoot while objects move between caches, so confirm it before rejecting
+    if (count > this->capacity - ObjectPool_available(this) && count > this->capacity - heldObjects(this))
+        return false;
+
+    PoolCache *home = homeCache(this);
+    pthread_mutex_lock(&home->mutex);
+    for (int i = 0; i < count; i++) {
+        int n = atomic_load_explicit(&home->count, memory_order_relaxed);
+        if (n == 2 * this->batch) {
+            drainCache(this, home);
+            n -= this->batch;
+        }
+        home->objects[n] = objects[i];
+        atomic_store_explicit(&home->count, n + 1, memory_order_release);
+    }
+    pthread_mutex_unlock(&home->mutex);
+
+    if (count > 0)
+        EventCount_notify(&this->returned, count);
+    return true;
+}
+
+int ObjectPool_available(ObjectPool* this) {
+    int available = atomic_load(&this->free_count);
+
+    for (int i = 0; i < POOL_CACHES; i++)
+        available += atomic_load(&this->caches[i].count);
+    return available;
+}
+
+void ObjectPool_destroy(ObjectPool* this) {
+    if(this) {
+        for (int i = 0; i < POOL_CACHES; i++)
+            pthread_mutex_destroy(&this->caches[i].mutex);
+        pthread_mutex_destroy(&this->mutex);
+        free(this->caches[0].objects); // one array holds every cache's objects
+        free(this->free_objects);
+        free(this->slab);
+        free(this);
+    }
+}
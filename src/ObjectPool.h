@@ -0,0 +1,113 @@
+/*
+ * ObjectPool.h
+ *
+ * Module interface for a fixed-size pool of equally sized objects, to recycle the payloads
+ * passed through a BlockingQueue instead of allocating and freeing one per element.
+ *
+ * Every object is carved out of one slab allocated with the pool, so once the pool exists
+ * getting and putting objects never calls malloc. Each thread gets and puts through a cache
+ * of its own, picked once per thread like a ShardedBlockingQueue's home shard, and caches
+ * trade objects with a central stack batch objects at a time: a consumer's cache hands
+ * returned objects back in bulk, and a producer's cache takes them out in bulk, so in a
+ * steady producer to consumer pipeline the central lock is taken once per batch.
+ *
+ * Typical use: the producer fills ObjectPool_get(pool) and enqueues it; the consumer
+ * dequeues it, uses it and hands it back with ObjectPool_put(pool, object).
+ *
+ */
+
+#ifndef OBJECT_POOL_H_
+#define OBJECT_POOL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "EventCount.h"
+
+#define POOL_CACHE_LINE 64
+#define POOL_CACHES 16
+#define POOL_DEFAULT_BATCH 32
+
+typedef struct PoolCache PoolCache;
+typedef struct ObjectPool ObjectPool;
+
+/*
+ * Free objects held back for the threads sharing one cache slot; holds up to twice the batch
+ */
+struct PoolCache {
+    _Alignas(POOL_CACHE_LINE) pthread_mutex_t mutex;
+    void** objects;
+    atomic_int count; // written with the mutex held, readable without it
+};
+
+struct ObjectPool {
+    char* slab;
+    size_t object_size, slab_bytes;
+    int capacity, batch;
+
+    PoolCache caches[POOL_CACHES];
+
+    // objects no cache holds, moved in and out batch at a time
+    _Alignas(POOL_CACHE_LINE) pthread_mutex_t mutex;
+    void** free_objects;
+    atomic_int free_count;
+
+    EventCount returned; // threads in ObjectPool_get park here when every object is in use
+};
+
+/*
+ * Creates a new ObjectPool of count objects of object_size bytes each, suitably aligned for
+ * any type, which move between the per-thread caches batch objects at a time.
+ * Returns a pointer to a new ObjectPool on success and NULL on failure.
+ */
+ObjectPool* new_ObjectPool(int count, size_t object_size, int batch);
+
+/*
+ * Takes a free object from this pool.
+ * If every object is in use, blocks the calling thread until one is put back.
+ * Returns the object, whose contents are whatever its last user left in it.
+ */
+void* ObjectPool_get(ObjectPool* this);
+
+/*
+ * Takes a free object from this pool without blocking.
+ * Returns the object, or NULL if every object is in use.
+ */
+void* ObjectPool_tryGet(ObjectPool* this);
+
+/*
+ * Puts object, taken from this pool by any thread, back into it.
+ * Each object may be put back only once per get: a put that would leave the pool holding
+ * more than its count objects is rejected, but a double put racing other threads' gets
+ * can go unnoticed and hand the same object to two users.
+ * Returns false, doing nothing, when object is NULL or does not belong to this pool, or when
+ * the pool already holds every object, and true on success.
+ */
+bool ObjectPool_put(ObjectPool* this, void* object);
+
+/*
+ * Puts all count objects from the objects array back into this pool, like ObjectPool_put.
+ * Returns false without putting anything back when any object is NULL or foreign, or when the
+ * pool has no room for count more objects, and true on success.
+ */
+bool ObjectPool_putBatch(ObjectPool* this, void** objects, int count);
+
+/*
+ * Returns true if object is one of this pool's objects, false otherwise.
+ */
+bool ObjectPool_owns(ObjectPool* this, void* object);
+
+/*
+ * Returns the number of objects not in use, across the central stack and every cache.
+ * The result is only a snapshot when other threads are using the pool.
+ */
+int ObjectPool_available(ObjectPool* this);
+
+/*
+ * Destroys this pool, freeing the slab every one of its objects lives in.
+ */
+void ObjectPool_destroy(ObjectPool* this);
+
+#endif /* OBJECT_POOL_H_ */
@@ -0,0 +1,216 @@
+/*
+ * PriorityBlockingQueue.c
+ *
+ * Fixed-size generic BlockingQueue implementation ordered by priority, over a heap or per-level lists.
+ *
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "PriorityBlockingQueue.h"
+
+#define HEAP_ARITY 4 // four children share a cache line or two, halving the depth of a binary heap
+
+
+static PriorityBlockingQueue* newPriorityBlockingQueue(int max_size, int levels) {
+    if (max_size <= 0) return NULL;
+
+    PriorityBlockingQueue *pQueue = calloc(1, sizeof(PriorityBlockingQueue));
+    if (pQueue == NULL) return NULL;
+
+    pQueue->max_size = max_size;
+    pQueue->levels = levels;
+    if (levels == 0) {
+        pQueue->heap = malloc(max_size * sizeof(PriorityEntry));
+        if (pQueue->heap == NULL) {
+            free(pQueue);
+            return NULL;
+        }
+    } else {
+        pQueue->buckets = malloc(levels * sizeof(PriorityLevel));
+        pQueue->nodes = malloc(max_size * sizeof(PriorityNode));
+        if (pQueue->buckets == NULL || pQueue->nodes == NULL) {
+            free(pQueue->buckets);
+            free(pQueue->nodes);
+            free(pQueue);
+            return NULL;
+        }
+        for (int i = 0; i < levels; i++)
+            pQueue->buckets[i].head = pQueue->buckets[i].tail = -1;
+        for (int i = 0; i < max_size; i++)
+            pQueue->nodes[i].next = i + 1 < max_size ? i + 1 : -1;
+        pQueue->free_node = 0;
+    }
+
+    pthread_mutex_init(&pQueue->mutex, NULL);
+    atomic_init(&pQueue->current_size, 0);
+    atomic_init(&pQueue->available, max_size);
+    EventCount_init(&pQueue->not_full, EVENT_COUNT_DEFAULT_SPIN);
+    EventCount_init(&pQueue->not_empty, EVENT_COUNT_DEFAULT_SPIN);
+    return pQueue;
+}
+
+PriorityBlockingQueue *new_PriorityBlockingQueue(int max_size) {
+    return newPriorityBlockingQueue(max_size, 0);
+}
+
+PriorityBlockingQueue *new_BucketedPriorityBlockingQueue(int max_size, int levels) {
+    if (levels <= 0 || levels > PRIORITY_QUEUE_MAX_LEVELS) return NULL;
+    return newPriorityBlockingQueue(max_size, levels);
+}
+
+static bool entryBefore(PriorityEntry* a, PriorityEntry* b) {
+    return a->priority < b->priority || (a->priority == b->priority && a->seq < b->seq);
+}
+
+/*
+ * The storage behind the queue, called with the mutex held and a slot or element already claimed.
+ */
+static void heapPush(PriorityBlockingQueue* this, void* element, int priority) {
+    PriorityEntry entry = { priority, this->next_seq++, element };
+    int i = this->size++;
+
+    // move parents down until entry's slot is found, instead of swapping at every level
+    while (i > 0) {
+        int parent = (i - 1) / HEAP_ARITY;
+        if (!entryBefore(&entry, &this->heap[parent]))
+            break;
+        this->heap[i] = this->heap[parent];
+        i = parent;
+    }
+    this->heap[i] = entry;
+}
+
+static void* heapPop(PriorityBlockingQueue* this) {
+    void *element = this->heap[0].element;
+    PriorityEntry last = this->heap[--this->size];
+    int i = 0;
+
+    for (;;) {
+        int first = i * HEAP_ARITY + 1;
+        if (first >= this->size)
+            break;
+
+        int best = first;
+        int end = first + HEAP_ARITY < this->size ? first + HEAP_ARITY : this->size;
+        for (int c = first + 1; c < end; c++) {
+            if (entryBefore(&this->heap[c], &this->heap[best]))
+                best = c;
+        }
+        if (!entryBefore(&this->heap[best], &last))
+            break;
+        this->heap[i] = this->heap[best];
+        i = best;
+    }
+    this->heap[i] = last;
+    return element;
+}
+
+static void storeEnq(PriorityBlockingQueue* this, void* element, int priority) {
+    if (this->levels == 0) {
+        heapPush(this, element, priority);
+        return;
+    }
+    // a slot is claimed, so there is always a free node
+    int n = this->free_node;
+    PriorityNode *node = &this->nodes[n];
+    PriorityLevel *bucket = &this->buckets[priority];
+    this->free_node = node->next;
+    node->element = element;
+    node->next = -1;
+    if (bucket->tail < 0)
+        bucket->head = n;
+    else
+        this->nodes[bucket->tail].next = n;
+    bucket->tail = n;
+
+    this->occupied |= (uint64_t)1 << priority;
+    this->size++;
+}
+
+static void* storeDeq(PriorityBlockingQueue* this) {
+    if (this->levels == 0)
+        return heapPop(this);
+
+    int level = __builtin_ctzll(this->occupied); // the lowest non-empty level
+    PriorityLevel *bucket = &this->buckets[level];
+    int n = bucket->head;
+    PriorityNode *node = &this->nodes[n];
+    void *element = node->element;
+
+    bucket->head = node->next;
+    if (bucket->head < 0) {
+        bucket->tail = -1;
+        this->occupied &= ~((uint64_t)1 << level);
+    }
+    node->next = this->free_node;
+    this->free_node = n;
+    this->size--;
+    return element;
+}
+
+bool PriorityBlockingQueue_enq(PriorityBlockingQueue* this, void* element, int priority) {
+    if (element == NULL)
+        return false;
+    if (this->levels > 0 && (priority < 0 || priority >= this->levels))
+        return false;
+
+    EventCount_claim(&(this->not_full), &(this->available), 1, true); // Wait for space in the queue
+
+    pthread_mutex_lock(&(this->mutex));
+    storeEnq(this, element, priority);
+    pthread_mutex_unlock(&(this->mutex));
+
+    EventCount_release(&(this->not_empty), &(this->current_size), 1); // Signal that there is an element in the queue
+    return true;
+}
+
+void* PriorityBlockingQueue_deq(PriorityBlockingQueue* this) {
+    EventCount_claim(&(this->not_empty), &(this->current_size), 1, true); // Wait for an element in the queue
+
+    pthread_mutex_lock(&(this->mutex));
+    void *element = storeDeq(this);
+    pthread_mutex_unlock(&(this->mutex));
+
+    EventCount_release(&(this->not_full), &(this->available), 1); // Signal that there is space in the queue
+    return element;
+}
+
+int PriorityBlockingQueue_size(PriorityBlockingQueue* this) {
+    int size;
+
+    pthread_mutex_lock(&(this->mutex));
+    size = this->size;
+    pthread_mutex_unlock(&(this->mutex));
+
+    return size;
+}
+
+bool PriorityBlockingQueue_isEmpty(PriorityBlockingQueue* this) {
+    return PriorityBlockingQueue_size(this) == 0;
+}
+
+void PriorityBlockingQueue_clear(PriorityBlockingQueue* this) {
+    // claim every unclaimed element like a deq would, so in-flight deqs keep theirs
+    int claimed = atomic_exchange(&(this->current_size), 0);
+    if (claimed == 0)
+        return;
+
+    pthread_mutex_lock(&(this->mutex));
+    for (int i = 0; i < claimed; i++)
+        storeDeq(this);
+    pthread_mutex_unlock(&(this->mutex));
+
+    EventCount_release(&(this->not_full), &(this->available), claimed);
+}
+
+void PriorityBlockingQueue_destroy(PriorityBlockingQueue* this) {
+    if(this) {
+        pthread_mutex_destroy(&(this->mutex));
+        free(this->heap);
+        free(this->buckets);
+        free(this->nodes);
+        free(this);
+    }
+}
@@ -0,0 +1,125 @@
+/*
+ * PriorityBlockingQueue.h
+ *
+ * Module interface for a generic fixed-size Blocking Queue which dequeues by priority.
+ *
+ * Lower priority values are dequeued first and equal priorities keep FIFO order. Elements
+ * are kept either in a 4-ary heap of inline entries in one array, or in one FIFO list per
+ * priority level with a bitmap of the non-empty levels, which makes enq and deq O(1) when
+ * priorities fall in a small range. The levels' lists link nodes from one pool of max_size
+ * nodes, so a bucketed queue needs about the memory of a heap of the same size, however
+ * many levels it has.
+ *
+ */
+
+#ifndef PRIORITY_BLOCKING_QUEUE_H_
+#define PRIORITY_BLOCKING_QUEUE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "EventCount.h"
+
+#define PRIORITY_QUEUE_MAX_LEVELS 64 // one bit per level in the bucket bitmap
+
+typedef struct PriorityEntry PriorityEntry;
+typedef struct PriorityNode PriorityNode;
+typedef struct PriorityLevel PriorityLevel;
+typedef struct PriorityBlockingQueue PriorityBlockingQueue;
+
+/*
+ * A heap slot; seq breaks ties between equal priorities in enqueue order
+ */
+struct PriorityEntry {
+    int priority;
+    unsigned long seq;
+    void* element;
+};
+
+/*
+ * A bucketed queue's element, linked by index into its level's list or the free list
+ */
+struct PriorityNode {
+    void* element;
+    int next; // -1 at the end of a list
+};
+
+/*
+ * The FIFO list of one priority level, oldest at head; both -1 when empty
+ */
+struct PriorityLevel {
+    int head, tail;
+};
+
+struct PriorityBlockingQueue {
+    int max_size, size;
+
+    // heap mode, when levels is 0
+    PriorityEntry* heap;
+    unsigned long next_seq;
+
+    // bucketed mode; bit i of occupied is set while buckets[i] is non-empty
+    int levels;
+    PriorityLevel* buckets;
+    PriorityNode* nodes; // max_size of them, shared by every level
+    int free_node; // head of the unused nodes, -1 when none
+    uint64_t occupied;
+
+    // current_size and available count the elements and free slots not yet claimed by a deq
+    // or enq, and act as counting semaphores
+    pthread_mutex_t mutex;
+    atomic_int current_size, available;
+    EventCount not_full, not_empty;
+};
+
+/*
+ * Creates a new heap-backed PriorityBlockingQueue for at most max_size void* elements
+ * with priorities of any int value.
+ * Returns a pointer to a new PriorityBlockingQueue on success and NULL on failure.
+ */
+PriorityBlockingQueue* new_PriorityBlockingQueue(int max_size);
+
+/*
+ * Creates a new bucketed PriorityBlockingQueue for at most max_size void* elements with
+ * priorities from 0 to levels - 1. levels must be between 1 and PRIORITY_QUEUE_MAX_LEVELS.
+ * Returns a pointer to a new PriorityBlockingQueue on success and NULL on failure.
+ */
+PriorityBlockingQueue* new_BucketedPriorityBlockingQueue(int max_size, int levels);
+
+/*
+ * Enqueues the given void* element with the given priority.
+ * If the queue is full, the function will block the calling thread until there is space in the queue.
+ * Returns false when element is NULL or priority is outside a bucketed queue's levels and true on success.
+ */
+bool PriorityBlockingQueue_enq(PriorityBlockingQueue* this, void* element, int priority);
+
+/*
+ * Dequeues the element with the lowest priority value, the oldest first among equal priorities.
+ * If the queue is empty, the function will block until an element can be dequeued.
+ * Returns the dequeued void* element.
+ */
+void* PriorityBlockingQueue_deq(PriorityBlockingQueue* this);
+
+/*
+ * Returns the number of elements currently in this Queue.
+ */
+int PriorityBlockingQueue_size(PriorityBlockingQueue* this);
+
+/*
+ * Returns true if this Queue is empty, false otherwise.
+ */
+bool PriorityBlockingQueue_isEmpty(PriorityBlockingQueue* this);
+
+/*
+ * Clears this Queue returning it to an empty state.
+ */
+void PriorityBlockingQueue_clear(PriorityBlockingQueue* this);
+
+/*
+ * Destroys this Queue by freeing the memory used by the Queue.
+ */
+void PriorityBlockingQueue_destroy(PriorityBlockingQueue* this);
+
+#endif /* PRIORITY_BLOCKING_QUEUE_H_ */
@@ -8,6 +8,11 @@
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
 #include "Queue.h"
 
 /*
@@ -17,15 +22,58 @@
 
 
 Queue *new_Queue(int max_size) {
-    Queue *Q = (Queue *)malloc(sizeof(Queue));
+    return new_QueueWithLayout(max_size, QUEUE_LAYOUT_DEFAULT);
+}
+
+/*
+ * Maps bytes of anonymous memory for a data array, from explicit huge pages if asked and
+ * available, otherwise advising the kernel to back it with transparent huge pages.
+ * Returns NULL on failure.
+ */
+static void** mapData(size_t bytes, int layout) {
+    void *data = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    if (layout & QUEUE_LAYOUT_HUGETLB)
+        data = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+    if (data == MAP_FAILED) {
+        data = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED)
+            return NULL;
+#ifdef MADV_HUGEPAGE
+        madvise(data, bytes, MADV_HUGEPAGE);
+#endif
+    }
+    return data;
+}
+
+Queue *new_QueueWithLayout(int max_size, int layout) {
+    // aligned_alloc needs a size that is a multiple of the alignment
+    size_t bytes = (sizeof(Queue) + QUEUE_CACHE_LINE - 1) / QUEUE_CACHE_LINE * QUEUE_CACHE_LINE;
+    Queue *Q = aligned_alloc(QUEUE_CACHE_LINE, bytes);
     if (Q == NULL) return NULL;
 
     Q->max_size = max_size+1; // one extra space to distinguish between full and empty
-    Q->size = 0; // current size
     Q->head = 0; // write index
     Q->tail = 0; // read index
-    Q->data = (void **)malloc(Q->max_size * sizeof(void *));
-    
+    Q->mapped_bytes = 0;
+    Q->overflow = QUEUE_OVERFLOW_REJECT;
+    Q->reclaim = NULL;
+    Q->dropped = 0;
+    Q->sample_seed = QueueOverflow_newSeed(Q);
+    Q->stats = NULL;
+
+    size_t data_bytes = Q->max_size * sizeof(void *);
+    if (layout & (QUEUE_LAYOUT_HUGE_PAGES | QUEUE_LAYOUT_HUGETLB)) {
+        Q->mapped_bytes = (data_bytes + QUEUE_HUGE_PAGE - 1) / QUEUE_HUGE_PAGE * QUEUE_HUGE_PAGE;
+        Q->data = mapData(Q->mapped_bytes, layout);
+    } else if (layout & QUEUE_LAYOUT_ALIGNED) {
+        Q->data = aligned_alloc(QUEUE_CACHE_LINE, (data_bytes + QUEUE_CACHE_LINE - 1) / QUEUE_CACHE_LINE * QUEUE_CACHE_LINE);
+    } else {
+        Q->data = (void **)malloc(data_bytes);
+    }
+
     if (Q->data == NULL) {
         free(Q);
         return NULL;
@@ -33,6 +81,37 @@ Queue *new_Queue(int max_size) {
     return Q;
 }
 
+unsigned QueueOverflow_newSeed(const void* salt) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    uint64_t x = (uintptr_t)salt ^ (uint64_t)(uintptr_t)pthread_self() * 0x9e3779b97f4a7c15u
+            ^ ((uint64_t)now.tv_sec * 1000000000u + now.tv_nsec);
+    // splitmix64's finaliser, so nearby addresses and times give unrelated seeds
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9u;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebu;
+    x ^= x >> 31;
+
+    unsigned seed = (unsigned)(x ^ (x >> 32));
+    return seed != 0 ? seed : 2463534242u;
+}
+
+void Queue_setOverflow(Queue* this, QueueOverflow policy, QueueReclaim reclaim) {
+    this->overflow = policy;
+    this->reclaim = reclaim;
+}
+
+long Queue_dropped(Queue* this) {
+    return this->dropped;
+}
+
+// Counts element as dropped and hands it to the reclaim callback.
+static void dropElement(Queue* this, void* element) {
+    this->dropped++;
+    if (this->reclaim != NULL)
+        this->reclaim(element);
+}
+
 bool Queue_enq(Queue* this, void* element) {
     int next;
 
@@ -40,12 +119,32 @@ bool Queue_enq(Queue* this, void* element) {
     if (next >= this->max_size)
         next = 0;
     
-    if (next == this->tail || element == NULL)
+    if (element == NULL)
         return false;
+    if (this->overflow == QUEUE_OVERFLOW_SAMPLE
+            && !QueueOverflow_sampleAdmits(Queue_size(this), this->max_size - 1, &this->sample_seed)) {
+        dropElement(this, element);
+        return true;
+    }
+    if (next == this->tail) {
+        QUEUE_STATS_ADD(this->stats, full, 1);
+        if (this->overflow == QUEUE_OVERFLOW_REJECT)
+            return false;
+        if (this->overflow != QUEUE_OVERFLOW_OVERWRITE_OLDEST) {
+            dropElement(this, element);
+            return true;
+        }
+        // the oldest element's slot frees up the one enq needs
+        void *oldest = this->data[this->tail];
+        if (++this->tail == this->max_size)
+            this->tail = 0;
+        dropElement(this, oldest);
+    }
 
     this->data[this->head] = element;
     this->head = next;
-    this->size++;
+    QUEUE_STATS_ADD(this->stats, enqs, 1);
+    QUEUE_STATS_MAX(this->stats, high_water, Queue_size(this));
     return true;
 }
 
@@ -53,8 +152,10 @@ void* Queue_deq(Queue* this) {
     int next;
     void *elem;
 
-    if (Queue_isEmpty(this)) // return null if queue is empty
+    if (Queue_isEmpty(this)) { // return null if queue is empty
+        QUEUE_STATS_ADD(this->stats, empty, 1);
         return NULL;
+    }
 
     next = (this->tail + 1); // where next element would be
     if (next >= this->max_size) // wrap to start of queue to make it circular
@@ -62,13 +163,102 @@ void* Queue_deq(Queue* this) {
 
     elem = this->data[this->tail];
     this->tail = next;
-    this->size--;
+    QUEUE_STATS_ADD(this->stats, deqs, 1);
 
     return elem;
 }
 
+int Queue_enqMany(Queue* this, void** elements, int count) {
+    int space, n, first;
+
+    if (this->overflow != QUEUE_OVERFLOW_REJECT) {
+        for (n = 0; n < count && Queue_enq(this, elements[n]); n++)
+            ;
+        return n;
+    }
+
+    space = (this->max_size - 1) - Queue_size(this);
+    n = count < space ? count : space;
+    if (n < count)
+        QUEUE_STATS_ADD(this->stats, full, 1);
+    for (int i = 0; i < n; i++) { // NULL is never stored, so stop short of the first one
+        if (elements[i] == NULL) {
+            n = i;
+            break;
+        }
+    }
+    if (n <= 0)
+        return 0;
+
+    // copy up to the end of the array, then whatever is left wraps to the start
+    first = this->max_size - this->head;
+    if (first > n)
+        first = n;
+    memcpy(&this->data[this->head], elements, first * sizeof(void *));
+    memcpy(this->data, elements + first, (n - first) * sizeof(void *));
+
+    this->head = (this->head + n) % this->max_size;
+    QUEUE_STATS_ADD(this->stats, enqs, n);
+    QUEUE_STATS_MAX(this->stats, high_water, Queue_size(this));
+    return n;
+}
+
+int Queue_deqMany(Queue* this, void** out, int max) {
+    int n, first;
+
+    int size = Queue_size(this);
+    n = max < size ? max : size;
+    if (n <= 0) {
+        if (max > 0)
+            QUEUE_STATS_ADD(this->stats, empty, 1);
+        return 0;
+    }
+
+    first = this->max_size - this->tail;
+    if (first > n)
+        first = n;
+    memcpy(out, &this->data[this->tail], first * sizeof(void *));
+    memcpy(out + first, this->data, (n - first) * sizeof(void *));
+
+    this->tail = (this->tail + n) % this->max_size;
+    QUEUE_STATS_ADD(this->stats, deqs, n);
+    return n;
+}
+
+void* Queue_peek(Queue* this) {
+    if (Queue_isEmpty(this))
+        return NULL;
+    return this->data[this->tail];
+}
+
+int Queue_readSpans(Queue* this, QueueSpan* first, QueueSpan* second) {
+    int size = Queue_size(this);
+    int contiguous = this->max_size - this->tail; // slots from the tail to the end of the array
+
+    first->data = &this->data[this->tail];
+    first->count = size < contiguous ? size : contiguous;
+    second->data = this->data;
+    second->count = size - first->count;
+    return size;
+}
+
+int Queue_consume(Queue* this, int n) {
+    int size = Queue_size(this);
+
+    if (n > size)
+        n = size;
+    if (n <= 0)
+        return 0;
+
+    this->tail = (this->tail + n) % this->max_size;
+    QUEUE_STATS_ADD(this->stats, deqs, n);
+    return n;
+}
+
 int Queue_size(Queue* this) {
-    return this->size;
+    // derived rather than stored, so enq only writes head and deq only writes tail
+    int size = this->head - this->tail;
+    return size < 0 ? size + this->max_size : size;
 }
 
 bool Queue_isEmpty(Queue* this) {
@@ -79,7 +269,6 @@ void Queue_clear(Queue* this) {
     if(this) {
         this->head = 0;
         this->tail = 0;
-        this->size = 0;
         
         if (Queue_isEmpty(this) == false) {
             for (int i = 0; i < this->max_size; i++) {
@@ -89,9 +278,37 @@ void Queue_clear(Queue* this) {
     }
 }
 
+bool Queue_enableStats(Queue* this) {
+#ifdef QUEUE_STATS
+    if (this->stats == NULL)
+        this->stats = new_QueueStats();
+    return this->stats != NULL;
+#else
+    (void)this;
+    return false;
+#endif
+}
+
+bool Queue_getStats(Queue* this, QueueStatsSnapshot* out) {
+#ifdef QUEUE_STATS
+    if (this->stats == NULL)
+        return false;
+    QueueStats_snapshot(this->stats, out);
+    return true;
+#else
+    (void)this;
+    (void)out;
+    return false;
+#endif
+}
+
 void Queue_destroy(Queue* this) {
     if(this) {
-        free(this->data);
+        free(this->stats);
+        if (this->mapped_bytes > 0)
+            munmap(this->data, this->mapped_bytes);
+        else
+            free(this->data);
         free(this);
     }
 }
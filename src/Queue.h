@@ -9,13 +9,112 @@
 #define QUEUE_H_
 
 #include <stdbool.h>
+#include <stddef.h>
+
+#include "QueueStats.h"
+
+#define QUEUE_CACHE_LINE 64
+#define QUEUE_HUGE_PAGE (2 * 1024 * 1024)
+
+/*
+ * Built with QUEUE_ALIGNED (make ALIGN=-DQUEUE_ALIGNED), the index enq writes and the index
+ * deq writes each get a cache line of their own, so a producer and a consumer on different
+ * cores, handing elements over under a lock, stop bouncing one line between them. The size
+ * is derived from the two, so neither side writes to the other's line. Otherwise the fields
+ * are packed together.
+ */
+#ifdef QUEUE_ALIGNED
+#define QUEUE_OWN_LINE _Alignas(QUEUE_CACHE_LINE)
+#else
+#define QUEUE_OWN_LINE
+#endif
+
+/*
+ * How the data array of a Queue is allocated; flags may be combined.
+ * QUEUE_LAYOUT_ALIGNED starts the array on a cache line boundary.
+ * QUEUE_LAYOUT_HUGE_PAGES maps the array and asks for transparent huge pages, which cuts
+ * TLB misses when walking a large ring.
+ * QUEUE_LAYOUT_HUGETLB maps the array from explicit (hugetlbfs) huge pages, falling back
+ * to QUEUE_LAYOUT_HUGE_PAGES when none are reserved.
+ */
+typedef enum QueueLayout {
+    QUEUE_LAYOUT_DEFAULT = 0,
+    QUEUE_LAYOUT_ALIGNED = 1,
+    QUEUE_LAYOUT_HUGE_PAGES = 2,
+    QUEUE_LAYOUT_HUGETLB = 4
+} QueueLayout;
+
+/*
+ * What an enq does when the queue is full; producers never wait under any policy but the default.
+ * QUEUE_OVERFLOW_REJECT refuses the new element (Queue) or waits for space (BlockingQueue).
+ * QUEUE_OVERFLOW_OVERWRITE_OLDEST drops the element at the front to make room, like a ring log.
+ * QUEUE_OVERFLOW_DROP_NEWEST drops the new element.
+ * QUEUE_OVERFLOW_SAMPLE admits new elements with a probability falling from 1 when the queue
+ * is half full to 0 when it is full, dropping the rest, so a burst is sampled across its
+ * length rather than cut off at the point the queue filled.
+ * Dropped elements are counted and passed to the queue's QueueReclaim callback, if set.
+ */
+typedef enum QueueOverflow {
+    QUEUE_OVERFLOW_REJECT,
+    QUEUE_OVERFLOW_OVERWRITE_OLDEST,
+    QUEUE_OVERFLOW_DROP_NEWEST,
+    QUEUE_OVERFLOW_SAMPLE
+} QueueOverflow;
+
+/*
+ * Called with each element an overflow policy drops, so its memory can be freed or recycled
+ */
+typedef void (*QueueReclaim)(void* element);
+
+/*
+ * Returns a non-zero random state for QueueOverflow_sampleAdmits, mixed from salt, the
+ * calling thread and the clock, so queues and threads each draw a different sequence.
+ */
+unsigned QueueOverflow_newSeed(const void* salt);
+
+/*
+ * Returns true if QUEUE_OVERFLOW_SAMPLE admits a new element into a queue holding size of
+ * capacity elements, advancing the random state at seed.
+ */
+static inline bool QueueOverflow_sampleAdmits(int size, int capacity, unsigned* seed) {
+    int half = capacity / 2;
+    if (size <= half)
+        return true;
+    if (size >= capacity)
+        return false;
+
+    // xorshift32; the state must never be 0
+    unsigned x = *seed != 0 ? *seed : 2463534242u;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *seed = x;
+    return x % (unsigned)(capacity - half) < (unsigned)(capacity - size);
+}
 
 typedef struct Queue Queue;
+typedef struct QueueSpan QueueSpan;
 
 /* You should define your struct Queue here */
 struct Queue {
     void** data;
-    int max_size, size, head, tail;
+    size_t mapped_bytes; // length of data when mmap'd, 0 when malloc'd
+    int max_size;
+    QueueOverflow overflow;
+    QueueReclaim reclaim; // NULL to just drop
+    long dropped;
+    unsigned sample_seed;
+    QueueStats* stats; // NULL unless enabled, kept without QUEUE_STATS so the layout never changes
+    QUEUE_OWN_LINE int head;
+    QUEUE_OWN_LINE int tail;
+};
+
+/*
+ * A run of count elements stored contiguously in a Queue's ring, oldest first
+ */
+struct QueueSpan {
+    void** data;
+    int count;
 };
 
 /*
@@ -24,9 +123,30 @@ struct Queue {
  */
 Queue* new_Queue(int max_size);
 
+/*
+ * Creates a new Queue for at most max_size void* elements with its data array allocated
+ * as described by the given QueueLayout flags.
+ * new_Queue(max_size) is equivalent to passing QUEUE_LAYOUT_DEFAULT.
+ * Returns a pointer to a new Queue on success and NULL on failure.
+ */
+Queue* new_QueueWithLayout(int max_size, int layout);
+
+/*
+ * Sets what an enq on this Queue does when it is full (see QueueOverflow), and the function
+ * dropped elements are passed to, which may be NULL. Defaults to QUEUE_OVERFLOW_REJECT.
+ */
+void Queue_setOverflow(Queue* this, QueueOverflow policy, QueueReclaim reclaim);
+
+/*
+ * Returns the number of elements this Queue's overflow policy has dropped so far.
+ */
+long Queue_dropped(Queue* this);
+
 /*
  * Enqueues the given void* element at the back of this Queue.
  * Returns true on success and false on enq failure when element is NULL or queue is full.
+ * Under an overflow policy other than QUEUE_OVERFLOW_REJECT a full queue does not fail the enq:
+ * it returns true once element has been stored or dropped.
  */
 bool Queue_enq(Queue* this, void* element);
 
@@ -36,6 +156,41 @@ bool Queue_enq(Queue* this, void* element);
  */
 void* Queue_deq(Queue* this);
 
+/*
+ * Enqueues up to count void* elements from the elements array at the back of this Queue, in order.
+ * Stops early at the first NULL element or when the queue becomes full.
+ * Under an overflow policy a full queue does not stop it, and elements dropped count as enqueued.
+ * Returns the number of elements enqueued.
+ */
+int Queue_enqMany(Queue* this, void** elements, int count);
+
+/*
+ * Dequeues up to max elements from the front of this Queue into the out array, in order.
+ * Returns the number of elements dequeued, which is 0 if the queue is empty.
+ */
+int Queue_deqMany(Queue* this, void** out, int max);
+
+/*
+ * Returns the element at the front of this Queue without removing it, or NULL if queue is empty.
+ */
+void* Queue_peek(Queue* this);
+
+/*
+ * Points first and second at the elements of this Queue in place, oldest first: first runs
+ * from the front up to the end of the ring and second holds the rest from its start, so
+ * second is empty unless the elements wrap around. Nothing is removed.
+ * The spans are only valid until the next enq, consume or clear on this Queue.
+ * Returns the total number of elements in the two spans.
+ */
+int Queue_readSpans(Queue* this, QueueSpan* first, QueueSpan* second);
+
+/*
+ * Removes up to n elements from the front of this Queue without copying them out,
+ * typically after processing them in place through Queue_readSpans.
+ * Returns the number of elements removed.
+ */
+int Queue_consume(Queue* this, int n);
+
 /*
  * Returns the number of elements currently in this Queue.
  */
@@ -51,6 +206,18 @@ bool Queue_isEmpty(Queue* this);
  */
 void Queue_clear(Queue* this);
 
+/*
+ * Starts recording statistics for this Queue.
+ * Returns true on success and false when out of memory or not compiled with QUEUE_STATS.
+ */
+bool Queue_enableStats(Queue* this);
+
+/*
+ * Copies the statistics recorded for this Queue into out.
+ * Returns true on success and false when statistics are not enabled for this Queue.
+ */
+bool Queue_getStats(Queue* this, QueueStatsSnapshot* out);
+
 /*
  * Destroys this Queue by freeing the memory used by the Queue.
  */
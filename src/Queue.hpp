@@ -0,0 +1,144 @@
+/*
+ * Queue.hpp
+ *
+ * Header-only C++ interface for a typed fixed-size Queue whose capacity is a template argument.
+ *
+ * Elements of type T are stored in place in a ring inside the object itself, so the queue
+ * never allocates, and are moved in and out rather than copied where T allows. When
+ * Capacity is a power of two the indices wrap with a mask instead of a compare and branch.
+ * Like the C Queue, it is not thread-safe; see BlockingQueue.hpp for that.
+ *
+ */
+
+#ifndef QUEUE_HPP_
+#define QUEUE_HPP_
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace cqueue {
+
+template <typename T, std::size_t Capacity>
+class Queue {
+    static_assert(Capacity > 0, "a Queue needs room for at least one element");
+
+public:
+    Queue() = default;
+    Queue(const Queue&) = delete;
+    Queue& operator=(const Queue&) = delete;
+
+    /*
+     * Destroys the elements still in this Queue.
+     */
+    ~Queue() { clear(); }
+
+    /*
+     * Returns the number of elements this Queue can hold.
+     */
+    static constexpr std::size_t capacity() { return Capacity; }
+
+    /*
+     * Copies element to the back of this Queue.
+     * Returns true on success and false if the queue is full.
+     */
+    bool enq(const T& element) { return emplace(element); }
+
+    /*
+     * Moves element to the back of this Queue.
+     * Returns true on success and false if the queue is full, leaving element untouched.
+     */
+    bool enq(T&& element) { return emplace(std::move(element)); }
+
+    /*
+     * Constructs an element from args in place at the back of this Queue.
+     * Returns true on success and false if the queue is full, constructing nothing.
+     */
+    template <typename... Args>
+    bool emplace(Args&&... args) {
+        if (size_ == Capacity)
+            return false;
+        ::new (static_cast<void*>(data_[head_])) T(std::forward<Args>(args)...);
+        head_ = next(head_);
+        size_++;
+        return true;
+    }
+
+    /*
+     * Moves the element at the front of this Queue into out and removes it.
+     * Returns true on success and false if the queue is empty, leaving out untouched.
+     */
+    bool deq(T& out) {
+        if (size_ == 0)
+            return false;
+        out = std::move(*slot(tail_));
+        pop();
+        return true;
+    }
+
+    /*
+     * Returns the element at the front of this Queue without removing it, or nullptr if
+     * the queue is empty. The pointer is valid until that element is dequeued.
+     */
+    T* peek() { return size_ == 0 ? nullptr : slot(tail_); }
+
+    /*
+     * Removes the element at the front of this Queue without moving it out, typically
+     * after using it in place through peek.
+     * Returns true on success and false if the queue is empty.
+     */
+    bool pop() {
+        if (size_ == 0)
+            return false;
+        slot(tail_)->~T();
+        tail_ = next(tail_);
+        size_--;
+        return true;
+    }
+
+    /*
+     * Returns the number of elements currently in this Queue.
+     */
+    std::size_t size() const { return size_; }
+
+    /*
+     * Returns true if this Queue is empty, false otherwise.
+     */
+    bool isEmpty() const { return size_ == 0; }
+
+    /*
+     * Returns true if this Queue is full, false otherwise.
+     */
+    bool isFull() const { return size_ == Capacity; }
+
+    /*
+     * Clears this Queue returning it to an empty state, destroying every element.
+     */
+    void clear() {
+        while (pop()) {
+        }
+    }
+
+private:
+    static constexpr bool kPowerOfTwo = (Capacity & (Capacity - 1)) == 0;
+
+    // the mask or the compare is picked at compile time, so the other costs nothing
+    static constexpr std::size_t next(std::size_t index) {
+        if constexpr (kPowerOfTwo)
+            return (index + 1) & (Capacity - 1);
+        else
+            return index + 1 == Capacity ? 0 : index + 1;
+    }
+
+    T* slot(std::size_t index) { return std::launder(reinterpret_cast<T*>(data_[index])); }
+
+    // raw storage, so slots hold no T until one is constructed there
+    alignas(T) unsigned char data_[Capacity][sizeof(T)];
+    std::size_t head_ = 0; // write index
+    std::size_t tail_ = 0; // read index
+    std::size_t size_ = 0;
+};
+
+} // namespace cqueue
+
+#endif /* QUEUE_HPP_ */
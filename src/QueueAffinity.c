@@ -0,0 +1,137 @@
+/*
+ * QueueAffinity.c
+ *
+ * NUMA placement helpers for queue memory and the threads using it.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+#ifdef QUEUE_NUMA
+#include <numa.h>
+#endif
+#include "QueueAffinity.h"
+
+#define NODE_SYSFS "/sys/devices/system/node"
+
+
+/*
+ * Reads a sysfs list such as "0-3,8,10-11" from path into set.
+ * Returns the highest number listed, or -1 if the file cannot be read or lists nothing.
+ */
+static int readList(const char* path, cpu_set_t* set) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) return -1;
+
+    int highest = -1, first, last;
+    CPU_ZERO(set);
+    while (fscanf(file, "%d", &first) == 1) {
+        last = first;
+        int c = fgetc(file);
+        if (c == '-') {
+            if (fscanf(file, "%d", &last) != 1)
+                break;
+            c = fgetc(file);
+        }
+        for (int i = first; i <= last && i < CPU_SETSIZE; i++)
+            CPU_SET(i, set);
+        if (last > highest)
+            highest = last;
+        if (c != ',')
+            break;
+    }
+    fclose(file);
+    return highest;
+}
+
+int QueueAffinity_nodeCount(void) {
+    cpu_set_t nodes;
+    int highest = readList(NODE_SYSFS "/online", &nodes);
+    return highest < 0 ? 1 : highest + 1;
+}
+
+/*
+ * Stores in cpus the CPUs of node that the process may run on; without sysfs, node 0 has them all.
+ * Returns true if there is at least one.
+ */
+static bool nodeCpus(int node, cpu_set_t* cpus) {
+    char path[sizeof(NODE_SYSFS "/node/cpulist") + 12];
+    cpu_set_t allowed;
+
+    if (node < 0 || sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        return false;
+
+    snprintf(path, sizeof(path), NODE_SYSFS "/node%d/cpulist", node);
+    if (readList(path, cpus) < 0) {
+        if (node != 0 || QueueAffinity_nodeCount() > 1)
+            return false;
+        *cpus = allowed;
+    }
+    CPU_AND(cpus, cpus, &allowed);
+    return CPU_COUNT(cpus) > 0;
+}
+
+int QueueAffinity_firstCpu(int node) {
+    cpu_set_t cpus;
+    if (!nodeCpus(node, &cpus))
+        return -1;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &cpus))
+            return cpu;
+    }
+    return -1;
+}
+
+bool QueueAffinity_pinToNode(int node) {
+    cpu_set_t cpus;
+    return nodeCpus(node, &cpus)
+        && pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+}
+
+bool QueueAffinity_pinToCpu(int cpu) {
+    cpu_set_t cpus;
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return false;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+}
+
+bool QueueAffinity_runOnNode(int node, void (*fn)(void*), void* arg) {
+    cpu_set_t saved;
+
+    if (pthread_getaffinity_np(pthread_self(), sizeof(saved), &saved) != 0)
+        return false;
+    if (!QueueAffinity_pinToNode(node))
+        return false;
+    fn(arg);
+    pthread_setaffinity_np(pthread_self(), sizeof(saved), &saved);
+    return true;
+}
+
+void QueueAffinity_placeMemory(void* addr, size_t bytes, int node) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)addr, end = start + bytes;
+
+    if (bytes == 0 || node < 0)
+        return;
+
+#ifdef QUEUE_NUMA
+    // mbind works on whole pages, so only bind those lying entirely inside the range
+    uintptr_t first = (start + page - 1) / page * page, last = end / page * page;
+    if (numa_available() >= 0 && node <= numa_max_node() && first < last)
+        numa_tonode_memory((void *)first, last - first, node);
+#endif
+
+    // a write fault allocates the page; writing back what was read leaves the contents alone
+    for (uintptr_t p = start; p < end; p = (p / page + 1) * page) {
+        volatile char *byte = (volatile char *)p;
+        *byte = *byte;
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * QueueAffinity.h
+ *
+ * Module interface for placing queue memory and threads on NUMA nodes.
+ *
+ * Nodes and their CPUs are read from /sys/devices/system/node; a machine without it is
+ * treated as a single node 0 holding every CPU the process may run on. Memory is placed by
+ * first touch: pages are faulted in by a thread pinned to the node, so the kernel allocates
+ * them there. Built with QUEUE_NUMA (and linked with -lnuma) the pages are also bound to the
+ * node with libnuma, which holds even when the node is short of free memory. Pages that were
+ * already faulted in elsewhere are not moved either way.
+ *
+ */
+
+#ifndef QUEUE_AFFINITY_H_
+#define QUEUE_AFFINITY_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Returns the number of NUMA nodes on this machine, at least 1.
+ */
+int QueueAffinity_nodeCount(void);
+
+/*
+ * Returns the lowest CPU of node that the calling process may run on, or -1 if there is none.
+ */
+int QueueAffinity_firstCpu(int node);
+
+/*
+ * Pins the calling thread to the CPUs of node that the process may run on.
+ * Returns true on success and false if node has no such CPUs or the thread cannot be moved.
+ */
+bool QueueAffinity_pinToNode(int node);
+
+/*
+ * Pins the calling thread to a single CPU.
+ * Returns true on success and false if the thread cannot be moved there.
+ */
+bool QueueAffinity_pinToCpu(int cpu);
+
+/*
+ * Calls fn(arg) with the calling thread pinned to node, then lets it run wherever it could
+ * before, so allocations and first touches made by fn land on node.
+ * Returns false without calling fn when the thread cannot be pinned to node.
+ */
+bool QueueAffinity_runOnNode(int node, void (*fn)(void*), void* arg);
+
+/*
+ * Places the bytes at addr on node by binding them there (with QUEUE_NUMA) and faulting
+ * in every page without changing its contents. For first touch to land on node without
+ * QUEUE_NUMA, the calling thread should be pinned to node.
+ */
+void QueueAffinity_placeMemory(void* addr, size_t bytes, int node);
+
+#endif /* QUEUE_AFFINITY_H_ */
@@ -0,0 +1,36 @@
+/*
+ * QueueStats.c
+ *
+ * Per-queue statistics block implementation.
+ *
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include "QueueStats.h"
+
+
+QueueStats *new_QueueStats() {
+    // sizeof(QueueStats) is a multiple of the line, as aligned_alloc needs
+    QueueStats *stats = aligned_alloc(QUEUE_STATS_LINE, sizeof(QueueStats));
+    if (stats == NULL) return NULL;
+
+    atomic_init(&stats->enqs, 0);
+    atomic_init(&stats->deqs, 0);
+    atomic_init(&stats->full, 0);
+    atomic_init(&stats->empty, 0);
+    atomic_init(&stats->high_water, 0);
+    atomic_init(&stats->blocked_ns, 0);
+    atomic_init(&stats->contentions, 0);
+    return stats;
+}
+
+void QueueStats_snapshot(QueueStats* this, QueueStatsSnapshot* out) {
+    out->enqs = atomic_load_explicit(&this->enqs, memory_order_relaxed);
+    out->deqs = atomic_load_explicit(&this->deqs, memory_order_relaxed);
+    out->full = atomic_load_explicit(&this->full, memory_order_relaxed);
+    out->empty = atomic_load_explicit(&this->empty, memory_order_relaxed);
+    out->high_water = atomic_load_explicit(&this->high_water, memory_order_relaxed);
+    out->blocked_ns = atomic_load_explicit(&this->blocked_ns, memory_order_relaxed);
+    out->contentions = atomic_load_explicit(&this->contentions, memory_order_relaxed);
+}
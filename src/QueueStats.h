@@ -0,0 +1,85 @@
+/*
+ * QueueStats.h
+ *
+ * Module interface for opt-in per-queue statistics and contention counters.
+ *
+ * Statistics are compiled in when QUEUE_STATS is defined and then enabled per queue
+ * (see Queue_enableStats and BlockingQueue_enableStats). Counters are relaxed atomics,
+ * so recording costs a branch and an uncontended atomic add on the hot path, and a
+ * snapshot can be taken at any time without locking the queue. When QUEUE_STATS is
+ * not defined, which is the Makefile's default (build with STATS=-DQUEUE_STATS to turn it
+ * on), the recording macros expand to nothing. The queues keep their stats pointer either
+ * way, so objects built with and without it agree on the struct layouts.
+ *
+ */
+
+#ifndef QUEUE_STATS_H_
+#define QUEUE_STATS_H_
+
+#include <stdbool.h>
+#include <stdatomic.h>
+
+typedef struct QueueStats QueueStats;
+typedef struct QueueStatsSnapshot QueueStatsSnapshot;
+
+#define QUEUE_STATS_LINE 64
+
+/*
+ * full and empty count the operations which found the queue full or empty:
+ * rejected for Queue, blocked for BlockingQueue.
+ * enqs and deqs sit on lines of their own, so producers and consumers counting
+ * operations do not bounce one line between them.
+ */
+struct QueueStats {
+    _Alignas(QUEUE_STATS_LINE) atomic_long enqs;
+    _Alignas(QUEUE_STATS_LINE) atomic_long deqs;
+    _Alignas(QUEUE_STATS_LINE) atomic_long full, empty;
+    atomic_long high_water; // largest size seen after an enq
+    atomic_long blocked_ns; // time spent waiting for space or elements
+    atomic_long contentions; // times the queue's mutex was already held
+};
+
+struct QueueStatsSnapshot {
+    long enqs, deqs;
+    long full, empty;
+    long high_water;
+    long blocked_ns;
+    long contentions;
+};
+
+/*
+ * Creates a new zeroed QueueStats block.
+ * Returns a pointer to a new QueueStats on success and NULL on failure.
+ */
+QueueStats* new_QueueStats();
+
+/*
+ * Copies the current counters of this QueueStats into out without blocking.
+ * Each counter is read atomically, but they are not read together.
+ */
+void QueueStats_snapshot(QueueStats* this, QueueStatsSnapshot* out);
+
+/*
+ * Raises counter to value if value is larger.
+ */
+static inline void QueueStats_max(atomic_long* counter, long value) {
+    long current = atomic_load_explicit(counter, memory_order_relaxed);
+    while (value > current &&
+           !atomic_compare_exchange_weak_explicit(counter, &current, value,
+                                                  memory_order_relaxed, memory_order_relaxed))
+        ;
+}
+
+#ifdef QUEUE_STATS
+#define QUEUE_STATS_ADD(stats, field, n) do {\
+        if ((stats) != NULL) atomic_fetch_add_explicit(&(stats)->field, (n), memory_order_relaxed);\
+} while(0)
+#define QUEUE_STATS_MAX(stats, field, value) do {\
+        if ((stats) != NULL) QueueStats_max(&(stats)->field, (value));\
+} while(0)
+#else
+#define QUEUE_STATS_ADD(stats, field, n) do { } while(0)
+#define QUEUE_STATS_MAX(stats, field, value) do { } while(0)
+#endif
+
+#endif /* QUEUE_STATS_H_ */
@@ -0,0 +1,202 @@
+/*
+ * SegmentedQueue.c
+ *
+ * Unbounded generic Queue implementation over linked fixed-size segments.
+ *
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SegmentedQueue.h"
+
+
+// Takes a segment from the free list, or allocates one if it is empty.
+static QueueSegment* takeSegment(SegmentedQueue* this) {
+    QueueSegment *seg = this->free_list;
+
+    if (seg != NULL) {
+        this->free_list = seg->next;
+        this->free_count--;
+    } else {
+        seg = malloc(sizeof(QueueSegment) + this->segment_size * sizeof(void *));
+        if (seg == NULL) return NULL;
+    }
+    seg->next = NULL;
+    seg->head = 0;
+    seg->tail = 0;
+    return seg;
+}
+
+// Returns a drained segment to the free list, or frees it if the list is full.
+static void recycleSegment(SegmentedQueue* this, QueueSegment* seg) {
+    if (this->free_count >= SEGMENTED_QUEUE_MAX_FREE) {
+        free(seg);
+        return;
+    }
+    seg->next = this->free_list;
+    this->free_list = seg;
+    this->free_count++;
+}
+
+SegmentedQueue *new_SegmentedQueue(int segment_size) {
+    if (segment_size <= 0) return NULL;
+
+    SegmentedQueue *Q = malloc(sizeof(SegmentedQueue));
+    if (Q == NULL) return NULL;
+
+    Q->segment_size = segment_size;
+    Q->size = 0;
+    Q->free_list = NULL;
+    Q->free_count = 0;
+    Q->first = takeSegment(Q);
+    if (Q->first == NULL) {
+        free(Q);
+        return NULL;
+    }
+    Q->last = Q->first;
+    return Q;
+}
+
+/*
+ * Makes sure the last segment has room for at least one element.
+ * Returns false if a new segment was needed and could not be allocated.
+ */
+static bool reserve(SegmentedQueue* this) {
+    if (this->last->head < this->segment_size)
+        return true;
+
+    QueueSegment *seg = takeSegment(this);
+    if (seg == NULL)
+        return false;
+    this->last->next = seg;
+    this->last = seg;
+    return true;
+}
+
+/*
+ * Moves past the first segment once it has been fully read.
+ * The only segment is rewound in place instead, so an idle queue keeps one segment.
+ */
+static void advance(SegmentedQueue* this) {
+    QueueSegment *seg = this->first;
+
+    if (seg->tail < seg->head)
+        return;
+    if (seg->next == NULL) {
+        seg->head = 0;
+        seg->tail = 0;
+        return;
+    }
+    if (seg->tail < this->segment_size)
+        return;
+
+    this->first = seg->next;
+    recycleSegment(this, seg);
+}
+
+bool SegmentedQueue_enq(SegmentedQueue* this, void* element) {
+    if (element == NULL || !reserve(this))
+        return false;
+
+    this->last->data[this->last->head++] = element;
+    this->size++;
+    return true;
+}
+
+void* SegmentedQueue_deq(SegmentedQueue* this) {
+    void *elem;
+
+    if (this->size == 0)
+        return NULL;
+
+    elem = this->first->data[this->first->tail++];
+    this->size--;
+    advance(this);
+    return elem;
+}
+
+int SegmentedQueue_enqMany(SegmentedQueue* this, void** elements, int count) {
+    int done = 0;
+
+    while (done < count && reserve(this)) {
+        QueueSegment *seg = this->last;
+        int n = this->segment_size - seg->head;
+        if (n > count - done)
+            n = count - done;
+        for (int i = 0; i < n; i++) { // NULL is never stored, so stop short of the first one
+            if (elements[done + i] == NULL) {
+                count = done + i;
+                n = i;
+                break;
+            }
+        }
+
+        memcpy(&seg->data[seg->head], elements + done, n * sizeof(void *));
+        seg->head += n;
+        this->size += n;
+        done += n;
+    }
+    return done;
+}
+
+int SegmentedQueue_deqMany(SegmentedQueue* this, void** out, int max) {
+    int done = 0;
+
+    while (done < max && this->size > 0) {
+        QueueSegment *seg = this->first;
+        int n = seg->head - seg->tail;
+        if (n > max - done)
+            n = max - done;
+
+        memcpy(out + done, &seg->data[seg->tail], n * sizeof(void *));
+        seg->tail += n;
+        this->size -= n;
+        done += n;
+        advance(this);
+    }
+    return done;
+}
+
+int SegmentedQueue_size(SegmentedQueue* this) {
+    return this->size;
+}
+
+bool SegmentedQueue_isEmpty(SegmentedQueue* this) {
+    return this->size == 0;
+}
+
+void SegmentedQueue_clear(SegmentedQueue* this) {
+    if(this) {
+        QueueSegment *seg = this->first->next;
+        while (seg != NULL) {
+            QueueSegment *next = seg->next;
+            recycleSegment(this, seg);
+            seg = next;
+        }
+        this->first->next = NULL;
+        this->first->head = 0;
+        this->first->tail = 0;
+        this->last = this->first;
+        this->size = 0;
+    }
+}
+
+void SegmentedQueue_destroy(SegmentedQueue* this) {
+    if(this) {
+        QueueSegment *seg = this->first;
+        while (seg != NULL) {
+            QueueSegment *next = seg->next;
+            free(seg);
+            seg = next;
+        }
+        seg = this->free_list;
+        while (seg != NULL) {
+            QueueSegment *next = seg->next;
+            free(seg);
+            seg = next;
+        }
+        free(this);
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ * SegmentedQueue.h
+ *
+ * Module interface for a generic unbounded Queue built from linked fixed-size segments.
+ *
+ * Elements are written to the last segment and read from the first. When the last
+ * segment fills up a new one is linked on, so growing never copies queued elements.
+ * Drained segments are kept on a small per-queue free list and reused, so a queue
+ * in steady state does no allocation.
+ *
+ */
+
+#ifndef SEGMENTED_QUEUE_H_
+#define SEGMENTED_QUEUE_H_
+
+#include <stdbool.h>
+
+#define SEGMENTED_QUEUE_MAX_FREE 4 // drained segments kept for reuse
+
+typedef struct QueueSegment QueueSegment;
+typedef struct SegmentedQueue SegmentedQueue;
+
+struct QueueSegment {
+    QueueSegment* next;
+    int head, tail; // write and read index within data
+    void* data[];
+};
+
+struct SegmentedQueue {
+    QueueSegment *first, *last; // read from first, write to last
+    QueueSegment* free_list;
+    int segment_size, size, free_count;
+};
+
+/*
+ * Creates a new empty SegmentedQueue which grows segment_size void* elements at a time.
+ * Returns a pointer to a new SegmentedQueue on success and NULL on failure.
+ */
+SegmentedQueue* new_SegmentedQueue(int segment_size);
+
+/*
+ * Enqueues the given void* element at the back of this Queue, adding a segment if needed.
+ * Returns true on success and false on enq failure when element is NULL or out of memory.
+ */
+bool SegmentedQueue_enq(SegmentedQueue* this, void* element);
+
+/*
+ * Dequeues an element from the front of this Queue.
+ * Returns dequeued void* element on success or NULL if queue is empty.
+ */
+void* SegmentedQueue_deq(SegmentedQueue* this);
+
+/*
+ * Enqueues up to count void* elements from the elements array at the back of this Queue, in order.
+ * Stops early at the first NULL element or when out of memory.
+ * Returns the number of elements enqueued.
+ */
+int SegmentedQueue_enqMany(SegmentedQueue* this, void** elements, int count);
+
+/*
+ * Dequeues up to max elements from the front of this Queue into the out array, in order.
+ * Returns the number of elements dequeued, which is 0 if the queue is empty.
+ */
+int SegmentedQueue_deqMany(SegmentedQueue* this, void** out, int max);
+
+/*
+ * Returns the number of elements currently in this Queue.
+ */
+int SegmentedQueue_size(SegmentedQueue* this);
+
+/*
+ * Returns true if this Queue is empty, false otherwise.
+ */
+bool SegmentedQueue_isEmpty(SegmentedQueue* this);
+
+/*
+ * Clears this Queue returning it to an empty state.
+ * Segments beyond the first are moved to the free list or freed.
+ */
+void SegmentedQueue_clear(SegmentedQueue* this);
+
+/*
+ * Destroys this Queue by freeing the memory used by the Queue and its free list.
+ */
+void SegmentedQueue_destroy(SegmentedQueue* this);
+
+#endif /* SEGMENTED_QUEUE_H_ */
@@ -0,0 +1,176 @@
+/*
+ * ShardedBlockingQueue.c
+ *
+ * Fixed-size generic BlockingQueue implementation over per-thread home shards with stealing.
+ *
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "ShardedBlockingQueue.h"
+
+/*
+ * Hands each thread a slot the first time it uses any ShardedBlockingQueue; a thread's home
+ * shard is its slot modulo the shard count, which spreads threads evenly over the shards
+ */
+static atomic_uint next_slot = 0;
+static _Thread_local int thread_slot = -1;
+
+
+ShardedBlockingQueue *new_ShardedBlockingQueue(int max_size, int shard_count) {
+    if (max_size <= 0 || shard_count <= 0) return NULL;
+
+    // aligned_alloc needs a size that is a multiple of the alignment
+    size_t bytes = (sizeof(ShardedBlockingQueue) + SHARD_CACHE_LINE - 1) / SHARD_CACHE_LINE * SHARD_CACHE_LINE;
+    ShardedBlockingQueue *sQueue = aligned_alloc(SHARD_CACHE_LINE, bytes);
+    if (sQueue == NULL) return NULL;
+
+    // sizeof(QueueShard) is already a multiple of the cache line
+    sQueue->shards = aligned_alloc(SHARD_CACHE_LINE, shard_count * sizeof(QueueShard));
+    if (sQueue->shards == NULL) {
+        free(sQueue);
+        return NULL;
+    }
+
+    if (shard_count > max_size) shard_count = max_size; // no shard may be empty
+    sQueue->shard_count = shard_count;
+    for (int i = 0; i < shard_count; i++) {
+        QueueShard *shard = &sQueue->shards[i];
+        // spread the remainder over the first shards, so together they hold exactly max_size
+        shard->capacity = max_size / shard_count + (i < max_size % shard_count);
+        shard->queue = new_Queue(shard->capacity);
+        if (shard->queue == NULL) {
+            sQueue->shard_count = i;
+            ShardedBlockingQueue_destroy(sQueue);
+            return NULL;
+        }
+        pthread_mutex_init(&shard->mutex, NULL);
+        atomic_init(&shard->size, 0);
+    }
+
+    EventCount_init(&sQueue->not_full, EVENT_COUNT_DEFAULT_SPIN);
+    EventCount_init(&sQueue->not_empty, EVENT_COUNT_DEFAULT_SPIN);
+    return sQueue;
+}
+
+static int homeShard(ShardedBlockingQueue* this) {
+    if (thread_slot < 0)
+        thread_slot = atomic_fetch_add(&next_slot, 1) & 0x7fffffff;
+    return thread_slot % this->shard_count;
+}
+
+/*
+ * Moves an element into the first shard with room, going once round from home.
+ * Returns false if every shard was full.
+ */
+static bool shardEnq(ShardedBlockingQueue* this, void* element, int home) {
+    for (int n = 0, i = home; n < this->shard_count; n++, i = (i + 1) % this->shard_count) {
+        QueueShard *shard = &this->shards[i];
+        if (atomic_load_explicit(&shard->size, memory_order_relaxed) >= shard->capacity)
+            continue;
+
+        pthread_mutex_lock(&shard->mutex);
+        bool done = Queue_enq(shard->queue, element);
+        if (done)
+            atomic_fetch_add_explicit(&shard->size, 1, memory_order_relaxed);
+        pthread_mutex_unlock(&shard->mutex);
+        if (done)
+            return true;
+    }
+    return false;
+}
+
+/*
+ * Takes an element from the first non-empty shard, going once round from home.
+ * Returns NULL if every shard was empty.
+ */
+static void* shardDeq(ShardedBlockingQueue* this, int home) {
+    for (int n = 0, i = home; n < this->shard_count; n++, i = (i + 1) % this->shard_count) {
+        QueueShard *shard = &this->shards[i];
+        if (atomic_load_explicit(&shard->size, memory_order_relaxed) == 0)
+            continue;
+
+        pthread_mutex_lock(&shard->mutex);
+        void *element = Queue_deq(shard->queue);
+        if (element != NULL)
+            atomic_fetch_sub_explicit(&shard->size, 1, memory_order_relaxed);
+        pthread_mutex_unlock(&shard->mutex);
+        if (element != NULL)
+            return element;
+    }
+    return NULL;
+}
+
+static bool hasRoom(void* arg) {
+    ShardedBlockingQueue *this = arg;
+
+    for (int i = 0; i < this->shard_count; i++) {
+        if (atomic_load(&this->shards[i].size) < this->shards[i].capacity)
+            return true;
+    }
+    return false;
+}
+
+static bool hasElements(void* arg) {
+    return !ShardedBlockingQueue_isEmpty(arg);
+}
+
+bool ShardedBlockingQueue_enq(ShardedBlockingQueue* this, void* element) {
+    if (element == NULL)
+        return false;
+
+    int home = homeShard(this);
+    while (!shardEnq(this, element, home))
+        EventCount_await(&(this->not_full), hasRoom, this); // Wait for space in the queue
+    EventCount_notify(&(this->not_empty), 1); // Signal that there is an element in the queue
+    return true;
+}
+
+void* ShardedBlockingQueue_deq(ShardedBlockingQueue* this) {
+    int home = homeShard(this);
+    void *element;
+
+    while ((element = shardDeq(this, home)) == NULL)
+        EventCount_await(&(this->not_empty), hasElements, this); // Wait for an element in the queue
+    EventCount_notify(&(this->not_full), 1); // Signal that there is space in the queue
+    return element;
+}
+
+int ShardedBlockingQueue_size(ShardedBlockingQueue* this) {
+    int size = 0;
+
+    for (int i = 0; i < this->shard_count; i++)
+        size += atomic_load(&this->shards[i].size);
+    return size;
+}
+
+bool ShardedBlockingQueue_isEmpty(ShardedBlockingQueue* this) {
+    return ShardedBlockingQueue_size(this) == 0;
+}
+
+void ShardedBlockingQueue_clear(ShardedBlockingQueue* this) {
+    bool cleared = false;
+
+    for (int i = 0; i < this->shard_count; i++) {
+        QueueShard *shard = &this->shards[i];
+        pthread_mutex_lock(&shard->mutex);
+        cleared = cleared || atomic_load_explicit(&shard->size, memory_order_relaxed) > 0;
+        Queue_clear(shard->queue);
+        atomic_store_explicit(&shard->size, 0, memory_order_relaxed);
+        pthread_mutex_unlock(&shard->mutex);
+    }
+    if (cleared)
+        EventCount_notify(&(this->not_full), 0);
+}
+
+void ShardedBlockingQueue_destroy(ShardedBlockingQueue* this) {
+    if(this) {
+        for (int i = 0; i < this->shard_count; i++) {
+            pthread_mutex_destroy(&this->shards[i].mutex);
+            Queue_destroy(this->shards[i].queue);
+        }
+        free(this->shards);
+        free(this);
+    }
+}
@@ -0,0 +1,94 @@
+/*
+ * ShardedBlockingQueue.h
+ *
+ * Module interface for a generic fixed-size Blocking Queue split over several locked shards.
+ *
+ * Each shard is a Queue with its own mutex on its own cache line. A thread enqueues to and
+ * dequeues from its home shard, picked once per thread, and only moves on to the other
+ * shards when its home shard is full or empty. Elements keep FIFO order within a shard but
+ * not across shards.
+ *
+ * Each shard counts its own elements, so an enq or deq that finds room or an element on its
+ * way round the shards touches nothing shared but the shard's line and the waiter count of
+ * an eventcount. Only a thread that finds every shard full or empty parks on not_full or
+ * not_empty, spinning and then sleeping there instead of rescanning the shards.
+ *
+ */
+
+#ifndef SHARDED_BLOCKING_QUEUE_H_
+#define SHARDED_BLOCKING_QUEUE_H_
+
+#include <stdbool.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "Queue.h"
+#include "EventCount.h"
+
+#define SHARD_CACHE_LINE 64
+
+typedef struct QueueShard QueueShard;
+typedef struct ShardedBlockingQueue ShardedBlockingQueue;
+
+struct QueueShard {
+    _Alignas(SHARD_CACHE_LINE) pthread_mutex_t mutex;
+    Queue* queue;
+    int capacity;
+    atomic_int size; // written with the mutex held, readable without it to skip empty or full shards
+};
+
+struct ShardedBlockingQueue {
+    QueueShard* shards;
+    int shard_count;
+
+    // parked on only once a scan finds every shard full or empty
+    _Alignas(SHARD_CACHE_LINE) EventCount not_full;
+    _Alignas(SHARD_CACHE_LINE) EventCount not_empty;
+};
+
+/*
+ * Creates a new ShardedBlockingQueue for at most max_size void* elements over shard_count shards,
+ * or over max_size shards of one element each when shard_count is larger.
+ * Returns a pointer to a new ShardedBlockingQueue on success and NULL on failure.
+ */
+ShardedBlockingQueue* new_ShardedBlockingQueue(int max_size, int shard_count);
+
+/*
+ * Enqueues the given void* element at the back of the calling thread's home shard, or of
+ * the next shard with room if that one is full.
+ * If the queue is full, the function will block the calling thread until there is space in the queue.
+ * Returns false when element is NULL and true on success.
+ */
+bool ShardedBlockingQueue_enq(ShardedBlockingQueue* this, void* element);
+
+/*
+ * Dequeues an element from the front of the calling thread's home shard, or steals one from
+ * the next non-empty shard if that one is empty.
+ * If the queue is empty, the function will block until an element can be dequeued.
+ * Returns the dequeued void* element.
+ */
+void* ShardedBlockingQueue_deq(ShardedBlockingQueue* this);
+
+/*
+ * Returns the number of elements currently in this Queue without taking any shard's lock.
+ * The result is only a snapshot when other threads are using the queue.
+ */
+int ShardedBlockingQueue_size(ShardedBlockingQueue* this);
+
+/*
+ * Returns true if this Queue is empty, false otherwise.
+ * The result is only a snapshot when other threads are using the queue.
+ */
+bool ShardedBlockingQueue_isEmpty(ShardedBlockingQueue* this);
+
+/*
+ * Clears this Queue returning it to an empty state.
+ */
+void ShardedBlockingQueue_clear(ShardedBlockingQueue* this);
+
+/*
+ * Destroys this Queue by freeing the memory used by the Queue.
+ */
+void ShardedBlockingQueue_destroy(ShardedBlockingQueue* this);
+
+#endif /* SHARDED_BLOCKING_QUEUE_H_ */
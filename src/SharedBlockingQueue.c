@@ -0,0 +1,216 @@
+/*
+ * SharedBlockingQueue.c
+ *
+ * Fixed-size BlockingQueue implementation in a named POSIX shared memory region.
+ *
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "SharedBlockingQueue.h"
+
+#define SHARED_QUEUE_ALIGN 64 // slots start on a cache line of their own
+
+
+/*
+ * Maps bytes of the region open on fd and wraps it in a new handle.
+ * Returns NULL on failure.
+ */
+static SharedBlockingQueue* mapRegion(int fd, size_t bytes) {
+    SharedBlockingQueue *sQueue = malloc(sizeof(SharedBlockingQueue));
+    if (sQueue == NULL) return NULL;
+
+    void *region = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (region == MAP_FAILED) {
+        free(sQueue);
+        return NULL;
+    }
+    sQueue->header = region;
+    sQueue->bytes = bytes;
+    sQueue->data = NULL;
+    return sQueue;
+}
+
+SharedBlockingQueue *new_SharedBlockingQueue(const char* name, int max_size, size_t elem_size) {
+    // head and tail count up to 2 * max_size in an int
+    if (max_size <= 0 || max_size > INT_MAX / 2 || elem_size == 0) return NULL;
+
+    size_t data_offset = (sizeof(SharedQueueHeader) + SHARED_QUEUE_ALIGN - 1) / SHARED_QUEUE_ALIGN * SHARED_QUEUE_ALIGN;
+    size_t bytes = data_offset + (size_t)max_size * elem_size;
+
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return NULL;
+
+    SharedBlockingQueue *sQueue = NULL;
+    if (ftruncate(fd, bytes) == 0)
+        sQueue = mapRegion(fd, bytes);
+    close(fd);
+    if (sQueue == NULL) {
+        shm_unlink(name);
+        return NULL;
+    }
+
+    SharedQueueHeader *h = sQueue->header;
+    h->elem_size = elem_size;
+    h->data_offset = data_offset;
+    h->max_size = max_size;
+    atomic_init(&h->head, 0); // write index
+    atomic_init(&h->tail, 0); // read index
+
+    // robust, so a process dying inside a critical section does not leave the mutex held forever
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&h->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    EventCount_initShared(&h->not_full, EVENT_COUNT_DEFAULT_SPIN);
+    EventCount_initShared(&h->not_empty, EVENT_COUNT_DEFAULT_SPIN);
+
+    sQueue->data = (char *)h + data_offset;
+    atomic_store(&h->magic, SHARED_QUEUE_MAGIC); // publish to attaching processes last
+    return sQueue;
+}
+
+SharedBlockingQueue *SharedBlockingQueue_attach(const char* name) {
+    struct stat st;
+
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return NULL;
+
+    SharedBlockingQueue *sQueue = NULL;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(SharedQueueHeader))
+        sQueue = mapRegion(fd, st.st_size);
+    close(fd);
+    if (sQueue == NULL) return NULL;
+
+    // the creator may not have finished initialising the region, or it may not be a queue at all
+    SharedQueueHeader *h = sQueue->header;
+    if (atomic_load(&h->magic) != SHARED_QUEUE_MAGIC
+            || h->max_size <= 0 || h->max_size > INT_MAX / 2
+            || h->data_offset + (size_t)h->max_size * h->elem_size > sQueue->bytes) {
+        SharedBlockingQueue_destroy(sQueue);
+        return NULL;
+    }
+    sQueue->data = (char *)h + h->data_offset;
+    return sQueue;
+}
+
+/*
+ * Takes the mutex, recovering it if its previous owner died while holding it.
+ * The ring is consistent at every point of a critical section, but the owner may have
+ * committed an enq or deq and died before signalling it, so every waiter is woken to look.
+ */
+static void lockRegion(SharedQueueHeader* h) {
+    if (pthread_mutex_lock(&h->mutex) == EOWNERDEAD) {
+        pthread_mutex_consistent(&h->mutex);
+        EventCount_notify(&h->not_full, 0);
+        EventCount_notify(&h->not_empty, 0);
+    }
+}
+
+static int regionSize(SharedQueueHeader* h) {
+    int size = atomic_load(&h->head) - atomic_load(&h->tail);
+    return size < 0 ? size + 2 * h->max_size : size;
+}
+
+static int nextIndex(SharedQueueHeader* h, int index) {
+    return index + 1 == 2 * h->max_size ? 0 : index + 1;
+}
+
+static char* slotAt(SharedBlockingQueue* this, int index) {
+    SharedQueueHeader *h = this->header;
+    return this->data + (size_t)(index % h->max_size) * h->elem_size;
+}
+
+static bool hasRoom(void* h) {
+    return regionSize(h) < ((SharedQueueHeader *)h)->max_size;
+}
+
+static bool hasElements(void* h) {
+    return regionSize(h) > 0;
+}
+
+bool SharedBlockingQueue_enq(SharedBlockingQueue* this, const void* element) {
+    SharedQueueHeader *h = this->header;
+
+    if (element == NULL)
+        return false;
+
+    lockRegion(h);
+    while (!hasRoom(h)) {
+        pthread_mutex_unlock(&h->mutex);
+        EventCount_await(&h->not_full, hasRoom, h); // Wait for space in the queue
+        lockRegion(h);
+    }
+    int head = atomic_load_explicit(&h->head, memory_order_relaxed);
+    memcpy(slotAt(this, head), element, h->elem_size);
+    atomic_store(&h->head, nextIndex(h, head)); // commits the element
+    pthread_mutex_unlock(&h->mutex);
+
+    EventCount_notify(&h->not_empty, 1); // Signal that there is an element in the queue
+    return true;
+}
+
+bool SharedBlockingQueue_deq(SharedBlockingQueue* this, void* out) {
+    SharedQueueHeader *h = this->header;
+
+    lockRegion(h);
+    while (!hasElements(h)) {
+        pthread_mutex_unlock(&h->mutex);
+        EventCount_await(&h->not_empty, hasElements, h); // Wait for an element in the queue
+        lockRegion(h);
+    }
+    int tail = atomic_load_explicit(&h->tail, memory_order_relaxed);
+    if (out != NULL)
+        memcpy(out, slotAt(this, tail), h->elem_size);
+    atomic_store(&h->tail, nextIndex(h, tail)); // frees the slot
+    pthread_mutex_unlock(&h->mutex);
+
+    EventCount_notify(&h->not_full, 1); // Signal that there is space in the queue
+    return true;
+}
+
+size_t SharedBlockingQueue_elemSize(SharedBlockingQueue* this) {
+    return this->header->elem_size;
+}
+
+int SharedBlockingQueue_size(SharedBlockingQueue* this) {
+    return regionSize(this->header);
+}
+
+bool SharedBlockingQueue_isEmpty(SharedBlockingQueue* this) {
+    return SharedBlockingQueue_size(this) == 0;
+}
+
+void SharedBlockingQueue_clear(SharedBlockingQueue* this) {
+    SharedQueueHeader *h = this->header;
+
+    lockRegion(h);
+    bool cleared = hasElements(h);
+    atomic_store(&h->tail, atomic_load_explicit(&h->head, memory_order_relaxed));
+    pthread_mutex_unlock(&h->mutex);
+
+    if (cleared)
+        EventCount_notify(&h->not_full, 0);
+}
+
+void SharedBlockingQueue_destroy(SharedBlockingQueue* this) {
+    if(this) {
+        munmap(this->header, this->bytes);
+        free(this);
+    }
+}
+
+bool SharedBlockingQueue_unlink(const char* name) {
+    return shm_unlink(name) == 0;
+}
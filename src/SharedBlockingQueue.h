@@ -0,0 +1,123 @@
+/*
+ * SharedBlockingQueue.h
+ *
+ * Module interface for a fixed-size Blocking Queue shared between processes through a named
+ * POSIX shared memory region.
+ *
+ * Pointers mean nothing in another process, so elements are copied by value into slots
+ * inside the region and located by offset from its start; the mutex is process-shared and
+ * the eventcounts wait on shared futexes. One process creates the queue by name and any
+ * other can attach to it, each getting its own handle onto the same mapping.
+ *
+ * The mutex is robust, so a process dying while it holds it does not hang the others. The whole
+ * state of the queue is head and tail, and an enq or deq commits with a single store to one of
+ * them after copying its slot, so whatever point the owner died at, the ring is left holding
+ * exactly the elements it committed. The next process to take the mutex marks it consistent and
+ * wakes every waiter, in case the dead owner committed without signalling. An element the dead
+ * process was copying out of the ring, or into it, is lost to it alone.
+ *
+ */
+
+#ifndef SHARED_BLOCKING_QUEUE_H_
+#define SHARED_BLOCKING_QUEUE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "EventCount.h"
+
+#define SHARED_QUEUE_MAGIC 0x53425131u // "SBQ1", set once the creator has initialised the region
+
+typedef struct SharedQueueHeader SharedQueueHeader;
+typedef struct SharedBlockingQueue SharedBlockingQueue;
+
+/*
+ * The start of the shared region, followed by max_size slots of elem_size bytes at data_offset
+ */
+struct SharedQueueHeader {
+    atomic_uint magic;
+    size_t elem_size, data_offset;
+    int max_size;
+
+    // head and tail run from 0 to 2 * max_size - 1, so a full ring and an empty one differ,
+    // and the slot is the index modulo max_size. Written with the mutex held, readable without it.
+    pthread_mutex_t mutex;
+    atomic_int head, tail;
+    EventCount not_full, not_empty;
+};
+
+/*
+ * A process's handle onto a shared region
+ */
+struct SharedBlockingQueue {
+    SharedQueueHeader* header;
+    char* data;
+    size_t bytes; // length of the mapping
+};
+
+/*
+ * Creates a new shared memory region called name (as for shm_open, e.g. "/ingest") holding a
+ * SharedBlockingQueue for at most max_size elements of elem_size bytes each.
+ * Fails if a region with that name already exists, or if max_size exceeds INT_MAX / 2.
+ * Returns a pointer to a new SharedBlockingQueue on success and NULL on failure.
+ */
+SharedBlockingQueue* new_SharedBlockingQueue(const char* name, int max_size, size_t elem_size);
+
+/*
+ * Attaches to the SharedBlockingQueue another process created as name.
+ * Returns a pointer to a new handle on success and NULL if no initialised queue has that name.
+ */
+SharedBlockingQueue* SharedBlockingQueue_attach(const char* name);
+
+/*
+ * Copies the elem_size bytes at element to the back of this Queue.
+ * If the queue is full, the function will block the calling thread until there is space in the queue.
+ * Returns false when element is NULL and true on success.
+ */
+bool SharedBlockingQueue_enq(SharedBlockingQueue* this, const void* element);
+
+/*
+ * Dequeues the element at the front of this Queue, copying its elem_size bytes to out.
+ * out may be NULL to discard the element.
+ * If the queue is empty, the function will block until an element can be dequeued.
+ * Returns true once an element has been dequeued.
+ */
+bool SharedBlockingQueue_deq(SharedBlockingQueue* this, void* out);
+
+/*
+ * Returns the size in bytes of each element in this Queue.
+ */
+size_t SharedBlockingQueue_elemSize(SharedBlockingQueue* this);
+
+/*
+ * Returns the number of elements currently in this Queue without taking the mutex.
+ * The result is only a snapshot when other threads or processes are using the queue.
+ */
+int SharedBlockingQueue_size(SharedBlockingQueue* this);
+
+/*
+ * Returns true if this Queue is empty, false otherwise.
+ * The result is only a snapshot when other threads or processes are using the queue.
+ */
+bool SharedBlockingQueue_isEmpty(SharedBlockingQueue* this);
+
+/*
+ * Clears this Queue returning it to an empty state.
+ */
+void SharedBlockingQueue_clear(SharedBlockingQueue* this);
+
+/*
+ * Unmaps this handle and frees the memory used by it. The queue itself lives on in the
+ * shared region until it is unlinked and every process has destroyed its handle.
+ */
+void SharedBlockingQueue_destroy(SharedBlockingQueue* this);
+
+/*
+ * Removes the name of the shared region so no further process can attach to it.
+ * Returns true on success and false if no region has that name.
+ */
+bool SharedBlockingQueue_unlink(const char* name);
+
+#endif /* SHARED_BLOCKING_QUEUE_H_ */
@@ -0,0 +1,173 @@
+/*
+ * SpillQueue.c
+ *
+ * Fixed-size value Queue implementation which overflows to memory-mapped segment files.
+ *
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "SpillQueue.h"
+
+
+SpillQueue *new_SpillQueue(int max_size, size_t elem_size, const char* dir, int segment_size) {
+    if (dir == NULL || segment_size <= 0) return NULL;
+
+    SpillQueue *Q = malloc(sizeof(SpillQueue));
+    if (Q == NULL) return NULL;
+
+    Q->memory = new_ValueQueue(max_size, elem_size);
+    Q->dir = strdup(dir);
+    if (Q->memory == NULL || Q->dir == NULL) {
+        ValueQueue_destroy(Q->memory);
+        free(Q->dir);
+        free(Q);
+        return NULL;
+    }
+    Q->first = NULL;
+    Q->last = NULL;
+    Q->elem_size = elem_size;
+    Q->segment_size = segment_size;
+    Q->spilled = 0;
+    return Q;
+}
+
+static size_t segmentBytes(SpillQueue* this) {
+    return (size_t)this->segment_size * this->elem_size;
+}
+
+/*
+ * Creates and maps a new segment file. The file is unlinked straight away, so its space
+ * is reclaimed by the unmap once the segment is consumed, or if the process dies.
+ * The blocks are allocated up front: a sparse file would only fail to grow when a store
+ * into the mapping faulted, raising SIGBUS, instead of failing here on a full disk.
+ * Returns NULL on failure.
+ */
+static SpillSegment* newSegment(SpillQueue* this) {
+    size_t bytes = segmentBytes(this);
+    char path[strlen(this->dir) + sizeof("/spillqueue-XXXXXX")];
+
+    SpillSegment *s = malloc(sizeof(SpillSegment));
+    if (s == NULL) return NULL;
+
+    snprintf(path, sizeof(path), "%s/spillqueue-XXXXXX", this->dir);
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        free(s);
+        return NULL;
+    }
+    unlink(path);
+
+    s->data = MAP_FAILED;
+    if (posix_fallocate(fd, 0, bytes) == 0)
+        s->data = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (s->data == MAP_FAILED) {
+        free(s);
+        return NULL;
+    }
+
+    s->next = NULL;
+    s->written = 0;
+    s->read = 0;
+    return s;
+}
+
+static void freeSegment(SpillQueue* this, SpillSegment* s) {
+    munmap(s->data, segmentBytes(this));
+    free(s);
+}
+
+/*
+ * Appends element to the last segment file, adding a segment when it is full.
+ */
+static bool spill(SpillQueue* this, const void* element) {
+    if (this->last == NULL || this->last->written == this->segment_size) {
+        SpillSegment *s = newSegment(this);
+        if (s == NULL)
+            return false;
+        if (this->last == NULL)
+            this->first = s;
+        else
+            this->last->next = s;
+        this->last = s;
+    }
+
+    SpillSegment *s = this->last;
+    memcpy(s->data + (size_t)s->written++ * this->elem_size, element, this->elem_size);
+    this->spilled++;
+    return true;
+}
+
+/*
+ * Pages the oldest spilled element into the in-memory queue, which must have room,
+ * reclaiming its segment once it has been read in full.
+ */
+static void pageIn(SpillQueue* this) {
+    SpillSegment *s = this->first;
+
+    ValueQueue_enq(this->memory, s->data + (size_t)s->read++ * this->elem_size);
+    this->spilled--;
+    if (s->read == s->written) {
+        this->first = s->next;
+        if (this->first == NULL)
+            this->last = NULL;
+        freeSegment(this, s);
+    }
+}
+
+bool SpillQueue_enq(SpillQueue* this, const void* element) {
+    if (element == NULL)
+        return false;
+
+    // anything spilled is older than element, so element must queue behind it on disk
+    if (this->spilled == 0 && ValueQueue_enq(this->memory, element))
+        return true;
+    return spill(this, element);
+}
+
+bool SpillQueue_deq(SpillQueue* this, void* out) {
+    if (!ValueQueue_deq(this->memory, out))
+        return false;
+
+    if (this->spilled > 0)
+        pageIn(this);
+    return true;
+}
+
+int SpillQueue_size(SpillQueue* this) {
+    return ValueQueue_size(this->memory) + this->spilled;
+}
+
+int SpillQueue_spilledSize(SpillQueue* this) {
+    return this->spilled;
+}
+
+bool SpillQueue_isEmpty(SpillQueue* this) {
+    return SpillQueue_size(this) == 0;
+}
+
+void SpillQueue_clear(SpillQueue* this) {
+    ValueQueue_clear(this->memory);
+    while (this->first != NULL) {
+        SpillSegment *next = this->first->next;
+        freeSegment(this, this->first);
+        this->first = next;
+    }
+    this->last = NULL;
+    this->spilled = 0;
+}
+
+void SpillQueue_destroy(SpillQueue* this) {
+    if(this) {
+        SpillQueue_clear(this);
+        ValueQueue_destroy(this->memory);
+        free(this->dir);
+        free(this);
+    }
+}
@@ -0,0 +1,90 @@
+/*
+ * SpillQueue.h
+ *
+ * Module interface for a Queue of fixed-size elements which spills to disk when full.
+ *
+ * Elements are copied into an in-memory ValueQueue while it has room. Once it is full, new
+ * elements are appended to memory-mapped segment files instead, and keep going there until
+ * every spilled element has been paged back into memory, so FIFO order holds across both.
+ * Each deq refills the freed slot from the oldest segment, and a segment's file is unmapped
+ * and its space reclaimed as soon as it has been read in full. While nothing is spilled,
+ * enq and deq never touch the disk.
+ *
+ */
+
+#ifndef SPILL_QUEUE_H_
+#define SPILL_QUEUE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "ValueQueue.h"
+
+typedef struct SpillSegment SpillSegment;
+typedef struct SpillQueue SpillQueue;
+
+/*
+ * One mapped segment file holding up to segment_size elements, appended to and read in order
+ */
+struct SpillSegment {
+    SpillSegment* next;
+    char* data;
+    int written, read;
+};
+
+struct SpillQueue {
+    ValueQueue* memory;
+    SpillSegment *first, *last; // read from first, append to last
+    char* dir;
+    size_t elem_size;
+    int segment_size, spilled;
+};
+
+/*
+ * Creates a new SpillQueue holding max_size elements of elem_size bytes each in memory, and
+ * spilling any more to files of segment_size elements each created in the directory dir.
+ * Returns a pointer to a new SpillQueue on success and NULL on failure.
+ */
+SpillQueue* new_SpillQueue(int max_size, size_t elem_size, const char* dir, int segment_size);
+
+/*
+ * Copies the elem_size bytes at element to the back of this Queue, spilling it to disk if
+ * the in-memory part is full or earlier elements are already spilled.
+ * Returns true on success and false on enq failure when element is NULL or a segment file
+ * cannot be created or its space allocated on disk.
+ */
+bool SpillQueue_enq(SpillQueue* this, const void* element);
+
+/*
+ * Dequeues the element at the front of this Queue, copying its elem_size bytes to out.
+ * out may be NULL to discard the element.
+ * Returns true on success or false if queue is empty.
+ */
+bool SpillQueue_deq(SpillQueue* this, void* out);
+
+/*
+ * Returns the number of elements currently in this Queue, in memory and on disk.
+ */
+int SpillQueue_size(SpillQueue* this);
+
+/*
+ * Returns the number of elements currently spilled to disk.
+ */
+int SpillQueue_spilledSize(SpillQueue* this);
+
+/*
+ * Returns true if this Queue is empty, false otherwise.
+ */
+bool SpillQueue_isEmpty(SpillQueue* this);
+
+/*
+ * Clears this Queue returning it to an empty state and reclaiming every segment file.
+ */
+void SpillQueue_clear(SpillQueue* this);
+
+/*
+ * Destroys this Queue by freeing the memory and segment files used by the Queue.
+ */
+void SpillQueue_destroy(SpillQueue* this);
+
+#endif /* SPILL_QUEUE_H_ */
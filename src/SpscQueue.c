@@ -0,0 +1,184 @@
+/*
+ * SpscQueue.c
+ *
+ * Fixed-size generic array-based lock-free single-producer/single-consumer Queue implementation.
+ *
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include "SpscQueue.h"
+
+#define SPSC_SPIN_LIMIT 64 // tries before a blocking call parks on its condition variable
+
+
+SpscQueue *new_SpscQueue(int max_size) {
+    // aligned_alloc needs a size that is a multiple of the alignment
+    size_t bytes = (sizeof(SpscQueue) + SPSC_CACHE_LINE - 1) / SPSC_CACHE_LINE * SPSC_CACHE_LINE;
+    SpscQueue *Q = aligned_alloc(SPSC_CACHE_LINE, bytes);
+    if (Q == NULL) return NULL;
+
+    Q->max_size = max_size+1; // one extra space to distinguish between full and empty
+    Q->data = (void **)malloc(Q->max_size * sizeof(void *));
+    if (Q->data == NULL) {
+        free(Q);
+        return NULL;
+    }
+
+    atomic_init(&Q->head, 0); // write index
+    atomic_init(&Q->tail, 0); // read index
+    Q->cached_tail = 0;
+    Q->cached_head = 0;
+
+    atomic_init(&Q->enq_waiters, 0);
+    atomic_init(&Q->deq_waiters, 0);
+    pthread_mutex_init(&Q->mutex, NULL);
+    pthread_cond_init(&Q->not_full, NULL);
+    pthread_cond_init(&Q->not_empty, NULL);
+    return Q;
+}
+
+/*
+ * Wakes the other side if it has registered as a waiter.
+ * The fence orders our index store before the waiter load, pairing with the
+ * waiter's increment before it re-checks the ring (so one of the two always sees the other).
+ */
+static void wakeWaiters(SpscQueue* this, atomic_int* waiters, pthread_cond_t* cond) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(waiters, memory_order_relaxed) > 0) {
+        pthread_mutex_lock(&(this->mutex));
+        pthread_cond_signal(cond);
+        pthread_mutex_unlock(&(this->mutex));
+    }
+}
+
+bool SpscQueue_tryEnq(SpscQueue* this, void* element) {
+    int head, next;
+
+    if (element == NULL)
+        return false;
+
+    head = atomic_load_explicit(&this->head, memory_order_relaxed);
+    next = head + 1;
+    if (next >= this->max_size)
+        next = 0;
+
+    // only reload the consumer's index when the cached copy says we are full
+    if (next == this->cached_tail) {
+        this->cached_tail = atomic_load_explicit(&this->tail, memory_order_acquire);
+        if (next == this->cached_tail)
+            return false;
+    }
+
+    this->data[head] = element;
+    atomic_store_explicit(&this->head, next, memory_order_release);
+    return true;
+}
+
+void* SpscQueue_tryDeq(SpscQueue* this) {
+    int tail, next;
+    void *elem;
+
+    tail = atomic_load_explicit(&this->tail, memory_order_relaxed);
+
+    // only reload the producer's index when the cached copy says we are empty
+    if (tail == this->cached_head) {
+        this->cached_head = atomic_load_explicit(&this->head, memory_order_acquire);
+        if (tail == this->cached_head)
+            return NULL;
+    }
+
+    next = tail + 1;
+    if (next >= this->max_size)
+        next = 0;
+
+    elem = this->data[tail];
+    atomic_store_explicit(&this->tail, next, memory_order_release);
+    return elem;
+}
+
+static bool isFull(SpscQueue* this) {
+    int next = atomic_load(&this->head) + 1;
+    if (next >= this->max_size)
+        next = 0;
+    return next == atomic_load(&this->tail);
+}
+
+bool SpscQueue_enq(SpscQueue* this, void* element) {
+    if (element == NULL)
+        return false;
+
+    for (int spin = 0; !SpscQueue_tryEnq(this, element); spin++) {
+        if (spin < SPSC_SPIN_LIMIT) {
+            sched_yield();
+            continue;
+        }
+
+        // slow path: register as a waiter and sleep until the consumer frees a slot
+        pthread_mutex_lock(&(this->mutex));
+        atomic_fetch_add(&this->enq_waiters, 1);
+        while (isFull(this))
+            pthread_cond_wait(&(this->not_full), &(this->mutex));
+        atomic_fetch_sub(&this->enq_waiters, 1);
+        pthread_mutex_unlock(&(this->mutex));
+    }
+
+    wakeWaiters(this, &this->deq_waiters, &this->not_empty);
+    return true;
+}
+
+void* SpscQueue_deq(SpscQueue* this) {
+    void *elem;
+
+    for (int spin = 0; (elem = SpscQueue_tryDeq(this)) == NULL; spin++) {
+        if (spin < SPSC_SPIN_LIMIT) {
+            sched_yield();
+            continue;
+        }
+
+        // slow path: register as a waiter and sleep until the producer publishes an element
+        pthread_mutex_lock(&(this->mutex));
+        atomic_fetch_add(&this->deq_waiters, 1);
+        while (SpscQueue_isEmpty(this))
+            pthread_cond_wait(&(this->not_empty), &(this->mutex));
+        atomic_fetch_sub(&this->deq_waiters, 1);
+        pthread_mutex_unlock(&(this->mutex));
+    }
+
+    wakeWaiters(this, &this->enq_waiters, &this->not_full);
+    return elem;
+}
+
+int SpscQueue_size(SpscQueue* this) {
+    int head = atomic_load_explicit(&this->head, memory_order_acquire);
+    int tail = atomic_load_explicit(&this->tail, memory_order_acquire);
+    int size = head - tail;
+    if (size < 0)
+        size += this->max_size;
+    return size;
+}
+
+bool SpscQueue_isEmpty(SpscQueue* this) {
+    return atomic_load(&this->tail) == atomic_load(&this->head);
+}
+
+void SpscQueue_clear(SpscQueue* this) {
+    if(this) {
+        atomic_store(&this->head, 0);
+        atomic_store(&this->tail, 0);
+        this->cached_head = 0;
+        this->cached_tail = 0;
+    }
+}
+
+void SpscQueue_destroy(SpscQueue* this) {
+    if(this) {
+        pthread_mutex_destroy(&(this->mutex));
+        pthread_cond_destroy(&(this->not_full));
+        pthread_cond_destroy(&(this->not_empty));
+        free(this->data);
+        free(this);
+    }
+}
@@ -0,0 +1,100 @@
+/*
+ * SpscQueue.h
+ *
+ * Module interface for a generic fixed-size single-producer/single-consumer Queue.
+ *
+ * Uses the same circular buffer layout as Queue, but the head (write) and tail (read)
+ * indices are atomics with acquire/release ordering so that one producer thread and
+ * one consumer thread can use the queue concurrently without taking a lock.
+ *
+ */
+
+#ifndef SPSC_QUEUE_H_
+#define SPSC_QUEUE_H_
+
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#define SPSC_CACHE_LINE 64
+
+typedef struct SpscQueue SpscQueue;
+
+/*
+ * head is only written by the producer and tail only by the consumer, so each is kept
+ * on its own cache line along with a cached copy of the other side's index.
+ * The mutex and condition variables are only used by the blocking wrappers once the
+ * ring is full or empty; the try functions never touch them.
+ */
+struct SpscQueue {
+    void** data;
+    int max_size;
+
+    _Alignas(SPSC_CACHE_LINE) atomic_int head;
+    int cached_tail; // producer's last seen value of tail
+
+    _Alignas(SPSC_CACHE_LINE) atomic_int tail;
+    int cached_head; // consumer's last seen value of head
+
+    _Alignas(SPSC_CACHE_LINE) atomic_int enq_waiters, deq_waiters;
+    pthread_mutex_t mutex;
+    pthread_cond_t not_full, not_empty;
+};
+
+/*
+ * Creates a new SpscQueue for at most max_size void* elements.
+ * Returns a pointer to a new SpscQueue on success and NULL on failure.
+ */
+SpscQueue* new_SpscQueue(int max_size);
+
+/*
+ * Enqueues the given void* element at the back of this Queue without blocking.
+ * Must only be called from the single producer thread.
+ * Returns true on success and false when element is NULL or the queue is full.
+ */
+bool SpscQueue_tryEnq(SpscQueue* this, void* element);
+
+/*
+ * Dequeues an element from the front of this Queue without blocking.
+ * Must only be called from the single consumer thread.
+ * Returns dequeued void* element on success or NULL if queue is empty.
+ */
+void* SpscQueue_tryDeq(SpscQueue* this);
+
+/*
+ * Enqueues the given void* element at the back of this Queue.
+ * If the queue is full, the function will block the calling thread until there is space in the queue.
+ * Returns false when element is NULL and true on success.
+ */
+bool SpscQueue_enq(SpscQueue* this, void* element);
+
+/*
+ * Dequeues an element from the front of this Queue.
+ * If the queue is empty, the function will block until an element can be dequeued.
+ * Returns the dequeued void* element.
+ */
+void* SpscQueue_deq(SpscQueue* this);
+
+/*
+ * Returns the number of elements currently in this Queue.
+ * The result is only a snapshot when the producer or consumer is running concurrently.
+ */
+int SpscQueue_size(SpscQueue* this);
+
+/*
+ * Returns true if this Queue is empty, false otherwise.
+ */
+bool SpscQueue_isEmpty(SpscQueue* this);
+
+/*
+ * Clears this Queue returning it to an empty state.
+ * Must not be called while the producer or consumer is using the queue.
+ */
+void SpscQueue_clear(SpscQueue* this);
+
+/*
+ * Destroys this Queue by freeing the memory used by the Queue.
+ */
+void SpscQueue_destroy(SpscQueue* this);
+
+#endif /* SPSC_QUEUE_H_ */
@@ -0,0 +1,289 @@
+/*
+ * TestAsyncQueue.cpp
+ *
+ * Very simple unit test file for AsyncQueue.hpp functionality.
+ *
+ */
+
+#include <atomic>
+#include <coroutine>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "AsyncQueue.hpp"
+#include "BlockingQueue.hpp"
+#include "myassert.h"
+
+
+#define DEFAULT_MAX_QUEUE_SIZE 4
+#define POOL_THREADS 2
+#define CONSUMER_COROUTINES 1000
+#define PRODUCER_COROUTINES 10
+
+/*
+ * A coroutine which starts straight away and frees itself when it finishes
+ */
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+/*
+ * Resumes woken coroutines on a few threads of its own, taking them from a BlockingQueue.hpp
+ */
+class PoolScheduler : public cqueue::AsyncScheduler {
+public:
+    PoolScheduler() {
+        for (int i = 0; i < POOL_THREADS; i++) {
+            threads_.emplace_back([this] {
+                // a null handle tells the thread to stop
+                while (std::coroutine_handle<> handle = handles_.deq())
+                    handle.resume();
+            });
+        }
+    }
+
+    ~PoolScheduler() {
+        for (int i = 0; i < POOL_THREADS; i++)
+            handles_.enq(std::coroutine_handle<>());
+        for (std::thread& thread : threads_)
+            thread.join();
+    }
+
+    void schedule(std::coroutine_handle<> handle) override { handles_.enq(handle); }
+
+private:
+    cqueue::BlockingQueue<std::coroutine_handle<>, CONSUMER_COROUTINES + PRODUCER_COROUTINES + POOL_THREADS> handles_;
+    std::vector<std::thread> threads_;
+};
+
+/*
+ * The number of tests that succeeded
+ */
+static int success_count = 0;
+
+/*
+ * The total number of tests run
+ */
+static int total_count = 0;
+
+
+/*
+ * Setup function to run prior to each test
+ */
+void setup(){
+    total_count++;
+}
+
+/*
+ * Teardown function to run after each test
+ */
+void teardown(){
+}
+
+/*
+ * This function is called multiple times from main for each user-defined test function
+ */
+void runTest(int (*testFunction)()) {
+    setup();
+
+    if (testFunction()) success_count++;
+
+    teardown();
+}
+
+// Dequeues one element into out, then raises done.
+static Detached consumeOne(cqueue::AsyncQueue<int>& queue, int* out, std::atomic<int>* done) {
+    *out = co_await queue.deq();
+    done->fetch_add(1);
+}
+
+// Enqueues count consecutive values starting at first, then raises done.
+static Detached produceRange(cqueue::AsyncQueue<int>& queue, int first, int count, std::atomic<int>* done) {
+    for (int i = 0; i < count; i++) {
+        co_await queue.enq(first + i);
+    }
+    done->fetch_add(1);
+}
+
+// Dequeues count elements, adding them to sum, then raises done.
+static Detached consumeSum(cqueue::AsyncQueue<int>& queue, int count, std::atomic<long>* sum, std::atomic<int>* done) {
+    for (int i = 0; i < count; i++) {
+        sum->fetch_add(co_await queue.deq());
+    }
+    done->fetch_add(1);
+}
+
+
+/*
+    **************** Regular test cases ****************
+*/
+
+// Checks that awaiting a deq on a queue with an element completes without suspending.
+int deqReadyDoesNotSuspend() {
+    cqueue::AsyncQueue<int> queue(DEFAULT_MAX_QUEUE_SIZE);
+    std::atomic<int> done(0);
+    int out = 0;
+
+    assert(queue.isEmpty());
+    assert(queue.tryEnq(5));
+    assert(queue.size() == 1);
+    consumeOne(queue, &out, &done);
+    assert(done == 1 && out == 5);
+    assert(queue.isEmpty());
+    return TEST_SUCCESS;
+}
+
+// Checks that a deq on an empty queue suspends its coroutine until an element arrives.
+int deqSuspendsUntilEnq() {
+    cqueue::AsyncQueue<int> queue(DEFAULT_MAX_QUEUE_SIZE);
+    std::atomic<int> done(0);
+    int out = 0;
+
+    consumeOne(queue, &out, &done);
+    assert(done == 0);
+    assert(queue.tryEnq(9)); // the inline scheduler resumes the consumer right here
+    assert(done == 1 && out == 9);
+    assert(queue.isEmpty());
+    return TEST_SUCCESS;
+}
+
+// Checks that suspended consumers are handed elements in the order they started waiting.
+int waitersWokenInOrder() {
+    cqueue::AsyncQueue<int> queue(DEFAULT_MAX_QUEUE_SIZE);
+    std::atomic<int> done(0);
+    int outs[DEFAULT_MAX_QUEUE_SIZE] = {0};
+
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        consumeOne(queue, &outs[i], &done);
+    }
+    assert(done == 0);
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(queue.tryEnq(i + 1));
+        assert(done == i + 1 && outs[i] == i + 1);
+    }
+    return TEST_SUCCESS;
+}
+
+// Checks that an enq on a full queue suspends its coroutine until space is freed, keeping FIFO order.
+int enqSuspendsWhenFull() {
+    cqueue::AsyncQueue<int> queue(DEFAULT_MAX_QUEUE_SIZE);
+    std::atomic<int> done(0);
+
+    produceRange(queue, 0, DEFAULT_MAX_QUEUE_SIZE * 3, &done);
+    assert(done == 0);
+    assert(queue.size() == DEFAULT_MAX_QUEUE_SIZE);
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE * 3; i++) {
+        std::optional<int> element = queue.tryDeq();
+        assert(element && *element == i);
+    }
+    assert(done == 1);
+    assert(queue.isEmpty());
+    return TEST_SUCCESS;
+}
+
+// Checks that move-only elements pass through by move.
+int moveOnlyElements() {
+    cqueue::AsyncQueue<std::unique_ptr<int>> queue(DEFAULT_MAX_QUEUE_SIZE);
+
+    assert(queue.tryEnq(std::make_unique<int>(3)));
+    std::optional<std::unique_ptr<int>> element = queue.tryDeq();
+    assert(element && **element == 3);
+    return TEST_SUCCESS;
+}
+
+// Checks that a thousand consumer coroutines sharing two threads each get exactly one element.
+int manyCoroutinesFewThreads() {
+    const int per_producer = CONSUMER_COROUTINES / PRODUCER_COROUTINES;
+    std::atomic<int> consumers_done(0), producers_done(0);
+    std::vector<int> outs(CONSUMER_COROUTINES, -1);
+    PoolScheduler scheduler;
+    {
+        cqueue::AsyncQueue<int> queue(DEFAULT_MAX_QUEUE_SIZE, scheduler);
+
+        for (int i = 0; i < CONSUMER_COROUTINES; i++) {
+            consumeOne(queue, &outs[i], &consumers_done);
+        }
+        for (int i = 0; i < PRODUCER_COROUTINES; i++) {
+            produceRange(queue, i * per_producer, per_producer, &producers_done);
+        }
+        while (consumers_done < CONSUMER_COROUTINES || producers_done < PRODUCER_COROUTINES) {
+            std::this_thread::yield();
+        }
+        assert(queue.isEmpty());
+    }
+
+    std::vector<bool> seen(CONSUMER_COROUTINES, false);
+    for (int out : outs) {
+        assert(out >= 0 && out < CONSUMER_COROUTINES && !seen[out]);
+        seen[out] = true;
+    }
+    return TEST_SUCCESS;
+}
+
+// Checks that producer and consumer coroutines on a pool transfer every element when both sides wait.
+int poolTransferSums() {
+    const int count = 20000;
+    std::atomic<int> done(0);
+    std::atomic<long> sum(0);
+    PoolScheduler scheduler;
+    {
+        cqueue::AsyncQueue<int> queue(DEFAULT_MAX_QUEUE_SIZE, scheduler);
+
+        for (int i = 0; i < 4; i++) {
+            consumeSum(queue, count / 4, &sum, &done);
+        }
+        std::thread producer([&] {
+            for (int i = 0; i < 4; i++)
+                produceRange(queue, i * (count / 4), count / 4, &done);
+        });
+        producer.join();
+        while (done < 8) {
+            std::this_thread::yield();
+        }
+    }
+    assert(sum == (long)count * (count - 1) / 2);
+    return TEST_SUCCESS;
+}
+
+/*
+    **************** Exceptional test cases ****************
+*/
+
+// Checks that tryEnq and tryDeq fail instead of waiting, and a failed tryEnq leaves its element alone.
+int tryEnqTryDeqNeverWait() {
+    cqueue::AsyncQueue<std::unique_ptr<int>> queue(1);
+    std::unique_ptr<int> element = std::make_unique<int>(2);
+
+    assert(!queue.tryDeq());
+    assert(queue.tryEnq(std::make_unique<int>(1)));
+    assert(!queue.tryEnq(std::move(element)));
+    assert(element != nullptr && *element == 2);
+    return TEST_SUCCESS;
+}
+
+/*
+ * Main function for the AsyncQueue tests which will run each user-defined test in turn.
+ */
+
+int main() {
+    runTest(deqReadyDoesNotSuspend);
+    runTest(deqSuspendsUntilEnq);
+    runTest(waitersWokenInOrder);
+    runTest(enqSuspendsWhenFull);
+    runTest(moveOnlyElements);
+    runTest(manyCoroutinesFewThreads);
+    runTest(poolTransferSums);
+
+    runTest(tryEnqTryDeqNeverWait);
+
+    printf("AsyncQueue Tests complete: %d / %d tests successful.\n----------------\n", success_count, total_count);
+
+}
@@ -7,6 +7,10 @@
 
 #include <stdio.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
 
 #include "BlockingQueue.h"
 #include "myassert.h"
@@ -19,6 +23,11 @@
  */
 static BlockingQueue *queue;
 
+/*
+ * The backend the queue under test is created with
+ */
+static BlockingQueueBackend backend = BLOCKING_QUEUE_MUTEX;
+
 /*
  * The number of tests that succeeded
  */
@@ -29,12 +38,23 @@ static int success_count = 0;
  */
 static int total_count = 0;
 
+/*
+ * The number of elements handed back by an overflow policy
+ */
+static atomic_int reclaimed_count;
+
+static void countReclaim(void* element) {
+    (void)element;
+    atomic_fetch_add(&reclaimed_count, 1);
+}
+
 
 /*
  * Setup function to run prior to each test
  */
 void setup(){
-    queue = new_BlockingQueue(DEFAULT_MAX_QUEUE_SIZE);
+    queue = new_BlockingQueueWithBackend(DEFAULT_MAX_QUEUE_SIZE, backend);
+    atomic_store(&reclaimed_count, 0);
     total_count++;
 }
 
@@ -63,6 +83,27 @@ void* threadFunc(void* arg) {
     return NULL;
 }
 
+#define STRESS_THREADS 4
+#define STRESS_COUNT 20000
+
+// Enqueues STRESS_COUNT non-NULL tokens, forcing the small queue through its full path
+void* stressProducer(void* arg) {
+    (void)arg;
+    for (intptr_t i = 1; i <= STRESS_COUNT; i++) {
+        BlockingQueue_enq(queue, (void*)i);
+    }
+    return NULL;
+}
+
+// Dequeues STRESS_COUNT tokens and returns their sum
+void* stressConsumer(void* arg) {
+    long *sum = arg;
+    for (int i = 0; i < STRESS_COUNT; i++) {
+        *sum += (intptr_t)BlockingQueue_deq(queue);
+    }
+    return NULL;
+}
+
 
 /*
  * Two sample user-defined tests included below.
@@ -133,6 +174,449 @@ int threadSafetyTest() {
     return TEST_SUCCESS;
 }
 
+// Checks that several producers and consumers transfer every element exactly once.
+int multiProducerMultiConsumer() {
+    pthread_t producers[STRESS_THREADS], consumers[STRESS_THREADS];
+    long sums[STRESS_THREADS] = {0};
+
+    for (int i = 0; i < STRESS_THREADS; i++) {
+        pthread_create(&producers[i], NULL, stressProducer, NULL);
+        pthread_create(&consumers[i], NULL, stressConsumer, &sums[i]);
+    }
+    long total = 0;
+    for (int i = 0; i < STRESS_THREADS; i++) {
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], NULL);
+        total += sums[i];
+    }
+
+    assert(total == (long)STRESS_THREADS * STRESS_COUNT * (STRESS_COUNT + 1) / 2);
+    assert(BlockingQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks that the queue reports its size and can be reused after a clear.
+int sizeAndClear() {
+    int element = 5;
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(BlockingQueue_enq(queue, &element));
+    }
+    assert(BlockingQueue_size(queue) == DEFAULT_MAX_QUEUE_SIZE);
+    assert(!BlockingQueue_isEmpty(queue));
+    BlockingQueue_clear(queue);
+    assert(BlockingQueue_isEmpty(queue));
+    assert(BlockingQueue_enq(queue, &element));
+    assert(BlockingQueue_deq(queue) == &element);
+    return TEST_SUCCESS;
+}
+
+// Checks that a batch larger than the queue is fully transferred in order by a concurrent consumer.
+int enqBatchLargerThanQueue() {
+    pthread_t consumer;
+    long sum = 0;
+    void *in[STRESS_COUNT];
+
+    for (intptr_t i = 0; i < STRESS_COUNT; i++) {
+        in[i] = (void*)(i + 1);
+    }
+    pthread_create(&consumer, NULL, stressConsumer, &sum);
+    assert(BlockingQueue_enqBatch(queue, in, STRESS_COUNT));
+    pthread_join(consumer, NULL);
+
+    assert(sum == (long)STRESS_COUNT * (STRESS_COUNT + 1) / 2);
+    return TEST_SUCCESS;
+}
+
+// Checks that deqBatch returns what is available between min and max, in order.
+int deqBatchMinMax() {
+    int elements[] = {1, 2, 3, 4, 5};
+    void *in[5], *out[5];
+
+    for (int i = 0; i < 5; i++) {
+        in[i] = &elements[i];
+    }
+    assert(BlockingQueue_enqBatch(queue, in, 5));
+    assert(BlockingQueue_deqBatch(queue, out, 1, 3) == 3);
+    assert(BlockingQueue_deqBatch(queue, out + 3, 1, 5) == 2);
+    for (int i = 0; i < 5; i++) {
+        assert(out[i] == &elements[i]);
+    }
+    assert(BlockingQueue_deqBatch(queue, out, 0, 5) == 0);
+    assert(BlockingQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks that a batch containing NULL is rejected without enqueuing anything.
+int enqBatchRejectsNull() {
+    int element = 5;
+    void *in[2] = {&element, NULL};
+
+    assert(!BlockingQueue_enqBatch(queue, in, 2));
+    assert(BlockingQueue_size(queue) == 0);
+    return TEST_SUCCESS;
+}
+
+// Checks that blocked consumers are woken with no spinning, so they must park in the kernel.
+int parkedConsumersWake() {
+    pthread_t consumers[STRESS_THREADS];
+    long sums[STRESS_THREADS] = {0};
+
+    BlockingQueue_setSpin(queue, 0);
+    for (int i = 0; i < STRESS_THREADS; i++) {
+        pthread_create(&consumers[i], NULL, stressConsumer, &sums[i]);
+    }
+    long total = 0;
+    for (int i = 0; i < STRESS_THREADS; i++) {
+        stressProducer(NULL);
+    }
+    for (int i = 0; i < STRESS_THREADS; i++) {
+        pthread_join(consumers[i], NULL);
+        total += sums[i];
+    }
+
+    assert(total == (long)STRESS_THREADS * STRESS_COUNT * (STRESS_COUNT + 1) / 2);
+    return TEST_SUCCESS;
+}
+
+// Checks that an unbounded queue accepts far more than one segment without blocking.
+int unboundedEnqNeverBlocks() {
+    int elements[DEFAULT_MAX_QUEUE_SIZE * 5];
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE * 5; i++) {
+        elements[i] = i;
+        assert(BlockingQueue_enq(queue, &elements[i]));
+    }
+    assert(BlockingQueue_size(queue) == DEFAULT_MAX_QUEUE_SIZE * 5);
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE * 5; i++) {
+        assert(BlockingQueue_deq(queue) == &elements[i]);
+    }
+    assert(BlockingQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Enqueues the element passed in after a short delay, so a consumer has to block
+void* delayedEnq(void* arg) {
+    struct timespec delay = {0, 20 * 1000 * 1000};
+    nanosleep(&delay, NULL);
+    BlockingQueue_enq(queue, arg);
+    return NULL;
+}
+
+// Checks that enabled statistics count operations and record time blocked on an empty queue.
+int statsRecordBlocking() {
+#ifdef QUEUE_STATS
+    QueueStatsSnapshot stats;
+    pthread_t producer;
+    int element = 5;
+
+    assert(!BlockingQueue_getStats(queue, &stats));
+    assert(BlockingQueue_enableStats(queue));
+    BlockingQueue_setSpin(queue, 0);
+    for (int i = 0; i < 3; i++) {
+        assert(BlockingQueue_enq(queue, &element));
+    }
+    for (int i = 0; i < 3; i++) {
+        assert(BlockingQueue_deq(queue) == &element);
+    }
+    pthread_create(&producer, NULL, delayedEnq, &element);
+    assert(BlockingQueue_deq(queue) == &element);
+    pthread_join(producer, NULL);
+
+    assert(BlockingQueue_getStats(queue, &stats));
+    assert(stats.enqs == 4);
+    assert(stats.deqs == 4);
+    assert(stats.high_water == 3);
+    assert(stats.empty >= 1);
+    assert(stats.blocked_ns > 0);
+#else
+    assert(!BlockingQueue_enableStats(queue));
+#endif
+    return TEST_SUCCESS;
+}
+
+// Returns true if fd polls readable within timeout_ms
+static bool fdReadable(int fd, int timeout_ms) {
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    return poll(&pfd, 1, timeout_ms) == 1 && (pfd.revents & POLLIN);
+}
+
+// Checks that tryDeq returns elements in order without blocking on an empty queue.
+int tryDeqNeverBlocks() {
+    int elements[] = {1, 2};
+
+    assert(BlockingQueue_tryDeq(queue) == NULL);
+    assert(BlockingQueue_enq(queue, &elements[0]));
+    assert(BlockingQueue_enq(queue, &elements[1]));
+    assert(BlockingQueue_tryDeq(queue) == &elements[0]);
+    assert(BlockingQueue_tryDeq(queue) == &elements[1]);
+    assert(BlockingQueue_tryDeq(queue) == NULL);
+    return TEST_SUCCESS;
+}
+
+// Checks that the eventfd becomes readable once per burst and goes quiet after a full drain.
+int fdSignalsOncePerBurst() {
+    int elements[DEFAULT_MAX_QUEUE_SIZE];
+    void *out[DEFAULT_MAX_QUEUE_SIZE];
+    uint64_t count;
+
+    assert(BlockingQueue_fd(queue) == -1);
+    assert(BlockingQueue_enableFd(queue));
+    int fd = BlockingQueue_fd(queue);
+    assert(fd >= 0);
+    assert(!fdReadable(fd, 0));
+
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(BlockingQueue_enq(queue, &elements[i]));
+    }
+    assert(fdReadable(fd, 0));
+    assert(read(fd, &count, sizeof(count)) == sizeof(count));
+    assert(count == 1); // one write for the whole burst
+
+    assert(BlockingQueue_drain(queue, out, DEFAULT_MAX_QUEUE_SIZE) == DEFAULT_MAX_QUEUE_SIZE);
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(out[i] == &elements[i]);
+    }
+    assert(!fdReadable(fd, 0));
+    assert(BlockingQueue_drain(queue, out, DEFAULT_MAX_QUEUE_SIZE) == 0);
+    return TEST_SUCCESS;
+}
+
+// Checks that a partial drain leaves the eventfd readable for the rest, and that a blocked poll wakes.
+int fdStaysReadableUntilDrained() {
+    pthread_t producer;
+    int elements[4], element = 5;
+    void *out[2];
+
+    assert(BlockingQueue_enableFd(queue));
+    int fd = BlockingQueue_fd(queue);
+    void *in[4] = {&elements[0], &elements[1], &elements[2], &elements[3]};
+    assert(BlockingQueue_enqBatch(queue, in, 4));
+
+    assert(fdReadable(fd, 0));
+    assert(BlockingQueue_drain(queue, out, 2) == 2);
+    assert(fdReadable(fd, 0));
+    assert(BlockingQueue_drain(queue, out, 2) == 2);
+    assert(out[1] == &elements[3]);
+    assert(BlockingQueue_drain(queue, out, 2) == 0);
+    assert(!fdReadable(fd, 0));
+
+    pthread_create(&producer, NULL, delayedEnq, &element);
+    assert(fdReadable(fd, 5000));
+    pthread_join(producer, NULL);
+    assert(BlockingQueue_drain(queue, out, 2) == 1);
+    assert(out[0] == &element);
+    return TEST_SUCCESS;
+}
+
+#define SELECT_QUEUES 3
+
+// Enqueues the element passed in on the last of the queues after a short delay
+void* delayedEnqLast(void* arg) {
+    BlockingQueue **queues = arg;
+    struct timespec delay = {0, 20 * 1000 * 1000};
+    static int element = 7;
+    nanosleep(&delay, NULL);
+    BlockingQueue_enq(queues[SELECT_QUEUES - 1], &element);
+    return NULL;
+}
+
+// Checks that deqAny takes from whichever queue has an element, preferring earlier queues.
+int deqAnyTakesAvailable() {
+    BlockingQueue *queues[SELECT_QUEUES] = {queue, new_BlockingQueueWithBackend(DEFAULT_MAX_QUEUE_SIZE, backend),
+                                            new_BlockingQueueWithBackend(DEFAULT_MAX_QUEUE_SIZE, backend)};
+    int a = 1, b = 2, index;
+
+    assert(queues[1] != NULL && queues[2] != NULL);
+    assert(BlockingQueue_enq(queues[2], &a));
+    assert(BlockingQueue_enq(queues[1], &b));
+    assert(BlockingQueue_deqAny(queues, SELECT_QUEUES, &index) == &b);
+    assert(index == 1);
+    assert(BlockingQueue_deqAny(queues, SELECT_QUEUES, &index) == &a);
+    assert(index == 2);
+
+    BlockingQueue_destroy(queues[1]);
+    BlockingQueue_destroy(queues[2]);
+    return TEST_SUCCESS;
+}
+
+// Checks that a parked deqAny is woken by an enq on any one of its queues.
+int deqAnyWakesOnAnyQueue() {
+    BlockingQueue *queues[SELECT_QUEUES] = {queue, new_BlockingQueueWithBackend(DEFAULT_MAX_QUEUE_SIZE, backend),
+                                            new_BlockingQueueWithBackend(DEFAULT_MAX_QUEUE_SIZE, backend)};
+    pthread_t producer;
+    int index;
+
+    assert(queues[1] != NULL && queues[2] != NULL);
+    for (int i = 0; i < SELECT_QUEUES; i++) {
+        BlockingQueue_setSpin(queues[i], 0);
+    }
+    pthread_create(&producer, NULL, delayedEnqLast, queues);
+    assert(*(int*)BlockingQueue_deqAny(queues, SELECT_QUEUES, &index) == 7);
+    assert(index == SELECT_QUEUES - 1);
+    pthread_join(producer, NULL);
+    assert(atomic_load(&queues[2]->selector_count) == 0);
+
+    BlockingQueue_destroy(queues[1]);
+    BlockingQueue_destroy(queues[2]);
+    return TEST_SUCCESS;
+}
+
+// Checks that fair deqAny alternates between busy queues instead of draining the first.
+int deqAnyFairRoundRobin() {
+    BlockingQueue *queues[2] = {queue, new_BlockingQueueWithBackend(DEFAULT_MAX_QUEUE_SIZE, backend)};
+    int element = 5, index, cursor = 0;
+
+    assert(queues[1] != NULL);
+    for (int i = 0; i < 4; i++) {
+        assert(BlockingQueue_enq(queues[0], &element));
+        assert(BlockingQueue_enq(queues[1], &element));
+    }
+    for (int i = 0; i < 8; i++) {
+        assert(BlockingQueue_deqAnyFair(queues, 2, &index, &cursor) == &element);
+        assert(index == i % 2);
+    }
+
+    BlockingQueue_destroy(queues[1]);
+    return TEST_SUCCESS;
+}
+
+// Checks that deqAny returns NULL instead of blocking on no queues, and fair deqAny copes with a negative cursor.
+int deqAnyRejectsBadArguments() {
+    BlockingQueue *queues[1] = {queue};
+    int element = 6, index = -1, cursor = -3;
+
+    assert(BlockingQueue_deqAny(NULL, 1, &index) == NULL);
+    assert(BlockingQueue_deqAny(queues, 0, &index) == NULL);
+    assert(BlockingQueue_deqAnyFair(queues, -1, &index, &cursor) == NULL);
+    assert(BlockingQueue_deqAnyFair(queues, 1, &index, NULL) == NULL);
+    assert(index == -1);
+
+    assert(BlockingQueue_enq(queue, &element));
+    assert(BlockingQueue_deqAnyFair(queues, 1, &index, &cursor) == &element);
+    assert(index == 0 && cursor == 0);
+    return TEST_SUCCESS;
+}
+
+// Checks that a node the caller cannot run on still gives a working, unplaced queue.
+int onMissingNodeFallsBack() {
+    int nodes[2] = {-1, 4096}, element = 4;
+    for (int i = 0; i < 2; i++) {
+        BlockingQueue *unplaced = new_BlockingQueueOnNode(DEFAULT_MAX_QUEUE_SIZE, backend, nodes[i]);
+        assert(unplaced != NULL);
+        assert(BlockingQueue_node(unplaced) == -1);
+        assert(!BlockingQueue_pinNear(unplaced));
+        assert(BlockingQueue_enq(unplaced, &element));
+        assert(BlockingQueue_deq(unplaced) == &element);
+        BlockingQueue_destroy(unplaced);
+    }
+    return TEST_SUCCESS;
+}
+
+// Checks that overwrite-oldest never blocks a producer and leaves the newest elements in order.
+int overflowOverwriteNeverBlocks() {
+    int elements[DEFAULT_MAX_QUEUE_SIZE * 3];
+
+    BlockingQueue_setOverflow(queue, QUEUE_OVERFLOW_OVERWRITE_OLDEST, countReclaim);
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE * 3; i++) {
+        assert(BlockingQueue_enq(queue, &elements[i]));
+    }
+    if (backend == BLOCKING_QUEUE_UNBOUNDED) {
+        // never full, so nothing is overwritten
+        assert(BlockingQueue_size(queue) == DEFAULT_MAX_QUEUE_SIZE * 3);
+        assert(BlockingQueue_dropped(queue) == 0);
+        return TEST_SUCCESS;
+    }
+    assert(BlockingQueue_size(queue) == DEFAULT_MAX_QUEUE_SIZE);
+    assert(BlockingQueue_dropped(queue) == DEFAULT_MAX_QUEUE_SIZE * 2);
+    assert(atomic_load(&reclaimed_count) == DEFAULT_MAX_QUEUE_SIZE * 2);
+    for (int i = DEFAULT_MAX_QUEUE_SIZE * 2; i < DEFAULT_MAX_QUEUE_SIZE * 3; i++) {
+        assert(BlockingQueue_deq(queue) == &elements[i]);
+    }
+    return TEST_SUCCESS;
+}
+
+// Checks that drop-newest turns away a batch's overflow without blocking, and a freed slot is reused.
+int overflowDropNewestBatch() {
+    int element = 6, extra = 5;
+    void *batch[DEFAULT_MAX_QUEUE_SIZE + 5];
+
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE + extra; i++) {
+        batch[i] = &element;
+    }
+    BlockingQueue_setOverflow(queue, QUEUE_OVERFLOW_DROP_NEWEST, countReclaim);
+    assert(BlockingQueue_enqBatch(queue, batch, DEFAULT_MAX_QUEUE_SIZE + extra));
+    if (backend == BLOCKING_QUEUE_UNBOUNDED) {
+        assert(BlockingQueue_dropped(queue) == 0);
+        return TEST_SUCCESS;
+    }
+    assert(BlockingQueue_size(queue) == DEFAULT_MAX_QUEUE_SIZE);
+    assert(BlockingQueue_dropped(queue) == extra);
+    assert(atomic_load(&reclaimed_count) == extra);
+
+    assert(BlockingQueue_deq(queue) == &element);
+    assert(BlockingQueue_enq(queue, &element));
+    assert(BlockingQueue_dropped(queue) == extra);
+    return TEST_SUCCESS;
+}
+
+// Enqueues STRESS_COUNT tokens under the queue's overflow policy, which must never block
+void* overflowProducer(void* arg) {
+    (void)arg;
+    for (uintptr_t i = 1; i <= STRESS_COUNT; i++) {
+        BlockingQueue_enq(queue, (void *)i);
+    }
+    return NULL;
+}
+
+// Checks that sampling producers with no consumer finish, and every element is either kept or dropped.
+int overflowSampleAccountsForAll() {
+    pthread_t producers[STRESS_THREADS];
+
+    BlockingQueue_setOverflow(queue, QUEUE_OVERFLOW_SAMPLE, countReclaim);
+    for (int i = 0; i < STRESS_THREADS; i++) {
+        pthread_create(&producers[i], NULL, overflowProducer, NULL);
+    }
+    for (int i = 0; i < STRESS_THREADS; i++) {
+        pthread_join(producers[i], NULL);
+    }
+    assert(BlockingQueue_size(queue) + BlockingQueue_dropped(queue) == STRESS_THREADS * STRESS_COUNT);
+    assert(atomic_load(&reclaimed_count) == BlockingQueue_dropped(queue));
+    if (backend != BLOCKING_QUEUE_UNBOUNDED) {
+        assert(BlockingQueue_size(queue) <= DEFAULT_MAX_QUEUE_SIZE);
+        assert(BlockingQueue_size(queue) > DEFAULT_MAX_QUEUE_SIZE / 2);
+    }
+    return TEST_SUCCESS;
+}
+
+// Pins the thread running it near the queue passed in, and returns whether that worked
+void* pinNearQueue(void* arg) {
+    return BlockingQueue_pinNear(arg) ? arg : NULL;
+}
+
+// Checks that a queue placed on node 0 records its node, works as usual and can pin threads near it.
+int onNodePlacesQueue() {
+    BlockingQueue *placed = new_BlockingQueueOnNode(DEFAULT_MAX_QUEUE_SIZE, backend, 0);
+    pthread_t thread;
+    void *pinned;
+    int element = 3;
+
+    assert(BlockingQueue_node(queue) == -1);
+    assert(placed != NULL);
+    assert(BlockingQueue_node(placed) == 0);
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(BlockingQueue_enq(placed, &element));
+    }
+    assert(BlockingQueue_size(placed) == DEFAULT_MAX_QUEUE_SIZE);
+    assert(BlockingQueue_deq(placed) == &element);
+
+    // pin a helper thread rather than the one running the tests
+    pthread_create(&thread, NULL, pinNearQueue, placed);
+    pthread_join(thread, &pinned);
+    assert(pinned == placed);
+
+    BlockingQueue_destroy(placed);
+    return TEST_SUCCESS;
+}
+
 /*
  * Main function for the BlockingQueue tests which will run each user-defined test in turn.
  */
@@ -144,6 +628,80 @@ int main() {
     runTest(enqAndDeqOneElement);
     runTest(enqAndDeqMultipleElements);
     runTest(threadSafetyTest);
+    runTest(multiProducerMultiConsumer);
+    runTest(sizeAndClear);
+    runTest(enqBatchLargerThanQueue);
+    runTest(deqBatchMinMax);
+    runTest(enqBatchRejectsNull);
+    runTest(parkedConsumersWake);
+    runTest(statsRecordBlocking);
+    runTest(tryDeqNeverBlocks);
+    runTest(fdSignalsOncePerBurst);
+    runTest(fdStaysReadableUntilDrained);
+    runTest(deqAnyTakesAvailable);
+    runTest(deqAnyWakesOnAnyQueue);
+    runTest(deqAnyFairRoundRobin);
+    runTest(deqAnyRejectsBadArguments);
+    runTest(onNodePlacesQueue);
+    runTest(onMissingNodeFallsBack);
+    runTest(overflowOverwriteNeverBlocks);
+    runTest(overflowDropNewestBatch);
+    runTest(overflowSampleAccountsForAll);
+
+    // rerun the suite against the lock-free backend
+    backend = BLOCKING_QUEUE_LOCK_FREE;
+    runTest(newQueueIsNotNull);
+    runTest(newQueueSizeZero);
+    runTest(enqAndDeqOneElement);
+    runTest(enqAndDeqMultipleElements);
+    runTest(threadSafetyTest);
+    runTest(multiProducerMultiConsumer);
+    runTest(sizeAndClear);
+    runTest(enqBatchLargerThanQueue);
+    runTest(deqBatchMinMax);
+    runTest(enqBatchRejectsNull);
+    runTest(parkedConsumersWake);
+    runTest(statsRecordBlocking);
+    runTest(tryDeqNeverBlocks);
+    runTest(fdSignalsOncePerBurst);
+    runTest(fdStaysReadableUntilDrained);
+    runTest(deqAnyTakesAvailable);
+    runTest(deqAnyWakesOnAnyQueue);
+    runTest(deqAnyFairRoundRobin);
+    runTest(deqAnyRejectsBadArguments);
+    runTest(onNodePlacesQueue);
+    runTest(onMissingNodeFallsBack);
+    runTest(overflowOverwriteNeverBlocks);
+    runTest(overflowDropNewestBatch);
+    runTest(overflowSampleAccountsForAll);
+
+    // rerun the suite against the unbounded backend
+    backend = BLOCKING_QUEUE_UNBOUNDED;
+    runTest(newQueueIsNotNull);
+    runTest(newQueueSizeZero);
+    runTest(enqAndDeqOneElement);
+    runTest(enqAndDeqMultipleElements);
+    runTest(threadSafetyTest);
+    runTest(multiProducerMultiConsumer);
+    runTest(sizeAndClear);
+    runTest(enqBatchLargerThanQueue);
+    runTest(deqBatchMinMax);
+    runTest(enqBatchRejectsNull);
+    runTest(parkedConsumersWake);
+    runTest(statsRecordBlocking);
+    runTest(tryDeqNeverBlocks);
+    runTest(fdSignalsOncePerBurst);
+    runTest(fdStaysReadableUntilDrained);
+    runTest(deqAnyTakesAvailable);
+    runTest(deqAnyWakesOnAnyQueue);
+    runTest(deqAnyFairRoundRobin);
+    runTest(deqAnyRejectsBadArguments);
+    runTest(onNodePlacesQueue);
+    runTest(onMissingNodeFallsBack);
+    runTest(overflowOverwriteNeverBlocks);
+    runTest(overflowDropNewestBatch);
+    runTest(overflowSampleAccountsForAll);
+    runTest(unboundedEnqNeverBlocks);
 
     printf("\nBlockingQueue Tests complete: %d / %d tests successful.\n----------------\n", success_count, total_count);
 
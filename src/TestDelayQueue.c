@@ -0,0 +1,297 @@
+/*
+ * TestDelayQueue.c
+ *
+ * Very simple unit test file for DelayQueue functionality.
+ *
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "DelayQueue.h"
+#include "myassert.h"
+
+
+#define DEFAULT_MAX_QUEUE_SIZE 20
+#define MS 1000000L
+#define MANY_PENDING 100000
+
+/*
+ * The queue to use during tests
+ */
+static DelayQueue *queue;
+
+/*
+ * The number of tests that succeeded
+ */
+static int success_count = 0;
+
+/*
+ * The total number of tests run
+ */
+static int total_count = 0;
+
+
+/*
+ * Setup function to run prior to each test
+ */
+void setup(){
+    queue = new_DelayQueue(DEFAULT_MAX_QUEUE_SIZE, DELAY_QUEUE_DEFAULT_TICK_NS);
+    total_count++;
+}
+
+/*
+ * Teardown function to run after each test
+ */
+void teardown(){
+    DelayQueue_destroy(queue);
+}
+
+/*
+ * This function is called multiple times from main for each user-defined test function
+ */
+void runTest(int (*testFunction)()) {
+    setup();
+
+    if (testFunction()) success_count++;
+
+    teardown();
+}
+
+/*
+ * An element remembering its own deadline
+ */
+typedef struct Timer {
+    long ready_at;
+} Timer;
+
+// Dequeues one element from the queue and returns it
+void* deqOne(void* arg) {
+    (void)arg;
+    return DelayQueue_deq(queue);
+}
+
+// Enqueues the element passed in, ready at once, blocking while the queue is full
+void* enqNow(void* arg) {
+    DelayQueue_enq(queue, arg, 0);
+    return NULL;
+}
+
+
+/*
+    **************** Regular test cases ****************
+*/
+
+// Checks that a new queue is empty and has nothing to dequeue.
+int newQueueIsEmpty() {
+    assert(queue != NULL);
+    assert(DelayQueue_size(queue) == 0);
+    assert(DelayQueue_tryDeq(queue) == NULL);
+    return TEST_SUCCESS;
+}
+
+// Checks that an element whose deadline has already passed is dequeued at once.
+int pastDeadlineIsReady() {
+    int element = 1;
+
+    assert(DelayQueue_enq(queue, &element, DelayQueue_nowNs() - MS));
+    assert(DelayQueue_size(queue) == 1);
+    assert(DelayQueue_tryDeq(queue) == &element);
+    assert(DelayQueue_size(queue) == 0);
+    return TEST_SUCCESS;
+}
+
+// Checks that an element is held back until its deadline, and deq sleeps until then.
+int futureDeadlineWaits() {
+    int element = 2;
+    long start = DelayQueue_nowNs();
+
+    assert(DelayQueue_enqAfter(queue, &element, 30 * MS));
+    assert(DelayQueue_tryDeq(queue) == NULL);
+    assert(DelayQueue_deq(queue) == &element);
+    long waited = DelayQueue_nowNs() - start;
+    assert(waited >= 30 * MS && waited < 230 * MS);
+    return TEST_SUCCESS;
+}
+
+// Checks that elements come out in deadline order, not the order they were enqueued in.
+int deadlinesComeOutInOrder() {
+    int elements[4] = {0, 1, 2, 3};
+    long delays[4] = {40 * MS, 10 * MS, 100 * MS, 20 * MS};
+    int order[4] = {1, 3, 0, 2};
+
+    for (int i = 0; i < 4; i++) {
+        assert(DelayQueue_enqAfter(queue, &elements[i], delays[i]));
+    }
+    for (int i = 0; i < 4; i++) {
+        assert(DelayQueue_deq(queue) == &elements[order[i]]);
+    }
+    return TEST_SUCCESS;
+}
+
+// Checks that passed deadlines come out earliest first, whether enqueued late or already due in the wheel.
+int passedDeadlinesComeOutInOrder() {
+    int elements[5] = {0, 1, 2, 3, 4};
+    struct timespec delay = {0, 20 * MS};
+    long start = DelayQueue_nowNs();
+
+    assert(DelayQueue_enq(queue, &elements[0], start - 10 * MS));
+    assert(DelayQueue_enq(queue, &elements[1], start - 50 * MS));
+    assert(DelayQueue_enq(queue, &elements[2], start - 50 * MS));
+    assert(DelayQueue_deq(queue) == &elements[1]);
+    assert(DelayQueue_deq(queue) == &elements[2]);
+    assert(DelayQueue_deq(queue) == &elements[0]);
+
+    // both come due in the wheel; the first deq moves the second to the ready list
+    assert(DelayQueue_enq(queue, &elements[3], start + 2 * MS));
+    assert(DelayQueue_enq(queue, &elements[4], start + 3 * MS));
+    nanosleep(&delay, NULL);
+    assert(DelayQueue_tryDeq(queue) == &elements[3]);
+    assert(DelayQueue_enq(queue, &elements[0], start - 10 * MS));
+    assert(DelayQueue_tryDeq(queue) == &elements[0]);
+    assert(DelayQueue_tryDeq(queue) == &elements[4]);
+    return TEST_SUCCESS;
+}
+
+// Checks that a consumer sleeping until a late deadline is woken by an earlier enq.
+int earlierEnqWakesConsumer() {
+    int late = 1, early = 2;
+    struct timespec delay = {0, 20 * MS};
+    pthread_t consumer;
+    void *got;
+
+    assert(DelayQueue_enqAfter(queue, &late, 10000 * MS));
+    pthread_create(&consumer, NULL, deqOne, NULL);
+    nanosleep(&delay, NULL);
+    long start = DelayQueue_nowNs();
+    assert(DelayQueue_enqAfter(queue, &early, 20 * MS));
+    pthread_join(consumer, &got);
+    assert(got == &early);
+    assert(DelayQueue_nowNs() - start < 1000 * MS);
+    assert(DelayQueue_size(queue) == 1);
+    return TEST_SUCCESS;
+}
+
+// Checks that deadlines spread over several wheel levels cascade down and come out in order.
+int deadlinesCascadeAcrossLevels() {
+    DelayQueue *fine = new_DelayQueue(DEFAULT_MAX_QUEUE_SIZE, 1000); // 1us ticks
+    long delays[4] = {200 * MS, 50 * 1000, 5 * MS, 60 * MS};
+    int order[4] = {1, 2, 3, 0};
+    Timer timers[4];
+
+    long start = DelayQueue_nowNs();
+    for (int i = 0; i < 4; i++) {
+        timers[i].ready_at = start + delays[i];
+        assert(DelayQueue_enq(fine, &timers[i], timers[i].ready_at));
+    }
+    for (int i = 0; i < 4; i++) {
+        Timer *timer = DelayQueue_deq(fine);
+        assert(timer == &timers[order[i]]);
+        assert(DelayQueue_nowNs() >= timer->ready_at);
+    }
+    DelayQueue_destroy(fine);
+    return TEST_SUCCESS;
+}
+
+// Checks that many pending deadlines are each released no earlier than due, in deadline order to the tick.
+int manyPendingDeadlines() {
+    DelayQueue *large = new_DelayQueue(MANY_PENDING, 100 * 1000); // 100us ticks
+    static Timer timers[MANY_PENDING];
+    unsigned seed = 1;
+    long start = DelayQueue_nowNs(), previous = 0;
+    bool on_time = true;
+
+    for (int i = 0; i < MANY_PENDING; i++) {
+        seed = seed * 1103515245 + 12345;
+        timers[i].ready_at = start + (seed >> 8) % (100 * MS);
+        assert(DelayQueue_enq(large, &timers[i], timers[i].ready_at));
+    }
+    assert(DelayQueue_size(large) == MANY_PENDING);
+    for (int i = 0; i < MANY_PENDING; i++) {
+        Timer *timer = DelayQueue_deq(large);
+        on_time = on_time && DelayQueue_nowNs() >= timer->ready_at;
+        on_time = on_time && (timer->ready_at + 99999) / (100 * 1000) >= (previous + 99999) / (100 * 1000);
+        previous = timer->ready_at;
+    }
+    assert(on_time);
+    assert(DelayQueue_size(large) == 0);
+    DelayQueue_destroy(large);
+    return TEST_SUCCESS;
+}
+
+// Checks that an enq on a full queue blocks until a deq frees room.
+int enqBlocksWhenFull() {
+    int elements[DEFAULT_MAX_QUEUE_SIZE + 1];
+    struct timespec delay = {0, 20 * MS};
+    pthread_t producer;
+
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(DelayQueue_enq(queue, &elements[i], 0));
+    }
+    pthread_create(&producer, NULL, enqNow, &elements[DEFAULT_MAX_QUEUE_SIZE]);
+    nanosleep(&delay, NULL);
+    assert(DelayQueue_size(queue) == DEFAULT_MAX_QUEUE_SIZE);
+    assert(DelayQueue_deq(queue) == &elements[0]);
+    pthread_join(producer, NULL);
+    assert(DelayQueue_size(queue) == DEFAULT_MAX_QUEUE_SIZE);
+    return TEST_SUCCESS;
+}
+
+/*
+    **************** Exceptional test cases ****************
+*/
+
+// Checks that NULL elements are rejected.
+int enqRejectsNull() {
+    assert(!DelayQueue_enq(queue, NULL, 0));
+    assert(!DelayQueue_enqAfter(queue, NULL, MS));
+    assert(DelayQueue_size(queue) == 0);
+    return TEST_SUCCESS;
+}
+
+// Checks that a deadline beyond the top wheel level is held back rather than lost or released early.
+int farDeadlineWaitsInOverflow() {
+    DelayQueue *fine = new_DelayQueue(DEFAULT_MAX_QUEUE_SIZE, 1); // 1ns ticks, so the wheel spans about 68s
+    int far = 1, near = 2;
+
+    assert(DelayQueue_enqAfter(fine, &far, 100000 * MS));
+    assert(DelayQueue_enqAfter(fine, &near, 5 * MS));
+    assert(DelayQueue_deq(fine) == &near);
+    assert(DelayQueue_tryDeq(fine) == NULL);
+    assert(DelayQueue_size(fine) == 1);
+    DelayQueue_destroy(fine);
+    return TEST_SUCCESS;
+}
+
+// Checks that empty queues and non-positive ticks are refused.
+int constructionFailures() {
+    assert(new_DelayQueue(0, DELAY_QUEUE_DEFAULT_TICK_NS) == NULL);
+    assert(new_DelayQueue(DEFAULT_MAX_QUEUE_SIZE, 0) == NULL);
+    return TEST_SUCCESS;
+}
+
+/*
+ * Main function for the DelayQueue tests which will run each user-defined test in turn.
+ */
+
+int main() {
+    runTest(newQueueIsEmpty);
+    runTest(pastDeadlineIsReady);
+    runTest(futureDeadlineWaits);
+    runTest(deadlinesComeOutInOrder);
+    runTest(passedDeadlinesComeOutInOrder);
+    runTest(earlierEnqWakesConsumer);
+    runTest(deadlinesCascadeAcrossLevels);
+    runTest(manyPendingDeadlines);
+    runTest(enqBlocksWhenFull);
+
+    runTest(enqRejectsNull);
+    runTest(farDeadlineWaitsInOverflow);
+    runTest(constructionFailures);
+
+    printf("DelayQueue Tests complete: %d / %d tests successful.\n----------------\n", success_count, total_count);
+
+}
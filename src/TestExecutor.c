@@ -0,0 +1,273 @@
+/*
+ * TestExecutor.c
+ *
+ * Very simple unit test file for Executor functionality.
+ *
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "Executor.h"
+#include "myassert.h"
+
+
+#define DEFAULT_WORKER_COUNT 4
+#define TASK_COUNT 10000
+
+/*
+ * The executor to use during tests
+ */
+static Executor *executor;
+
+/*
+ * The number of tests that succeeded
+ */
+static int success_count = 0;
+
+/*
+ * The total number of tests run
+ */
+static int total_count = 0;
+
+/*
+ * Counts tasks run, and holds blocking tasks until released
+ */
+static atomic_int runs;
+static atomic_bool released;
+
+
+/*
+ * Setup function to run prior to each test
+ */
+void setup(){
+    executor = new_Executor(DEFAULT_WORKER_COUNT);
+    atomic_store(&runs, 0);
+    atomic_store(&released, false);
+    total_count++;
+}
+
+/*
+ * Teardown function to run after each test
+ */
+void teardown(){
+    atomic_store(&released, true); // so a failed test does not leave blocked tasks behind
+    Executor_destroy(executor);
+}
+
+/*
+ * This function is called multiple times from main for each user-defined test function
+ */
+void runTest(int (*testFunction)()) {
+    setup();
+
+    if (testFunction()) success_count++;
+
+    teardown();
+}
+
+static void sleepMs(long ms) {
+    struct timespec delay = {ms / 1000, (ms % 1000) * 1000000};
+    nanosleep(&delay, NULL);
+}
+
+// Returns its argument doubled
+void* doubleTask(void* arg) {
+    return (void*)((intptr_t)arg * 2);
+}
+
+// Counts that it ran
+void* countTask(void* arg) {
+    (void)arg;
+    atomic_fetch_add(&runs, 1);
+    return NULL;
+}
+
+// Submits arg more counting tasks from inside the pool, then counts itself
+void* spawnTask(void* arg) {
+    for (intptr_t i = 0; i < (intptr_t)arg; i++) {
+        Executor_execute(executor, countTask, NULL);
+    }
+    atomic_fetch_add(&runs, 1);
+    return NULL;
+}
+
+// Returns the arg'th Fibonacci number, computing both halves as child tasks it waits on
+void* fibTask(void* arg) {
+    intptr_t n = (intptr_t)arg;
+    if (n < 2)
+        return arg;
+
+    ExecutorFuture *left = Executor_submit(executor, fibTask, (void*)(n - 1));
+    ExecutorFuture *right = Executor_submit(executor, fibTask, (void*)(n - 2));
+    intptr_t sum = (intptr_t)ExecutorFuture_get(left) + (intptr_t)ExecutorFuture_get(right);
+    ExecutorFuture_destroy(left);
+    ExecutorFuture_destroy(right);
+    return (void*)sum;
+}
+
+// Waits until the test releases it, then counts that it ran
+void* blockTask(void* arg) {
+    (void)arg;
+    while (!atomic_load(&released))
+        sleepMs(1);
+    atomic_fetch_add(&runs, 1);
+    return NULL;
+}
+
+// Shuts the executor down, then counts that it returned
+void* shutdownThread(void* arg) {
+    atomic_int *returned = arg;
+    Executor_shutdown(executor);
+    atomic_fetch_add(returned, 1);
+    return NULL;
+}
+
+
+/*
+    **************** Regular test cases ****************
+*/
+
+// Checks that the Executor constructor starts the requested workers.
+int newExecutorHasWorkers() {
+    assert(executor != NULL);
+    assert(Executor_workerCount(executor) == DEFAULT_WORKER_COUNT);
+    return TEST_SUCCESS;
+}
+
+// Checks that futures return each task's result.
+int submitReturnsResult() {
+    ExecutorFuture *futures[100];
+    for (intptr_t i = 0; i < 100; i++) {
+        futures[i] = Executor_submit(executor, doubleTask, (void*)i);
+        assert(futures[i] != NULL);
+    }
+    for (intptr_t i = 0; i < 100; i++) {
+        assert((intptr_t)ExecutorFuture_get(futures[i]) == i * 2);
+        assert(ExecutorFuture_isDone(futures[i]));
+        ExecutorFuture_destroy(futures[i]);
+    }
+    return TEST_SUCCESS;
+}
+
+// Checks that shutdown waits for every queued task, including tasks submitted by tasks.
+int shutdownDrainsQueuedWork() {
+    for (int i = 0; i < TASK_COUNT / 10; i++) {
+        assert(Executor_execute(executor, spawnTask, (void*)9));
+    }
+    Executor_shutdown(executor);
+    assert(atomic_load(&runs) == TASK_COUNT);
+    return TEST_SUCCESS;
+}
+
+// Checks that a future can be released before its task has run.
+int destroyFutureBeforeRun() {
+    ExecutorFuture *future = Executor_submit(executor, countTask, NULL);
+    assert(future != NULL);
+    ExecutorFuture_destroy(future);
+    Executor_shutdown(executor);
+    assert(atomic_load(&runs) == 1);
+    return TEST_SUCCESS;
+}
+
+// Checks that an elastic executor grows while its workers are busy and shrinks back when idle.
+int elasticGrowsAndShrinks() {
+    Executor_destroy(executor);
+    executor = new_ElasticExecutor(1, DEFAULT_WORKER_COUNT);
+    assert(executor != NULL);
+
+    for (int i = 0; i < DEFAULT_WORKER_COUNT * 2; i++) {
+        assert(Executor_execute(executor, blockTask, NULL));
+    }
+    sleepMs(50);
+    assert(Executor_workerCount(executor) > 1);
+
+    atomic_store(&released, true);
+    for (int i = 0; i < 1000 && atomic_load(&runs) < DEFAULT_WORKER_COUNT * 2; i++)
+        sleepMs(1);
+    assert(atomic_load(&runs) == DEFAULT_WORKER_COUNT * 2);
+    for (int i = 0; i < 1000 && Executor_workerCount(executor) > 1; i++)
+        sleepMs(1);
+    assert(Executor_workerCount(executor) == 1);
+    return TEST_SUCCESS;
+}
+
+// Checks that a task waiting on its own children finishes on a single worker, which must run them itself.
+int nestedGetOnOneWorker() {
+    Executor_destroy(executor);
+    executor = new_Executor(1);
+    assert(executor != NULL);
+
+    ExecutorFuture *future = Executor_submit(executor, fibTask, (void*)10);
+    assert(future != NULL);
+    assert((intptr_t)ExecutorFuture_get(future) == 55);
+    ExecutorFuture_destroy(future);
+    return TEST_SUCCESS;
+}
+
+// Checks that deeply nested tasks waiting on children spread over several workers finish.
+int nestedGetAcrossWorkers() {
+    ExecutorFuture *future = Executor_submit(executor, fibTask, (void*)18);
+    assert(future != NULL);
+    assert((intptr_t)ExecutorFuture_get(future) == 2584);
+    ExecutorFuture_destroy(future);
+    return TEST_SUCCESS;
+}
+
+// Checks that a second shutdown waits for the first one's tasks and workers instead of returning early.
+int concurrentShutdownsBothWait() {
+    pthread_t threads[2];
+    atomic_int returned = 0;
+
+    for (int i = 0; i < DEFAULT_WORKER_COUNT; i++) {
+        assert(Executor_execute(executor, blockTask, NULL));
+    }
+    for (int i = 0; i < 2; i++) {
+        pthread_create(&threads[i], NULL, shutdownThread, &returned);
+    }
+    sleepMs(50);
+    assert(atomic_load(&returned) == 0);
+
+    atomic_store(&released, true);
+    for (int i = 0; i < 2; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    assert(atomic_load(&returned) == 2);
+    assert(atomic_load(&runs) == DEFAULT_WORKER_COUNT);
+    assert(executor->live_threads == 0);
+    return TEST_SUCCESS;
+}
+
+/*
+    **************** Exceptional test cases ****************
+*/
+
+// Checks that tasks are rejected after shutdown.
+int submitAfterShutdown() {
+    Executor_shutdown(executor);
+    assert(Executor_submit(executor, countTask, NULL) == NULL);
+    assert(!Executor_execute(executor, countTask, NULL));
+    return TEST_SUCCESS;
+}
+
+/*
+ * Main function for the Executor tests which will run each user-defined test in turn.
+ */
+
+int main() {
+    runTest(newExecutorHasWorkers);
+    runTest(submitReturnsResult);
+    runTest(shutdownDrainsQueuedWork);
+    runTest(destroyFutureBeforeRun);
+    runTest(elasticGrowsAndShrinks);
+    runTest(nestedGetOnOneWorker);
+    runTest(nestedGetAcrossWorkers);
+    runTest(concurrentShutdownsBothWait);
+
+    runTest(submitAfterShutdown);
+
+    printf("\nExecutor Tests complete: %d / %d tests successful.\n----------------\n", success_count, total_count);
+
+}
@@ -0,0 +1,217 @@
+/*
+ * TestMpmcQueue.c
+ *
+ * Very simple unit test file for MpmcQueue functionality.
+ *
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include "MpmcQueue.h"
+#include "myassert.h"
+
+
+#define DEFAULT_MAX_QUEUE_SIZE 20
+#define THREAD_COUNT 4
+#define TRANSFER_COUNT 20000
+
+/*
+ * The queue to use during tests
+ */
+static MpmcQueue *queue;
+
+/*
+ * The number of tests that succeeded
+ */
+static int success_count = 0;
+
+/*
+ * The total number of tests run
+ */
+static int total_count = 0;
+
+
+/*
+ * Setup function to run prior to each test
+ */
+void setup(){
+    queue = new_MpmcQueue(DEFAULT_MAX_QUEUE_SIZE);
+    total_count++;
+}
+
+/*
+ * Teardown function to run after each test
+ */
+void teardown(){
+    MpmcQueue_destroy(queue);
+}
+
+/*
+ * This function is called multiple times from main for each user-defined test function
+ */
+void runTest(int (*testFunction)()) {
+    setup();
+
+    if (testFunction()) success_count++;
+
+    teardown();
+}
+
+/*
+ * Counts how many times each token was dequeued
+ */
+static atomic_int seen[THREAD_COUNT * TRANSFER_COUNT + 1];
+
+// Producer thread which enqueues its own range of TRANSFER_COUNT tokens, spinning while full
+void* producerFunc(void* arg) {
+    intptr_t first = (intptr_t)arg * TRANSFER_COUNT + 1;
+    for (intptr_t i = first; i < first + TRANSFER_COUNT; i++) {
+        while (!MpmcQueue_tryEnq(queue, (void*)i))
+            sched_yield();
+    }
+    return NULL;
+}
+
+// Consumer thread which dequeues TRANSFER_COUNT tokens, spinning while empty
+void* consumerFunc(void* arg) {
+    (void)arg;
+    for (int i = 0; i < TRANSFER_COUNT; i++) {
+        void *token;
+        while ((token = MpmcQueue_tryDeq(queue)) == NULL)
+            sched_yield();
+        atomic_fetch_add(&seen[(intptr_t)token], 1);
+    }
+    return NULL;
+}
+
+
+/*
+    **************** Regular test cases ****************
+*/
+
+// Checks that the MpmcQueue constructor returns a non-NULL pointer.
+int newQueueIsNotNull() {
+    assert(queue != NULL);
+    return TEST_SUCCESS;
+}
+
+// Checks that the size of an empty queue is 0.
+int newQueueSizeZero() {
+    assert(MpmcQueue_size(queue) == 0);
+    assert(MpmcQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks that enqueuing and dequeuing elements keeps FIFO order.
+int enqAndDeqMultipleElements() {
+    int elements[] = {1, 2, 3, 4, 5};
+    for (int i = 0; i < 5; i++) {
+        assert(MpmcQueue_tryEnq(queue, &elements[i]));
+    }
+    assert(MpmcQueue_size(queue) == 5);
+    for (int i = 0; i < 5; i++) {
+        assert(MpmcQueue_tryDeq(queue) == &elements[i]);
+    }
+    assert(MpmcQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks the size of the queue is correct after it wraps around
+int sizeAfterWrapping() {
+    int element = 5;
+    for (int i = 0; i < 15; i++) {
+        assert(MpmcQueue_tryEnq(queue, &element));
+    }
+    for (int i = 0; i < 15; i++) {
+        assert(MpmcQueue_tryDeq(queue) == &element);
+    }
+    for (int i = 0; i < 11; i++) {
+        assert(MpmcQueue_tryEnq(queue, &element));
+    }
+    assert(MpmcQueue_size(queue) == 11);
+    return TEST_SUCCESS;
+}
+
+// Checks clear function works correctly
+int clearQueue() {
+    int element = 5;
+    for (int i = 0; i < 5; i++) {
+        assert(MpmcQueue_tryEnq(queue, &element));
+    }
+    MpmcQueue_clear(queue);
+    assert(MpmcQueue_isEmpty(queue));
+    assert(MpmcQueue_tryDeq(queue) == NULL);
+    assert(MpmcQueue_tryEnq(queue, &element));
+    assert(MpmcQueue_tryDeq(queue) == &element);
+    return TEST_SUCCESS;
+}
+
+/*
+    **************** Edge and exceptional test cases ****************
+*/
+
+// Checks that tryEnq fails once the queue is at its maximum capacity.
+int tryEnqOverMax() {
+    int element = 5;
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(MpmcQueue_tryEnq(queue, &element));
+    }
+    assert(!MpmcQueue_tryEnq(queue, &element));
+    assert(MpmcQueue_size(queue) == DEFAULT_MAX_QUEUE_SIZE);
+    return TEST_SUCCESS;
+}
+
+// Checks that NULL elements are rejected and empty dequeues return NULL.
+int enqNullAndDeqEmpty() {
+    assert(!MpmcQueue_tryEnq(queue, NULL));
+    assert(MpmcQueue_tryDeq(queue) == NULL);
+    return TEST_SUCCESS;
+}
+
+/*
+    **************** Concurrency test cases ****************
+*/
+
+// Checks that several producers and consumers transfer every token exactly once.
+int multiProducerMultiConsumer() {
+    pthread_t producers[THREAD_COUNT], consumers[THREAD_COUNT];
+
+    for (intptr_t i = 0; i < THREAD_COUNT; i++) {
+        pthread_create(&producers[i], NULL, producerFunc, (void*)i);
+        pthread_create(&consumers[i], NULL, consumerFunc, NULL);
+    }
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], NULL);
+    }
+
+    for (int i = 1; i <= THREAD_COUNT * TRANSFER_COUNT; i++) {
+        assert(atomic_load(&seen[i]) == 1);
+    }
+    assert(MpmcQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+/*
+ * Main function for the MpmcQueue tests which will run each user-defined test in turn.
+ */
+
+int main() {
+    runTest(newQueueIsNotNull);
+    runTest(newQueueSizeZero);
+    runTest(enqAndDeqMultipleElements);
+    runTest(sizeAfterWrapping);
+    runTest(clearQueue);
+
+    runTest(tryEnqOverMax);
+    runTest(enqNullAndDeqEmpty);
+
+    runTest(multiProducerMultiConsumer);
+
+    printf("\nMpmcQueue Tests complete: %d / %d tests successful.\n----------------\n", success_count, total_count);
+
+}
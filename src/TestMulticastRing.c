@@ -0,0 +1,239 @@
+/*
+ * TestMulticastRing.c
+ *
+ * Very simple unit test file for MulticastRing functionality.
+ *
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "MulticastRing.h"
+#include "myassert.h"
+
+
+#define DEFAULT_RING_SIZE 8
+#define TRANSFER_COUNT 100000
+#define FAN_OUT 3
+
+/*
+ * The ring to use during tests
+ */
+static MulticastRing *ring;
+
+/*
+ * The number of tests that succeeded
+ */
+static int success_count = 0;
+
+/*
+ * The total number of tests run
+ */
+static int total_count = 0;
+
+
+/*
+ * Setup function to run prior to each test
+ */
+void setup(){
+    ring = new_MulticastRing(DEFAULT_RING_SIZE);
+    total_count++;
+}
+
+/*
+ * Teardown function to run after each test
+ */
+void teardown(){
+    MulticastRing_destroy(ring);
+}
+
+/*
+ * This function is called multiple times from main for each user-defined test function
+ */
+void runTest(int (*testFunction)()) {
+    setup();
+
+    if (testFunction()) success_count++;
+
+    teardown();
+}
+
+/*
+ * Per-consumer arguments for the threaded tests
+ */
+typedef struct Reader {
+    MulticastCursor* cursor;
+    int batch;
+    bool ordered;
+} Reader;
+
+// Reads TRANSFER_COUNT elements through its cursor, checking they arrive in order
+void* readAll(void* arg) {
+    Reader *reader = arg;
+    void *out[reader->batch];
+    uintptr_t expected = 1;
+
+    reader->ordered = true;
+    while (expected <= TRANSFER_COUNT) {
+        int n = MulticastCursor_read(reader->cursor, out, reader->batch);
+        for (int i = 0; i < n; i++) {
+            reader->ordered = reader->ordered && (uintptr_t)out[i] == expected;
+            expected++;
+        }
+    }
+    return NULL;
+}
+
+
+/*
+    **************** Regular test cases ****************
+*/
+
+// Checks that a new ring has nothing published and rounds its size up to a power of two.
+int newRingIsEmpty() {
+    MulticastRing *odd = new_MulticastRing(5);
+    assert(ring != NULL && odd != NULL);
+    assert(odd->size == 8);
+    assert(MulticastRing_published(ring) == 0);
+    assert(MulticastRing_readMin(ring) == 0);
+    MulticastRing_destroy(odd);
+    return TEST_SUCCESS;
+}
+
+// Checks that every cursor reads every published element.
+int everyCursorSeesEveryElement() {
+    MulticastCursor *a = MulticastRing_addCursor(ring, NULL), *b = MulticastRing_addCursor(ring, NULL);
+    int elements[3] = {1, 2, 3};
+    void *out[4];
+
+    assert(a != NULL && b != NULL);
+    for (int i = 0; i < 3; i++) {
+        assert(MulticastRing_publish(ring, &elements[i]));
+    }
+    assert(MulticastCursor_available(a) == 3);
+    assert(MulticastCursor_read(a, out, 4) == 3);
+    assert(out[0] == &elements[0] && out[2] == &elements[2]);
+    assert(MulticastRing_readMin(ring) == 0);
+
+    assert(MulticastCursor_read(b, out, 2) == 2);
+    assert(out[1] == &elements[1]);
+    assert(MulticastCursor_read(b, out, 2) == 1);
+    assert(out[0] == &elements[2]);
+    assert(MulticastRing_readMin(ring) == 3);
+    assert(MulticastCursor_tryRead(a, out, 4) == 0);
+    return TEST_SUCCESS;
+}
+
+// Checks that the producer is held back by the slowest cursor only, and a batch publishes in order.
+int producerGatedBySlowest() {
+    MulticastCursor *fast = MulticastRing_addCursor(ring, NULL), *slow = MulticastRing_addCursor(ring, NULL);
+    int element = 5;
+    void *batch[DEFAULT_RING_SIZE], *out[DEFAULT_RING_SIZE];
+
+    for (int i = 0; i < DEFAULT_RING_SIZE; i++) {
+        batch[i] = &element;
+    }
+    assert(MulticastRing_publishBatch(ring, batch, DEFAULT_RING_SIZE));
+    assert(MulticastCursor_read(fast, out, DEFAULT_RING_SIZE) == DEFAULT_RING_SIZE);
+    assert(!MulticastRing_tryPublish(ring, &element));
+
+    assert(MulticastCursor_read(slow, out, 2) == 2);
+    assert(MulticastRing_tryPublish(ring, &element));
+    assert(MulticastRing_tryPublish(ring, &element));
+    assert(!MulticastRing_tryPublish(ring, &element));
+    assert(MulticastRing_published(ring) == DEFAULT_RING_SIZE + 2);
+    return TEST_SUCCESS;
+}
+
+// Checks that a dependent cursor only reads what its upstream cursor has read.
+int dependentCursorFollowsUpstream() {
+    MulticastCursor *first = MulticastRing_addCursor(ring, NULL);
+    MulticastCursor *second = MulticastRing_addCursor(ring, first);
+    int elements[2] = {1, 2};
+    void *out[2];
+
+    assert(second != NULL);
+    assert(MulticastRing_publish(ring, &elements[0]));
+    assert(MulticastRing_publish(ring, &elements[1]));
+    assert(MulticastCursor_tryRead(second, out, 2) == 0);
+    assert(MulticastCursor_read(first, out, 1) == 1);
+    assert(MulticastCursor_read(second, out, 2) == 1);
+    assert(out[0] == &elements[0]);
+    assert(MulticastCursor_tryRead(second, out, 2) == 0);
+    return TEST_SUCCESS;
+}
+
+// Checks that several consumer threads each receive the whole stream in order, in batches of any size.
+int threadedFanOut() {
+    pthread_t threads[FAN_OUT];
+    Reader readers[FAN_OUT];
+
+    for (int i = 0; i < FAN_OUT; i++) {
+        readers[i].cursor = MulticastRing_addCursor(ring, i == FAN_OUT - 1 ? readers[0].cursor : NULL);
+        readers[i].batch = 1 + i * 5;
+        assert(readers[i].cursor != NULL);
+    }
+    for (int i = 0; i < FAN_OUT; i++) {
+        pthread_create(&threads[i], NULL, readAll, &readers[i]);
+    }
+    for (uintptr_t i = 1; i <= TRANSFER_COUNT; i++) {
+        MulticastRing_publish(ring, (void *)i);
+    }
+    for (int i = 0; i < FAN_OUT; i++) {
+        pthread_join(threads[i], NULL);
+        assert(readers[i].ordered);
+    }
+    assert(MulticastRing_readMin(ring) == TRANSFER_COUNT);
+    return TEST_SUCCESS;
+}
+
+/*
+    **************** Exceptional test cases ****************
+*/
+
+// Checks that NULL elements are rejected, and a batch holding one publishes nothing.
+int publishRejectsNull() {
+    int element = 1;
+    void *batch[3] = {&element, NULL, &element};
+
+    assert(!MulticastRing_publish(ring, NULL));
+    assert(!MulticastRing_tryPublish(ring, NULL));
+    assert(!MulticastRing_publishBatch(ring, batch, 3));
+    assert(MulticastRing_published(ring) == 0);
+    return TEST_SUCCESS;
+}
+
+// Checks that bad sizes, foreign upstream cursors and too many cursors are refused.
+int constructionFailures() {
+    MulticastRing *other = new_MulticastRing(DEFAULT_RING_SIZE);
+    MulticastCursor *foreign = MulticastRing_addCursor(other, NULL);
+
+    assert(new_MulticastRing(0) == NULL);
+    assert(MulticastRing_addCursor(ring, foreign) == NULL);
+    for (int i = 0; i < MULTICAST_MAX_CURSORS; i++) {
+        assert(MulticastRing_addCursor(ring, NULL) != NULL);
+    }
+    assert(MulticastRing_addCursor(ring, NULL) == NULL);
+    MulticastRing_destroy(other);
+    return TEST_SUCCESS;
+}
+
+/*
+ * Main function for the MulticastRing tests which will run each user-defined test in turn.
+ */
+
+int main() {
+    runTest(newRingIsEmpty);
+    runTest(everyCursorSeesEveryElement);
+    runTest(producerGatedBySlowest);
+    runTest(dependentCursorFollowsUpstream);
+    runTest(threadedFanOut);
+
+    runTest(publishRejectsNull);
+    runTest(constructionFailures);
+
+    printf("MulticastRing Tests complete: %d / %d tests successful.\n----------------\n", success_count, total_count);
+
+}
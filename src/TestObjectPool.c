@@ -0,0 +1,274 @@
+/*
+ * TestObjectPool.c
+ *
+ * Very simple unit test file for ObjectPool functionality.
+ *
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "ObjectPool.h"
+#include "BlockingQueue.h"
+#include "myassert.h"
+
+
+#define DEFAULT_POOL_SIZE 64
+#define DEFAULT_OBJECT_SIZE 40
+#define DEFAULT_BATCH 8
+#define TRANSFER_COUNT 100000
+
+/*
+ * The pool to use during tests
+ */
+static ObjectPool *pool;
+
+/*
+ * The number of tests that succeeded
+ */
+static int success_count = 0;
+
+/*
+ * The total number of tests run
+ */
+static int total_count = 0;
+
+
+/*
+ * Setup function to run prior to each test
+ */
+void setup(){
+    pool = new_ObjectPool(DEFAULT_POOL_SIZE, DEFAULT_OBJECT_SIZE, DEFAULT_BATCH);
+    total_count++;
+}
+
+/*
+ * Teardown function to run after each test
+ */
+void teardown(){
+    ObjectPool_destroy(pool);
+}
+
+/*
+ * This function is called multiple times from main for each user-defined test function
+ */
+void runTest(int (*testFunction)()) {
+    setup();
+
+    if (testFunction()) success_count++;
+
+    teardown();
+}
+
+/*
+ * A payload passed from producer to consumer, and back through the pool
+ */
+typedef struct Message {
+    long sequence;
+    char body[DEFAULT_OBJECT_SIZE - sizeof(long)];
+} Message;
+
+// Fills TRANSFER_COUNT pooled messages in order and enqueues them on the queue passed in
+void* produceMessages(void* arg) {
+    BlockingQueue *queue = arg;
+
+    for (long i = 0; i < TRANSFER_COUNT; i++) {
+        Message *message = ObjectPool_get(pool);
+        message->sequence = i;
+        BlockingQueue_enq(queue, message);
+    }
+    return NULL;
+}
+
+// Gets one object, waiting for it, and returns it
+void* getOne(void* arg) {
+    (void)arg;
+    return ObjectPool_get(pool);
+}
+
+// Takes every object, then puts them all back, leaving them in this thread's cache and the central stack
+void* takeAndReturnAll(void* arg) {
+    (void)arg;
+    void *objects[DEFAULT_POOL_SIZE];
+
+    for (int i = 0; i < DEFAULT_POOL_SIZE; i++) {
+        objects[i] = ObjectPool_get(pool);
+    }
+    for (int i = 0; i < DEFAULT_POOL_SIZE; i++) {
+        ObjectPool_put(pool, objects[i]);
+    }
+    return NULL;
+}
+
+
+/*
+    **************** Regular test cases ****************
+*/
+
+// Checks that a new pool hands out every object once, each aligned and inside the pool, then runs dry.
+int newPoolHandsOutEveryObject() {
+    void *objects[DEFAULT_POOL_SIZE];
+
+    assert(pool != NULL);
+    assert(ObjectPool_available(pool) == DEFAULT_POOL_SIZE);
+    for (int i = 0; i < DEFAULT_POOL_SIZE; i++) {
+        objects[i] = ObjectPool_tryGet(pool);
+        assert(objects[i] != NULL && ObjectPool_owns(pool, objects[i]));
+        assert((uintptr_t)objects[i] % _Alignof(max_align_t) == 0);
+        for (int j = 0; j < i; j++) {
+            assert(objects[j] != objects[i]);
+        }
+    }
+    assert(ObjectPool_tryGet(pool) == NULL);
+    assert(ObjectPool_available(pool) == 0);
+    return TEST_SUCCESS;
+}
+
+// Checks that a put object is available again, and the same thread gets it back first.
+int putMakesObjectReusable() {
+    void *object = ObjectPool_get(pool);
+
+    assert(ObjectPool_available(pool) == DEFAULT_POOL_SIZE - 1);
+    assert(ObjectPool_put(pool, object));
+    assert(ObjectPool_available(pool) == DEFAULT_POOL_SIZE);
+    assert(ObjectPool_get(pool) == object);
+    return TEST_SUCCESS;
+}
+
+// Checks that a batch put returns every object, spilling past the cache to the central stack.
+int putBatchReturnsEverything() {
+    void *objects[DEFAULT_POOL_SIZE];
+
+    for (int i = 0; i < DEFAULT_POOL_SIZE; i++) {
+        objects[i] = ObjectPool_get(pool);
+    }
+    assert(ObjectPool_putBatch(pool, objects, DEFAULT_POOL_SIZE));
+    assert(ObjectPool_available(pool) == DEFAULT_POOL_SIZE);
+    assert(pool->free_count <= DEFAULT_POOL_SIZE - DEFAULT_BATCH);
+    return TEST_SUCCESS;
+}
+
+// Checks that objects a consumer hands back are recycled by the producer through a queue, in order.
+int recyclesThroughQueue() {
+    BlockingQueue *queue = new_BlockingQueue(DEFAULT_POOL_SIZE / 2);
+    pthread_t producer;
+    bool ordered = true;
+
+    pthread_create(&producer, NULL, produceMessages, queue);
+    for (long i = 0; i < TRANSFER_COUNT; i++) {
+        Message *message = BlockingQueue_deq(queue);
+        ordered = ordered && ObjectPool_owns(pool, message) && message->sequence == i;
+        ObjectPool_put(pool, message);
+    }
+    pthread_join(producer, NULL);
+
+    assert(ordered);
+    assert(ObjectPool_available(pool) == DEFAULT_POOL_SIZE);
+    BlockingQueue_destroy(queue);
+    return TEST_SUCCESS;
+}
+
+// Checks that a get on an exhausted pool blocks until an object is put back.
+int getBlocksUntilPut() {
+    void *objects[DEFAULT_POOL_SIZE], *got;
+    struct timespec delay = {0, 20 * 1000 * 1000};
+    pthread_t getter;
+
+    for (int i = 0; i < DEFAULT_POOL_SIZE; i++) {
+        objects[i] = ObjectPool_get(pool);
+    }
+    pthread_create(&getter, NULL, getOne, NULL);
+    nanosleep(&delay, NULL);
+    assert(ObjectPool_put(pool, objects[3]));
+    pthread_join(getter, &got);
+    assert(got == objects[3]);
+    assert(ObjectPool_available(pool) == 0);
+    return TEST_SUCCESS;
+}
+
+// Checks that objects left in another thread's cache can still be got by this one.
+int getStealsFromOtherCaches() {
+    pthread_t other;
+
+    pthread_create(&other, NULL, takeAndReturnAll, NULL);
+    pthread_join(other, NULL);
+    assert(ObjectPool_available(pool) == DEFAULT_POOL_SIZE);
+    for (int i = 0; i < DEFAULT_POOL_SIZE; i++) {
+        assert(ObjectPool_tryGet(pool) != NULL);
+    }
+    assert(ObjectPool_tryGet(pool) == NULL);
+    return TEST_SUCCESS;
+}
+
+/*
+    **************** Exceptional test cases ****************
+*/
+
+// Checks that NULL, foreign and interior pointers are refused, and a batch holding one puts nothing back.
+int putRejectsForeignObjects() {
+    ObjectPool *other = new_ObjectPool(1, DEFAULT_OBJECT_SIZE, 1);
+    char *object = ObjectPool_get(pool);
+    int local = 0;
+    void *batch[2] = {object, &local};
+
+    assert(!ObjectPool_put(pool, NULL));
+    assert(!ObjectPool_put(pool, &local));
+    assert(!ObjectPool_put(pool, object + 1));
+    assert(!ObjectPool_put(pool, ObjectPool_get(other)));
+    assert(!ObjectPool_putBatch(pool, batch, 2));
+    assert(ObjectPool_available(pool) == DEFAULT_POOL_SIZE - 1);
+    ObjectPool_destroy(other);
+    return TEST_SUCCESS;
+}
+
+// Checks that puts the pool has no room for are refused, so a double put cannot overflow the central stack.
+int doublePutsRejected() {
+    void *objects[DEFAULT_POOL_SIZE];
+
+    for (int i = 0; i < DEFAULT_POOL_SIZE; i++) {
+        objects[i] = ObjectPool_get(pool);
+    }
+    assert(ObjectPool_putBatch(pool, objects, DEFAULT_POOL_SIZE));
+    assert(!ObjectPool_putBatch(pool, objects, DEFAULT_POOL_SIZE));
+    assert(!ObjectPool_put(pool, objects[0]));
+    assert(ObjectPool_available(pool) == DEFAULT_POOL_SIZE);
+    assert(pool->free_count <= DEFAULT_POOL_SIZE);
+
+    void *object = ObjectPool_get(pool);
+    void *twice[2] = {object, object};
+    assert(!ObjectPool_putBatch(pool, twice, 2));
+    assert(ObjectPool_put(pool, object));
+    assert(ObjectPool_available(pool) == DEFAULT_POOL_SIZE);
+    return TEST_SUCCESS;
+}
+
+// Checks that empty pools, empty objects and empty batches are refused.
+int constructionFailures() {
+    assert(new_ObjectPool(0, DEFAULT_OBJECT_SIZE, DEFAULT_BATCH) == NULL);
+    assert(new_ObjectPool(DEFAULT_POOL_SIZE, 0, DEFAULT_BATCH) == NULL);
+    assert(new_ObjectPool(DEFAULT_POOL_SIZE, DEFAULT_OBJECT_SIZE, 0) == NULL);
+    return TEST_SUCCESS;
+}
+
+/*
+ * Main function for the ObjectPool tests which will run each user-defined test in turn.
+ */
+
+int main() {
+    runTest(newPoolHandsOutEveryObject);
+    runTest(putMakesObjectReusable);
+    runTest(putBatchReturnsEverything);
+    runTest(recyclesThroughQueue);
+    runTest(getBlocksUntilPut);
+    runTest(getStealsFromOtherCaches);
+
+    runTest(putRejectsForeignObjects);
+    runTest(doublePutsRejected);
+    runTest(constructionFailures);
+
+    printf("ObjectPool Tests complete: %d / %d tests successful.\n----------------\n", success_count, total_count);
+
+}
@@ -0,0 +1,246 @@
+/*
+ * TestPriorityBlockingQueue.c
+ *
+ * Very simple unit test file for PriorityBlockingQueue functionality.
+ *
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "PriorityBlockingQueue.h"
+#include "myassert.h"
+
+
+#define DEFAULT_MAX_QUEUE_SIZE 20
+#define DEFAULT_LEVELS 8
+
+/*
+ * The queue to use during tests
+ */
+static PriorityBlockingQueue *queue;
+
+/*
+ * Whether the queue under test is bucketed rather than heap-backed
+ */
+static bool bucketed = false;
+
+/*
+ * The number of tests that succeeded
+ */
+static int success_count = 0;
+
+/*
+ * The total number of tests run
+ */
+static int total_count = 0;
+
+
+/*
+ * Setup function to run prior to each test
+ */
+void setup(){
+    if (bucketed)
+        queue = new_BucketedPriorityBlockingQueue(DEFAULT_MAX_QUEUE_SIZE, DEFAULT_LEVELS);
+    else
+        queue = new_PriorityBlockingQueue(DEFAULT_MAX_QUEUE_SIZE);
+    total_count++;
+}
+
+/*
+ * Teardown function to run after each test
+ */
+void teardown(){
+    PriorityBlockingQueue_destroy(queue);
+}
+
+/*
+ * This function is called multiple times from main for each user-defined test function
+ */
+void runTest(int (*testFunction)()) {
+    setup();
+
+    if (testFunction()) success_count++;
+
+    teardown();
+}
+
+#define STRESS_THREADS 4
+#define STRESS_COUNT 20000
+
+// Enqueues STRESS_COUNT non-NULL tokens at varying priorities, forcing the small queue through its full path
+void* stressProducer(void* arg) {
+    (void)arg;
+    for (intptr_t i = 1; i <= STRESS_COUNT; i++) {
+        PriorityBlockingQueue_enq(queue, (void*)i, i % DEFAULT_LEVELS);
+    }
+    return NULL;
+}
+
+// Dequeues STRESS_COUNT tokens and returns their sum
+void* stressConsumer(void* arg) {
+    long *sum = arg;
+    for (int i = 0; i < STRESS_COUNT; i++) {
+        *sum += (intptr_t)PriorityBlockingQueue_deq(queue);
+    }
+    return NULL;
+}
+
+
+/*
+    **************** Regular test cases ****************
+*/
+
+// Checks that the PriorityBlockingQueue constructor returns an empty queue.
+int newQueueIsEmpty() {
+    assert(queue != NULL);
+    assert(PriorityBlockingQueue_size(queue) == 0);
+    assert(PriorityBlockingQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks that elements come out lowest priority value first.
+int deqInPriorityOrder() {
+    int priorities[DEFAULT_MAX_QUEUE_SIZE];
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        priorities[i] = (i * 5) % DEFAULT_LEVELS;
+        assert(PriorityBlockingQueue_enq(queue, &priorities[i], priorities[i]));
+    }
+    assert(PriorityBlockingQueue_size(queue) == DEFAULT_MAX_QUEUE_SIZE);
+
+    int last = -1;
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        int priority = *(int*)PriorityBlockingQueue_deq(queue);
+        assert(priority >= last);
+        last = priority;
+    }
+    assert(PriorityBlockingQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks that equal priorities keep the order they were enqueued in.
+int equalPrioritiesAreFifo() {
+    int elements[DEFAULT_MAX_QUEUE_SIZE];
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(PriorityBlockingQueue_enq(queue, &elements[i], i % 2));
+    }
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i += 2) {
+        assert(PriorityBlockingQueue_deq(queue) == &elements[i]);
+    }
+    for (int i = 1; i < DEFAULT_MAX_QUEUE_SIZE; i += 2) {
+        assert(PriorityBlockingQueue_deq(queue) == &elements[i]);
+    }
+    return TEST_SUCCESS;
+}
+
+// Checks that clear empties the queue and frees its space for new elements.
+int sizeAndClear() {
+    int element = 1;
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(PriorityBlockingQueue_enq(queue, &element, i % DEFAULT_LEVELS));
+    }
+    PriorityBlockingQueue_clear(queue);
+    assert(PriorityBlockingQueue_isEmpty(queue));
+
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(PriorityBlockingQueue_enq(queue, &element, 0));
+    }
+    assert(PriorityBlockingQueue_size(queue) == DEFAULT_MAX_QUEUE_SIZE);
+    return TEST_SUCCESS;
+}
+
+// Checks that every element survives concurrent producers and consumers on a small queue.
+int multiProducerMultiConsumer() {
+    pthread_t producers[STRESS_THREADS], consumers[STRESS_THREADS];
+    long sums[STRESS_THREADS] = {0};
+
+    for (int i = 0; i < STRESS_THREADS; i++) {
+        pthread_create(&producers[i], NULL, stressProducer, NULL);
+        pthread_create(&consumers[i], NULL, stressConsumer, &sums[i]);
+    }
+    long total = 0;
+    for (int i = 0; i < STRESS_THREADS; i++) {
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], NULL);
+        total += sums[i];
+    }
+    assert(total == (long)STRESS_THREADS * STRESS_COUNT * (STRESS_COUNT + 1) / 2);
+    assert(PriorityBlockingQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks that the levels of a bucketed queue share its nodes, whichever levels fill up.
+int bucketsShareNodes() {
+    PriorityBlockingQueue *wide = new_BucketedPriorityBlockingQueue(DEFAULT_MAX_QUEUE_SIZE, PRIORITY_QUEUE_MAX_LEVELS);
+    int elements[DEFAULT_MAX_QUEUE_SIZE];
+
+    assert(wide != NULL);
+    for (int round = 0; round < 3; round++) {
+        // every node at the last level, then freed half at a time into the first
+        for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+            assert(PriorityBlockingQueue_enq(wide, &elements[i], PRIORITY_QUEUE_MAX_LEVELS - 1));
+        }
+        for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE / 2; i++) {
+            assert(PriorityBlockingQueue_deq(wide) == &elements[i]);
+        }
+        for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE / 2; i++) {
+            assert(PriorityBlockingQueue_enq(wide, &elements[i], 0));
+        }
+        assert(PriorityBlockingQueue_size(wide) == DEFAULT_MAX_QUEUE_SIZE);
+        for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+            assert(PriorityBlockingQueue_deq(wide) == &elements[i]);
+        }
+    }
+    PriorityBlockingQueue_destroy(wide);
+    return TEST_SUCCESS;
+}
+
+/*
+    **************** Exceptional test cases ****************
+*/
+
+// Checks that NULL elements are rejected.
+int enqRejectsNull() {
+    assert(!PriorityBlockingQueue_enq(queue, NULL, 0));
+    assert(PriorityBlockingQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks that a bucketed queue rejects priorities outside its levels.
+int bucketedRejectsOutOfRange() {
+    int element = 1;
+    assert(!PriorityBlockingQueue_enq(queue, &element, -1));
+    assert(!PriorityBlockingQueue_enq(queue, &element, DEFAULT_LEVELS));
+    assert(PriorityBlockingQueue_isEmpty(queue));
+    assert(new_BucketedPriorityBlockingQueue(DEFAULT_MAX_QUEUE_SIZE, PRIORITY_QUEUE_MAX_LEVELS + 1) == NULL);
+    return TEST_SUCCESS;
+}
+
+/*
+ * Main function for the PriorityBlockingQueue tests which will run each user-defined test in turn.
+ */
+
+int main() {
+    runTest(newQueueIsEmpty);
+    runTest(deqInPriorityOrder);
+    runTest(equalPrioritiesAreFifo);
+    runTest(sizeAndClear);
+    runTest(multiProducerMultiConsumer);
+    runTest(enqRejectsNull);
+
+    // rerun the suite against the bucketed mode
+    bucketed = true;
+    runTest(newQueueIsEmpty);
+    runTest(deqInPriorityOrder);
+    runTest(equalPrioritiesAreFifo);
+    runTest(sizeAndClear);
+    runTest(multiProducerMultiConsumer);
+    runTest(bucketsShareNodes);
+    runTest(enqRejectsNull);
+    runTest(bucketedRejectsOutOfRange);
+
+    printf("\nPriorityBlockingQueue Tests complete: %d / %d tests successful.\n----------------\n", success_count, total_count);
+
+}
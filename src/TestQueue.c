@@ -7,6 +7,7 @@
 
 #include <stdio.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <math.h>
 #include "myassert.h"
 #include "Queue.h"
@@ -29,12 +30,23 @@ static int success_count = 0;
  */
 static int total_count = 0;
 
+/*
+ * Elements handed back by an overflow policy, in the order they were dropped
+ */
+static void *reclaimed[DEFAULT_MAX_QUEUE_SIZE * 4];
+static int reclaimed_count = 0;
+
+static void recordReclaim(void* element) {
+    reclaimed[reclaimed_count++] = element;
+}
+
 
 /*
  * Setup function to run prior to each test
  */
 void setup(){
     queue = new_Queue(DEFAULT_MAX_QUEUE_SIZE);
+    reclaimed_count = 0;
     total_count++;
 }
 
@@ -509,6 +521,228 @@ int enqMaxDequeueAll() {
     return TEST_SUCCESS;
 }
 
+// Checks that enqMany and deqMany keep FIFO order across the wrap point.
+int enqManyDeqManyWrapsAround() {
+    int arr[DEFAULT_MAX_QUEUE_SIZE];
+    void *in[DEFAULT_MAX_QUEUE_SIZE], *out[DEFAULT_MAX_QUEUE_SIZE];
+    int element = 5;
+
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        arr[i] = i;
+        in[i] = &arr[i];
+    }
+    // move head and tail most of the way along the array first
+    for (int i = 0; i < 15; i++) {
+        assert(Queue_enq(queue, &element));
+        assert(Queue_deq(queue) == &element);
+    }
+
+    assert(Queue_enqMany(queue, in, DEFAULT_MAX_QUEUE_SIZE) == DEFAULT_MAX_QUEUE_SIZE);
+    assert(Queue_size(queue) == DEFAULT_MAX_QUEUE_SIZE);
+    assert(Queue_deqMany(queue, out, 8) == 8);
+    assert(Queue_deqMany(queue, out + 8, DEFAULT_MAX_QUEUE_SIZE) == DEFAULT_MAX_QUEUE_SIZE - 8);
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(out[i] == &arr[i]);
+    }
+    assert(Queue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks that peek returns the front element without removing it.
+int peekDoesNotRemove() {
+    int a = 1, b = 2;
+
+    assert(Queue_peek(queue) == NULL);
+    assert(Queue_enq(queue, &a));
+    assert(Queue_enq(queue, &b));
+    assert(Queue_peek(queue) == &a);
+    assert(Queue_size(queue) == 2);
+    assert(Queue_deq(queue) == &a);
+    assert(Queue_peek(queue) == &b);
+    return TEST_SUCCESS;
+}
+
+// Checks that readSpans exposes the elements in place around the wrap point and consume releases them.
+int readSpansAndConsume() {
+    int arr[DEFAULT_MAX_QUEUE_SIZE];
+    int element = 5;
+    QueueSpan first, second;
+
+    assert(Queue_readSpans(queue, &first, &second) == 0);
+    assert(first.count == 0 && second.count == 0);
+
+    // move head and tail most of the way along the array first
+    for (int i = 0; i < 15; i++) {
+        assert(Queue_enq(queue, &element));
+        assert(Queue_deq(queue) == &element);
+    }
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        arr[i] = i;
+        assert(Queue_enq(queue, &arr[i]));
+    }
+
+    assert(Queue_readSpans(queue, &first, &second) == DEFAULT_MAX_QUEUE_SIZE);
+    assert(first.count > 0 && second.count > 0);
+    assert(first.count + second.count == DEFAULT_MAX_QUEUE_SIZE);
+    for (int i = 0; i < first.count; i++) {
+        assert(first.data[i] == &arr[i]);
+    }
+    for (int i = 0; i < second.count; i++) {
+        assert(second.data[i] == &arr[first.count + i]);
+    }
+    assert(Queue_size(queue) == DEFAULT_MAX_QUEUE_SIZE);
+
+    // once the first span is released the rest is contiguous from the start of the array
+    int rest = second.count;
+    assert(Queue_consume(queue, first.count) == first.count);
+    assert(Queue_peek(queue) == &arr[DEFAULT_MAX_QUEUE_SIZE - rest]);
+    assert(Queue_readSpans(queue, &first, &second) == rest);
+    assert(first.count == rest && second.count == 0);
+    assert(Queue_consume(queue, DEFAULT_MAX_QUEUE_SIZE) == rest);
+    assert(Queue_isEmpty(queue));
+    assert(Queue_consume(queue, 1) == 0);
+    return TEST_SUCCESS;
+}
+
+// Checks that queues built with each data layout behave the same, with aligned data where asked.
+int layoutsBehaveAlike() {
+    static const int layouts[] = { QUEUE_LAYOUT_ALIGNED, QUEUE_LAYOUT_HUGE_PAGES, QUEUE_LAYOUT_HUGETLB };
+    int arr[DEFAULT_MAX_QUEUE_SIZE];
+
+    for (size_t l = 0; l < sizeof(layouts) / sizeof(layouts[0]); l++) {
+        Queue *q = new_QueueWithLayout(DEFAULT_MAX_QUEUE_SIZE, layouts[l]);
+        assert(q != NULL);
+        assert((uintptr_t)q->data % QUEUE_CACHE_LINE == 0);
+        for (int round = 0; round < 3; round++) {
+            for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+                assert(Queue_enq(q, &arr[i]));
+            }
+            assert(!Queue_enq(q, &arr[0]));
+            for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+                assert(Queue_deq(q) == &arr[i]);
+            }
+        }
+        Queue_destroy(q);
+    }
+    return TEST_SUCCESS;
+}
+
+// Checks that enqMany stops when the queue is full and deqMany on an empty queue returns 0.
+int enqManyOverMax() {
+    int element = 5;
+    void *in[DEFAULT_MAX_QUEUE_SIZE + 5], *out[1];
+
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE + 5; i++) {
+        in[i] = &element;
+    }
+    assert(Queue_enqMany(queue, in, DEFAULT_MAX_QUEUE_SIZE + 5) == DEFAULT_MAX_QUEUE_SIZE);
+    assert(Queue_enqMany(queue, in, 1) == 0);
+    Queue_clear(queue);
+    assert(Queue_deqMany(queue, out, 1) == 0);
+    return TEST_SUCCESS;
+}
+
+// Checks that enabled statistics count operations, rejections and the high-water mark.
+int statsCountOperations() {
+#ifdef QUEUE_STATS
+    QueueStatsSnapshot stats;
+    int element = 5;
+
+    assert(!Queue_getStats(queue, &stats));
+    assert(Queue_enableStats(queue));
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(Queue_enq(queue, &element));
+    }
+    assert(!Queue_enq(queue, &element));
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(Queue_deq(queue) == &element);
+    }
+    assert(Queue_deq(queue) == NULL);
+
+    assert(Queue_getStats(queue, &stats));
+    assert(stats.enqs == DEFAULT_MAX_QUEUE_SIZE);
+    assert(stats.deqs == DEFAULT_MAX_QUEUE_SIZE);
+    assert(stats.full == 1);
+    assert(stats.empty == 1);
+    assert(stats.high_water == DEFAULT_MAX_QUEUE_SIZE);
+#else
+    assert(!Queue_enableStats(queue));
+#endif
+    return TEST_SUCCESS;
+}
+
+// Checks that overwrite-oldest keeps the newest elements, in order, and reclaims the ones it replaces.
+int overflowOverwriteOldest() {
+    int elements[DEFAULT_MAX_QUEUE_SIZE + 3];
+
+    Queue_setOverflow(queue, QUEUE_OVERFLOW_OVERWRITE_OLDEST, recordReclaim);
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE + 3; i++) {
+        assert(Queue_enq(queue, &elements[i]));
+    }
+    assert(Queue_size(queue) == DEFAULT_MAX_QUEUE_SIZE);
+    assert(Queue_dropped(queue) == 3);
+    assert(reclaimed_count == 3);
+    assert(reclaimed[0] == &elements[0] && reclaimed[2] == &elements[2]);
+    for (int i = 3; i < DEFAULT_MAX_QUEUE_SIZE + 3; i++) {
+        assert(Queue_deq(queue) == &elements[i]);
+    }
+    assert(Queue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks that drop-newest keeps the oldest elements and counts and reclaims the rest, one or many at a time.
+int overflowDropNewest() {
+    int elements[DEFAULT_MAX_QUEUE_SIZE + 4];
+    void *batch[4] = {&elements[DEFAULT_MAX_QUEUE_SIZE], &elements[DEFAULT_MAX_QUEUE_SIZE + 1],
+                      &elements[DEFAULT_MAX_QUEUE_SIZE + 2], &elements[DEFAULT_MAX_QUEUE_SIZE + 3]};
+
+    Queue_setOverflow(queue, QUEUE_OVERFLOW_DROP_NEWEST, recordReclaim);
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE - 1; i++) {
+        assert(Queue_enq(queue, &elements[i]));
+    }
+    assert(Queue_enqMany(queue, batch, 4) == 4);
+    assert(Queue_enq(queue, &elements[DEFAULT_MAX_QUEUE_SIZE - 1]));
+    assert(Queue_size(queue) == DEFAULT_MAX_QUEUE_SIZE);
+    assert(Queue_dropped(queue) == 4);
+    assert(reclaimed[0] == batch[1] && reclaimed[3] == &elements[DEFAULT_MAX_QUEUE_SIZE - 1]);
+    assert(Queue_deq(queue) == &elements[0]);
+    return TEST_SUCCESS;
+}
+
+// Checks that sampling admits everything up to half full, then some but not all of a long burst.
+int overflowSampleUnderPressure() {
+    int element = 1, burst = DEFAULT_MAX_QUEUE_SIZE * 50;
+
+    Queue_setOverflow(queue, QUEUE_OVERFLOW_SAMPLE, NULL);
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE / 2; i++) {
+        assert(Queue_enq(queue, &element));
+    }
+    assert(Queue_dropped(queue) == 0);
+
+    // a consumer taking one element for every two offered keeps the queue under pressure
+    for (int i = 0; i < burst; i++) {
+        assert(Queue_enq(queue, &element));
+        assert(Queue_size(queue) <= DEFAULT_MAX_QUEUE_SIZE);
+        if (i % 2 == 0)
+            Queue_deq(queue);
+    }
+    assert(Queue_dropped(queue) > 0);
+    assert(Queue_dropped(queue) < burst / 2 + DEFAULT_MAX_QUEUE_SIZE);
+    return TEST_SUCCESS;
+}
+
+// Checks that every queue starts sampling from its own non-zero random state.
+int sampleSeedsDiffer() {
+    Queue *other = new_Queue(DEFAULT_MAX_QUEUE_SIZE);
+
+    assert(other != NULL);
+    assert(queue->sample_seed != 0 && other->sample_seed != 0);
+    assert(queue->sample_seed != other->sample_seed);
+    assert(QueueOverflow_newSeed(queue) != QueueOverflow_newSeed(other));
+    Queue_destroy(other);
+    return TEST_SUCCESS;
+}
+
 // 
 /*
     **************** Exceptional test cases ****************
@@ -541,6 +775,16 @@ int enqOverMax() {
     return TEST_SUCCESS;
 }
 
+// Checks that enqMany stops at the first NULL element.
+int enqManyStopsAtNull() {
+    int element = 5;
+    void *in[3] = {&element, NULL, &element};
+
+    assert(Queue_enqMany(queue, in, 3) == 1);
+    assert(Queue_size(queue) == 1);
+    return TEST_SUCCESS;
+}
+
 
 
 
@@ -588,10 +832,21 @@ int main() {
     runTest(clearFullQueue);
     runTest(clearEmptyQueue);
     runTest(enqMaxDequeueAll);
+    runTest(enqManyDeqManyWrapsAround);
+    runTest(enqManyOverMax);
+    runTest(peekDoesNotRemove);
+    runTest(readSpansAndConsume);
+    runTest(layoutsBehaveAlike);
+    runTest(statsCountOperations);
+    runTest(overflowOverwriteOldest);
+    runTest(overflowDropNewest);
+    runTest(overflowSampleUnderPressure);
+    runTest(sampleSeedsDiffer);
     //exceptional cases
     runTest(enqNullElement);
     runTest(deqEmptyQueue);
     runTest(enqOverMax);
+    runTest(enqManyStopsAtNull);
     /*
      * you will have to call runTest on all your test functions above, such as
      *
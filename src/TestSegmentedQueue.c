@@ -0,0 +1,189 @@
+/*
+ * TestSegmentedQueue.c
+ *
+ * Very simple unit test file for SegmentedQueue functionality.
+ *
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include "myassert.h"
+#include "SegmentedQueue.h"
+
+
+#define DEFAULT_SEGMENT_SIZE 4
+#define MANY_ELEMENTS 50
+
+/*
+ * The queue to use during tests
+ */
+static SegmentedQueue *queue;
+
+/*
+ * The number of tests that succeeded
+ */
+static int success_count = 0;
+
+/*
+ * The total number of tests run
+ */
+static int total_count = 0;
+
+
+/*
+ * Setup function to run prior to each test
+ */
+void setup(){
+    queue = new_SegmentedQueue(DEFAULT_SEGMENT_SIZE);
+    total_count++;
+}
+
+/*
+ * Teardown function to run after each test
+ */
+void teardown(){
+    SegmentedQueue_destroy(queue);
+}
+
+/*
+ * This function is called multiple times from main for each user-defined test function
+ */
+void runTest(int (*testFunction)()) {
+    setup();
+
+    if (testFunction()) success_count++;
+
+    teardown();
+}
+
+
+/*
+    **************** Regular test cases ****************
+*/
+
+// Checks that the SegmentedQueue constructor returns an empty queue.
+int newQueueIsEmpty() {
+    assert(queue != NULL);
+    assert(SegmentedQueue_size(queue) == 0);
+    assert(SegmentedQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks that the queue grows past one segment and stays FIFO.
+int growsAcrossSegments() {
+    int arr[MANY_ELEMENTS];
+    for (int i = 0; i < MANY_ELEMENTS; i++) {
+        arr[i] = i;
+        assert(SegmentedQueue_enq(queue, &arr[i]));
+    }
+    assert(SegmentedQueue_size(queue) == MANY_ELEMENTS);
+    for (int i = 0; i < MANY_ELEMENTS; i++) {
+        assert(SegmentedQueue_deq(queue) == &arr[i]);
+    }
+    assert(SegmentedQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks that drained segments are kept on the free list and reused.
+int recyclesDrainedSegments() {
+    int element = 5;
+    for (int i = 0; i < DEFAULT_SEGMENT_SIZE * 3; i++) {
+        assert(SegmentedQueue_enq(queue, &element));
+    }
+    for (int i = 0; i < DEFAULT_SEGMENT_SIZE * 3; i++) {
+        assert(SegmentedQueue_deq(queue) == &element);
+    }
+    assert(queue->free_count == 2);
+
+    // refilling takes from the free list rather than allocating
+    for (int i = 0; i < DEFAULT_SEGMENT_SIZE * 3; i++) {
+        assert(SegmentedQueue_enq(queue, &element));
+    }
+    assert(queue->free_count == 0);
+    return TEST_SUCCESS;
+}
+
+// Checks that interleaved producers and consumers keep FIFO order.
+int interleavedEnqDeq() {
+    int arr[MANY_ELEMENTS];
+    int next = 0;
+    for (int i = 0; i < MANY_ELEMENTS; i++) {
+        arr[i] = i;
+        assert(SegmentedQueue_enq(queue, &arr[i]));
+        if (i % 3 == 2) {
+            assert(SegmentedQueue_deq(queue) == &arr[next++]);
+        }
+    }
+    while (next < MANY_ELEMENTS) {
+        assert(SegmentedQueue_deq(queue) == &arr[next++]);
+    }
+    return TEST_SUCCESS;
+}
+
+// Checks that enqMany and deqMany cross segment boundaries in order.
+int enqManyDeqMany() {
+    int arr[MANY_ELEMENTS];
+    void *in[MANY_ELEMENTS], *out[MANY_ELEMENTS];
+    for (int i = 0; i < MANY_ELEMENTS; i++) {
+        arr[i] = i;
+        in[i] = &arr[i];
+    }
+    assert(SegmentedQueue_enq(queue, &arr[0]));
+    assert(SegmentedQueue_deq(queue) == &arr[0]);
+
+    assert(SegmentedQueue_enqMany(queue, in, MANY_ELEMENTS) == MANY_ELEMENTS);
+    assert(SegmentedQueue_deqMany(queue, out, 7) == 7);
+    assert(SegmentedQueue_deqMany(queue, out + 7, MANY_ELEMENTS) == MANY_ELEMENTS - 7);
+    for (int i = 0; i < MANY_ELEMENTS; i++) {
+        assert(out[i] == &arr[i]);
+    }
+    return TEST_SUCCESS;
+}
+
+// Checks clear function works correctly
+int clearQueue() {
+    int element = 5;
+    for (int i = 0; i < MANY_ELEMENTS; i++) {
+        assert(SegmentedQueue_enq(queue, &element));
+    }
+    SegmentedQueue_clear(queue);
+    assert(SegmentedQueue_isEmpty(queue));
+    assert(SegmentedQueue_deq(queue) == NULL);
+    assert(SegmentedQueue_enq(queue, &element));
+    assert(SegmentedQueue_deq(queue) == &element);
+    return TEST_SUCCESS;
+}
+
+/*
+    **************** Exceptional test cases ****************
+*/
+
+// Checks that NULL elements are rejected and empty dequeues return NULL.
+int enqNullAndDeqEmpty() {
+    int element = 5;
+    void *in[3] = {&element, NULL, &element};
+
+    assert(!SegmentedQueue_enq(queue, NULL));
+    assert(SegmentedQueue_deq(queue) == NULL);
+    assert(SegmentedQueue_enqMany(queue, in, 3) == 1);
+    assert(SegmentedQueue_size(queue) == 1);
+    return TEST_SUCCESS;
+}
+
+/*
+ * Main function for the SegmentedQueue tests which will run each user-defined test in turn.
+ */
+
+int main() {
+    runTest(newQueueIsEmpty);
+    runTest(growsAcrossSegments);
+    runTest(recyclesDrainedSegments);
+    runTest(interleavedEnqDeq);
+    runTest(enqManyDeqMany);
+    runTest(clearQueue);
+
+    runTest(enqNullAndDeqEmpty);
+
+    printf("SegmentedQueue Tests complete: %d / %d tests successful.\n----------------\n", success_count, total_count);
+
+}
@@ -0,0 +1,236 @@
+/*
+ * TestShardedBlockingQueue.c
+ *
+ * Very simple unit test file for ShardedBlockingQueue functionality.
+ *
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "ShardedBlockingQueue.h"
+#include "myassert.h"
+
+
+#define DEFAULT_MAX_QUEUE_SIZE 20
+#define DEFAULT_SHARD_COUNT 4
+
+/*
+ * The queue to use during tests
+ */
+static ShardedBlockingQueue *queue;
+
+/*
+ * The number of tests that succeeded
+ */
+static int success_count = 0;
+
+/*
+ * The total number of tests run
+ */
+static int total_count = 0;
+
+
+/*
+ * Setup function to run prior to each test
+ */
+void setup(){
+    queue = new_ShardedBlockingQueue(DEFAULT_MAX_QUEUE_SIZE, DEFAULT_SHARD_COUNT);
+    total_count++;
+}
+
+/*
+ * Teardown function to run after each test
+ */
+void teardown(){
+    ShardedBlockingQueue_destroy(queue);
+}
+
+/*
+ * This function is called multiple times from main for each user-defined test function
+ */
+void runTest(int (*testFunction)()) {
+    setup();
+
+    if (testFunction()) success_count++;
+
+    teardown();
+}
+
+#define STRESS_THREADS 8
+#define STRESS_COUNT 20000
+
+// Enqueues STRESS_COUNT non-NULL tokens, forcing the small queue through its full path
+void* stressProducer(void* arg) {
+    (void)arg;
+    for (intptr_t i = 1; i <= STRESS_COUNT; i++) {
+        ShardedBlockingQueue_enq(queue, (void*)i);
+    }
+    return NULL;
+}
+
+// Dequeues STRESS_COUNT tokens and returns their sum
+void* stressConsumer(void* arg) {
+    long *sum = arg;
+    for (int i = 0; i < STRESS_COUNT; i++) {
+        *sum += (intptr_t)ShardedBlockingQueue_deq(queue);
+    }
+    return NULL;
+}
+
+// Enqueues one element on the thread's home shard
+void* enqOne(void* arg) {
+    ShardedBlockingQueue_enq(queue, arg);
+    return NULL;
+}
+
+
+/*
+    **************** Regular test cases ****************
+*/
+
+// Checks that the ShardedBlockingQueue constructor returns an empty queue.
+int newQueueIsEmpty() {
+    assert(queue != NULL);
+    assert(ShardedBlockingQueue_size(queue) == 0);
+    assert(ShardedBlockingQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks that a single thread gets its elements back in FIFO order from its home shard.
+int singleThreadIsFifo() {
+    int elements[5];
+    for (int i = 0; i < 5; i++) {
+        assert(ShardedBlockingQueue_enq(queue, &elements[i]));
+    }
+    assert(ShardedBlockingQueue_size(queue) == 5);
+    for (int i = 0; i < 5; i++) {
+        assert(ShardedBlockingQueue_deq(queue) == &elements[i]);
+    }
+    return TEST_SUCCESS;
+}
+
+// Checks that a full home shard overflows into the others up to the queue's capacity.
+int fillsEveryShard() {
+    int element = 1;
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(ShardedBlockingQueue_enq(queue, &element));
+    }
+    assert(ShardedBlockingQueue_size(queue) == DEFAULT_MAX_QUEUE_SIZE);
+    for (int i = 0; i < DEFAULT_SHARD_COUNT; i++) {
+        assert(atomic_load(&queue->shards[i].size) > 0);
+    }
+    return TEST_SUCCESS;
+}
+
+// Checks that a consumer steals elements enqueued by other threads onto their home shards.
+int deqStealsFromOtherShards() {
+    pthread_t threads[DEFAULT_SHARD_COUNT];
+    int elements[DEFAULT_SHARD_COUNT];
+    for (int i = 0; i < DEFAULT_SHARD_COUNT; i++) {
+        pthread_create(&threads[i], NULL, enqOne, &elements[i]);
+        pthread_join(threads[i], NULL);
+    }
+    assert(ShardedBlockingQueue_size(queue) == DEFAULT_SHARD_COUNT);
+    for (int i = 0; i < DEFAULT_SHARD_COUNT; i++) {
+        assert(ShardedBlockingQueue_deq(queue) != NULL);
+    }
+    assert(ShardedBlockingQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks that shards split an uneven max_size exactly, and that there are never more shards than elements.
+int unevenSizeIsExact() {
+    ShardedBlockingQueue *uneven = new_ShardedBlockingQueue(7, DEFAULT_SHARD_COUNT);
+    ShardedBlockingQueue *tiny = new_ShardedBlockingQueue(2, DEFAULT_SHARD_COUNT);
+    int element = 1, capacity = 0;
+
+    assert(uneven != NULL && tiny != NULL);
+    for (int i = 0; i < uneven->shard_count; i++) {
+        capacity += uneven->shards[i].capacity;
+    }
+    assert(capacity == 7);
+    for (int i = 0; i < 7; i++) {
+        assert(ShardedBlockingQueue_enq(uneven, &element));
+    }
+    assert(ShardedBlockingQueue_size(uneven) == 7);
+    assert(tiny->shard_count == 2);
+    ShardedBlockingQueue_destroy(uneven);
+    ShardedBlockingQueue_destroy(tiny);
+    return TEST_SUCCESS;
+}
+
+// Checks that clear empties every shard and frees their space.
+int sizeAndClear() {
+    int element = 1;
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(ShardedBlockingQueue_enq(queue, &element));
+    }
+    ShardedBlockingQueue_clear(queue);
+    assert(ShardedBlockingQueue_isEmpty(queue));
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(ShardedBlockingQueue_enq(queue, &element));
+    }
+    assert(ShardedBlockingQueue_size(queue) == DEFAULT_MAX_QUEUE_SIZE);
+    return TEST_SUCCESS;
+}
+
+// Checks that every element survives more producers and consumers than shards on a small queue.
+int multiProducerMultiConsumer() {
+    pthread_t producers[STRESS_THREADS], consumers[STRESS_THREADS];
+    long sums[STRESS_THREADS] = {0};
+
+    for (int i = 0; i < STRESS_THREADS; i++) {
+        pthread_create(&producers[i], NULL, stressProducer, NULL);
+        pthread_create(&consumers[i], NULL, stressConsumer, &sums[i]);
+    }
+    long total = 0;
+    for (int i = 0; i < STRESS_THREADS; i++) {
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], NULL);
+        total += sums[i];
+    }
+    assert(total == (long)STRESS_THREADS * STRESS_COUNT * (STRESS_COUNT + 1) / 2);
+    assert(ShardedBlockingQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+/*
+    **************** Exceptional test cases ****************
+*/
+
+// Checks that NULL elements are rejected.
+int enqRejectsNull() {
+    assert(!ShardedBlockingQueue_enq(queue, NULL));
+    assert(ShardedBlockingQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks that invalid sizes are rejected by the constructor.
+int newQueueRejectsBadSizes() {
+    assert(new_ShardedBlockingQueue(0, DEFAULT_SHARD_COUNT) == NULL);
+    assert(new_ShardedBlockingQueue(DEFAULT_MAX_QUEUE_SIZE, 0) == NULL);
+    return TEST_SUCCESS;
+}
+
+/*
+ * Main function for the ShardedBlockingQueue tests which will run each user-defined test in turn.
+ */
+
+int main() {
+    runTest(newQueueIsEmpty);
+    runTest(singleThreadIsFifo);
+    runTest(fillsEveryShard);
+    runTest(deqStealsFromOtherShards);
+    runTest(unevenSizeIsExact);
+    runTest(sizeAndClear);
+    runTest(multiProducerMultiConsumer);
+
+    runTest(enqRejectsNull);
+    runTest(newQueueRejectsBadSizes);
+
+    printf("\nShardedBlockingQueue Tests complete: %d / %d tests successful.\n----------------\n", success_count, total_count);
+
+}
@@ -0,0 +1,239 @@
+/*
+ * TestSharedBlockingQueue.c
+ *
+ * Very simple unit test file for SharedBlockingQueue functionality.
+ *
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "SharedBlockingQueue.h"
+#include "myassert.h"
+
+
+#define DEFAULT_MAX_QUEUE_SIZE 20
+#define TRANSFER_COUNT 20000
+
+/*
+ * The element type stored in the queue during tests
+ */
+typedef struct {
+    int seq;
+    char tag[12];
+} Message;
+
+/*
+ * The queue to use during tests, and the name of its region
+ */
+static SharedBlockingQueue *queue;
+static char name[64];
+
+/*
+ * The number of tests that succeeded
+ */
+static int success_count = 0;
+
+/*
+ * The total number of tests run
+ */
+static int total_count = 0;
+
+
+/*
+ * Setup function to run prior to each test
+ */
+void setup(){
+    snprintf(name, sizeof(name), "/TestSharedBlockingQueue-%d", (int)getpid());
+    queue = new_SharedBlockingQueue(name, DEFAULT_MAX_QUEUE_SIZE, sizeof(Message));
+    total_count++;
+}
+
+/*
+ * Teardown function to run after each test
+ */
+void teardown(){
+    SharedBlockingQueue_destroy(queue);
+    SharedBlockingQueue_unlink(name);
+}
+
+/*
+ * This function is called multiple times from main for each user-defined test function
+ */
+void runTest(int (*testFunction)()) {
+    setup();
+
+    if (testFunction()) success_count++;
+
+    teardown();
+}
+
+/*
+ * Waits for the child process and returns true if it exited successfully.
+ */
+static bool childSucceeded(pid_t child) {
+    int status;
+    return waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+
+/*
+    **************** Regular test cases ****************
+*/
+
+// Checks that the SharedBlockingQueue constructor returns an empty queue.
+int newQueueIsEmpty() {
+    assert(queue != NULL);
+    assert(SharedBlockingQueue_size(queue) == 0);
+    assert(SharedBlockingQueue_isEmpty(queue));
+    assert(SharedBlockingQueue_elemSize(queue) == sizeof(Message));
+    return TEST_SUCCESS;
+}
+
+// Checks that elements are copied in and out by value in FIFO order.
+int enqAndDeqByValue() {
+    Message in = { 0, "" }, out;
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        in.seq = i;
+        snprintf(in.tag, sizeof(in.tag), "msg%d", i);
+        assert(SharedBlockingQueue_enq(queue, &in));
+    }
+    assert(SharedBlockingQueue_size(queue) == DEFAULT_MAX_QUEUE_SIZE);
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        char tag[12];
+        snprintf(tag, sizeof(tag), "msg%d", i);
+        assert(SharedBlockingQueue_deq(queue, &out));
+        assert(out.seq == i && strcmp(out.tag, tag) == 0);
+    }
+    return TEST_SUCCESS;
+}
+
+// Checks that a second handle attached by name sees the same queue.
+int attachSeesSameQueue() {
+    Message in = { 7, "attached" }, out;
+    SharedBlockingQueue *other = SharedBlockingQueue_attach(name);
+    assert(other != NULL);
+    assert(SharedBlockingQueue_elemSize(other) == sizeof(Message));
+
+    assert(SharedBlockingQueue_enq(queue, &in));
+    assert(SharedBlockingQueue_size(other) == 1);
+    assert(SharedBlockingQueue_deq(other, &out));
+    assert(out.seq == 7 && strcmp(out.tag, "attached") == 0);
+    assert(SharedBlockingQueue_isEmpty(queue));
+    SharedBlockingQueue_destroy(other);
+    return TEST_SUCCESS;
+}
+
+// Checks that a child process producing through an attached handle reaches a consumer in this process.
+int transferBetweenProcesses() {
+    pid_t child = fork();
+    assert(child >= 0);
+    if (child == 0) {
+        SharedBlockingQueue *producer = SharedBlockingQueue_attach(name);
+        if (producer == NULL) _exit(EXIT_FAILURE);
+        for (int i = 0; i < TRANSFER_COUNT; i++) {
+            Message msg = { i, "child" };
+            SharedBlockingQueue_enq(producer, &msg);
+        }
+        SharedBlockingQueue_destroy(producer);
+        _exit(EXIT_SUCCESS);
+    }
+
+    bool ordered = true;
+    for (int i = 0; i < TRANSFER_COUNT; i++) {
+        Message msg;
+        SharedBlockingQueue_deq(queue, &msg);
+        ordered = ordered && msg.seq == i;
+    }
+    assert(childSucceeded(child));
+    assert(ordered);
+    assert(SharedBlockingQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks that clear empties the queue and frees its space.
+int sizeAndClear() {
+    Message msg = { 1, "clear" };
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(SharedBlockingQueue_enq(queue, &msg));
+    }
+    SharedBlockingQueue_clear(queue);
+    assert(SharedBlockingQueue_isEmpty(queue));
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(SharedBlockingQueue_enq(queue, &msg));
+    }
+    assert(SharedBlockingQueue_size(queue) == DEFAULT_MAX_QUEUE_SIZE);
+    return TEST_SUCCESS;
+}
+
+/*
+    **************** Exceptional test cases ****************
+*/
+
+// Checks that NULL elements are rejected.
+int enqRejectsNull() {
+    assert(!SharedBlockingQueue_enq(queue, NULL));
+    assert(SharedBlockingQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks that a name can be neither created twice nor attached to once unlinked, nor a queue too large for its indices created.
+int createAndAttachFailures() {
+    assert(new_SharedBlockingQueue(name, DEFAULT_MAX_QUEUE_SIZE, sizeof(Message)) == NULL);
+    assert(SharedBlockingQueue_unlink(name));
+    assert(new_SharedBlockingQueue(name, INT_MAX / 2 + 1, 1) == NULL);
+    assert(new_SharedBlockingQueue(name, 0, sizeof(Message)) == NULL);
+    assert(SharedBlockingQueue_attach(name) == NULL);
+    assert(!SharedBlockingQueue_unlink(name));
+    return TEST_SUCCESS;
+}
+
+// Checks that a process dying halfway through an enq leaves the queue usable, holding only committed elements.
+int survivesOwnerDeath() {
+    Message msg = { 1, "committed" }, out;
+    assert(SharedBlockingQueue_enq(queue, &msg));
+
+    pid_t child = fork();
+    assert(child >= 0);
+    if (child == 0) {
+        SharedBlockingQueue *dying = SharedBlockingQueue_attach(name);
+        if (dying == NULL) _exit(EXIT_FAILURE);
+        // take the mutex and scribble over the next free slot, then die before committing it
+        pthread_mutex_lock(&dying->header->mutex);
+        memset(dying->data + sizeof(Message), 0xff, sizeof(Message));
+        _exit(EXIT_SUCCESS);
+    }
+    assert(childSucceeded(child));
+
+    assert(SharedBlockingQueue_size(queue) == 1);
+    msg.seq = 2;
+    assert(SharedBlockingQueue_enq(queue, &msg));
+    assert(SharedBlockingQueue_deq(queue, &out) && out.seq == 1 && strcmp(out.tag, "committed") == 0);
+    assert(SharedBlockingQueue_deq(queue, &out) && out.seq == 2);
+    assert(SharedBlockingQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+/*
+ * Main function for the SharedBlockingQueue tests which will run each user-defined test in turn.
+ */
+
+int main() {
+    runTest(newQueueIsEmpty);
+    runTest(enqAndDeqByValue);
+    runTest(attachSeesSameQueue);
+    runTest(transferBetweenProcesses);
+    runTest(sizeAndClear);
+
+    runTest(enqRejectsNull);
+    runTest(createAndAttachFailures);
+    runTest(survivesOwnerDeath);
+
+    printf("\nSharedBlockingQueue Tests complete: %d / %d tests successful.\n----------------\n", success_count, total_count);
+
+}
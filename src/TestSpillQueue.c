@@ -0,0 +1,242 @@
+/*
+ * TestSpillQueue.c
+ *
+ * Very simple unit test file for SpillQueue functionality.
+ *
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include "myassert.h"
+#include "SpillQueue.h"
+
+
+#define DEFAULT_MAX_QUEUE_SIZE 20
+#define DEFAULT_SEGMENT_SIZE 8
+#define SPILL_DIR "/tmp"
+
+/*
+ * The element type stored in the queue during tests
+ */
+typedef struct {
+    int x;
+    char tag[12];
+} Struc;
+
+/*
+ * The queue to use during tests
+ */
+static SpillQueue *queue;
+
+/*
+ * The number of tests that succeeded
+ */
+static int success_count = 0;
+
+/*
+ * The total number of tests run
+ */
+static int total_count = 0;
+
+
+/*
+ * Setup function to run prior to each test
+ */
+void setup(){
+    queue = new_SpillQueue(DEFAULT_MAX_QUEUE_SIZE, sizeof(Struc), SPILL_DIR, DEFAULT_SEGMENT_SIZE);
+    total_count++;
+}
+
+/*
+ * Teardown function to run after each test
+ */
+void teardown(){
+    SpillQueue_destroy(queue);
+}
+
+/*
+ * This function is called multiple times from main for each user-defined test function
+ */
+void runTest(int (*testFunction)()) {
+    setup();
+
+    if (testFunction()) success_count++;
+
+    teardown();
+}
+
+/*
+ * Returns the number of segments currently mapped by the queue
+ */
+static int segmentCount() {
+    int count = 0;
+    for (SpillSegment *s = queue->first; s != NULL; s = s->next)
+        count++;
+    return count;
+}
+
+
+/*
+    **************** Regular test cases ****************
+*/
+
+// Checks that the SpillQueue constructor returns an empty queue.
+int newQueueIsEmpty() {
+    assert(queue != NULL);
+    assert(SpillQueue_size(queue) == 0);
+    assert(SpillQueue_isEmpty(queue));
+    assert(SpillQueue_spilledSize(queue) == 0);
+    return TEST_SUCCESS;
+}
+
+// Checks that elements stay in memory, with no segment files, until the queue is full.
+int noSpillUntilFull() {
+    Struc struc = {1, "memory"};
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(SpillQueue_enq(queue, &struc));
+    }
+    assert(SpillQueue_spilledSize(queue) == 0);
+    assert(segmentCount() == 0);
+
+    assert(SpillQueue_enq(queue, &struc));
+    assert(SpillQueue_spilledSize(queue) == 1);
+    assert(segmentCount() == 1);
+    return TEST_SUCCESS;
+}
+
+// Checks that FIFO order holds across memory and several segment files, with enqs interleaved.
+int fifoAcrossSpill() {
+    int total = DEFAULT_MAX_QUEUE_SIZE + DEFAULT_SEGMENT_SIZE * 5 + 3;
+    Struc in = {0, ""}, out;
+
+    for (int i = 0; i < total; i++) {
+        in.x = i;
+        snprintf(in.tag, sizeof(in.tag), "n%d", i);
+        assert(SpillQueue_enq(queue, &in));
+    }
+    assert(SpillQueue_size(queue) == total);
+    assert(SpillQueue_spilledSize(queue) == total - DEFAULT_MAX_QUEUE_SIZE);
+
+    // every deq pages one element back in, so later enqs must still land behind the spill
+    int next = 0;
+    for (int i = 0; i < total / 2; i++) {
+        assert(SpillQueue_deq(queue, &out));
+        assert(out.x == next++);
+        in.x = total + i;
+        assert(SpillQueue_enq(queue, &in));
+    }
+    while (SpillQueue_deq(queue, &out)) {
+        char tag[12];
+        snprintf(tag, sizeof(tag), "n%d", out.x);
+        assert(out.x == next++);
+        assert(out.x >= total || strcmp(out.tag, tag) == 0);
+    }
+    assert(next == total + total / 2);
+    assert(SpillQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks that segments are reclaimed as soon as they have been read.
+int consumedSegmentsReclaimed() {
+    Struc struc = {0, ""};
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE + DEFAULT_SEGMENT_SIZE * 3; i++) {
+        assert(SpillQueue_enq(queue, &struc));
+    }
+    assert(segmentCount() == 3);
+    for (int i = 0; i < DEFAULT_SEGMENT_SIZE; i++) {
+        assert(SpillQueue_deq(queue, NULL));
+    }
+    assert(segmentCount() == 2);
+    for (int i = 0; i < DEFAULT_SEGMENT_SIZE * 2; i++) {
+        assert(SpillQueue_deq(queue, NULL));
+    }
+    assert(segmentCount() == 0);
+    assert(SpillQueue_spilledSize(queue) == 0);
+    assert(SpillQueue_size(queue) == DEFAULT_MAX_QUEUE_SIZE);
+    return TEST_SUCCESS;
+}
+
+// Checks that clear drops spilled elements and their segments.
+int clearQueue() {
+    Struc struc = {5, ""};
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE * 2; i++) {
+        assert(SpillQueue_enq(queue, &struc));
+    }
+    SpillQueue_clear(queue);
+    assert(SpillQueue_isEmpty(queue));
+    assert(segmentCount() == 0);
+    assert(SpillQueue_enq(queue, &struc));
+    assert(SpillQueue_spilledSize(queue) == 0);
+    return TEST_SUCCESS;
+}
+
+/*
+    **************** Exceptional test cases ****************
+*/
+
+// Checks that the queue rejects NULL and dequeuing when empty.
+int enqNullDeqEmpty() {
+    Struc struc = {5, ""};
+
+    assert(!SpillQueue_enq(queue, NULL));
+    assert(!SpillQueue_deq(queue, &struc));
+    return TEST_SUCCESS;
+}
+
+// Checks that a full queue whose spill directory is unusable rejects further elements.
+int spillFailureRejects() {
+    Struc struc = {5, ""};
+    SpillQueue *bad = new_SpillQueue(1, sizeof(Struc), "/nonexistent-spill-dir", DEFAULT_SEGMENT_SIZE);
+    assert(bad != NULL);
+    assert(SpillQueue_enq(bad, &struc));
+    assert(!SpillQueue_enq(bad, &struc));
+    assert(SpillQueue_size(bad) == 1);
+    SpillQueue_destroy(bad);
+    return TEST_SUCCESS;
+}
+
+// Checks that a segment whose disk space cannot be allocated rejects the element instead of faulting later.
+int spillOutOfSpaceRejects() {
+    Struc struc = {6, "nospace"};
+    struct rlimit old, tiny = {0, 0};
+    SpillQueue *Q = new_SpillQueue(1, sizeof(Struc), SPILL_DIR, DEFAULT_SEGMENT_SIZE);
+    assert(Q != NULL);
+    assert(SpillQueue_enq(Q, &struc));
+
+    // no file may grow past 0 bytes, as if the disk were full; fail with EFBIG rather than SIGXFSZ
+    void (*old_handler)(int) = signal(SIGXFSZ, SIG_IGN);
+    getrlimit(RLIMIT_FSIZE, &old);
+    tiny.rlim_max = old.rlim_max;
+    setrlimit(RLIMIT_FSIZE, &tiny);
+    bool spilled = SpillQueue_enq(Q, &struc);
+    setrlimit(RLIMIT_FSIZE, &old);
+    signal(SIGXFSZ, old_handler);
+
+    assert(!spilled);
+    assert(SpillQueue_size(Q) == 1 && SpillQueue_spilledSize(Q) == 0);
+    assert(SpillQueue_enq(Q, &struc) && SpillQueue_spilledSize(Q) == 1);
+    SpillQueue_destroy(Q);
+    return TEST_SUCCESS;
+}
+
+/*
+ * Main function for the SpillQueue tests which will run each user-defined test in turn.
+ */
+
+int main() {
+    runTest(newQueueIsEmpty);
+    runTest(noSpillUntilFull);
+    runTest(fifoAcrossSpill);
+    runTest(consumedSegmentsReclaimed);
+    runTest(clearQueue);
+
+    runTest(enqNullDeqEmpty);
+    runTest(spillFailureRejects);
+    runTest(spillOutOfSpaceRejects);
+
+    printf("SpillQueue Tests complete: %d / %d tests successful.\n----------------\n", success_count, total_count);
+
+}
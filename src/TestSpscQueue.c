@@ -0,0 +1,194 @@
+/*
+ * TestSpscQueue.c
+ *
+ * Very simple unit test file for SpscQueue functionality.
+ *
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "SpscQueue.h"
+#include "myassert.h"
+
+
+#define DEFAULT_MAX_QUEUE_SIZE 20
+#define TRANSFER_COUNT 100000
+
+/*
+ * The queue to use during tests
+ */
+static SpscQueue *queue;
+
+/*
+ * The number of tests that succeeded
+ */
+static int success_count = 0;
+
+/*
+ * The total number of tests run
+ */
+static int total_count = 0;
+
+
+/*
+ * Setup function to run prior to each test
+ */
+void setup(){
+    queue = new_SpscQueue(DEFAULT_MAX_QUEUE_SIZE);
+    total_count++;
+}
+
+/*
+ * Teardown function to run after each test
+ */
+void teardown(){
+    SpscQueue_destroy(queue);
+}
+
+/*
+ * This function is called multiple times from main for each user-defined test function
+ */
+void runTest(int (*testFunction)()) {
+    setup();
+
+    if (testFunction()) success_count++;
+
+    teardown();
+}
+
+// Producer thread which enqueues 1..TRANSFER_COUNT in order
+void* producerFunc(void* arg) {
+    (void)arg;
+    for (intptr_t i = 1; i <= TRANSFER_COUNT; i++) {
+        SpscQueue_enq(queue, (void*)i);
+    }
+    return NULL;
+}
+
+
+/*
+    **************** Regular test cases ****************
+*/
+
+// Checks that the SpscQueue constructor returns a non-NULL pointer.
+int newQueueIsNotNull() {
+    assert(queue != NULL);
+    return TEST_SUCCESS;
+}
+
+// Checks that the size of an empty queue is 0.
+int newQueueSizeZero() {
+    assert(SpscQueue_size(queue) == 0);
+    assert(SpscQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks that enqueuing and dequeuing elements keeps FIFO order.
+int enqAndDeqMultipleElements() {
+    int elements[] = {1, 2, 3, 4, 5};
+    for (int i = 0; i < 5; i++) {
+        assert(SpscQueue_tryEnq(queue, &elements[i]));
+    }
+    assert(SpscQueue_size(queue) == 5);
+    for (int i = 0; i < 5; i++) {
+        assert(SpscQueue_tryDeq(queue) == &elements[i]);
+    }
+    assert(SpscQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks the size of the queue is correct after it wraps around
+int sizeAfterWrapping() {
+    int element = 5;
+    for (int i = 0; i < 15; i++) {
+        assert(SpscQueue_enq(queue, &element));
+    }
+    for (int i = 0; i < 15; i++) {
+        assert(SpscQueue_deq(queue) == &element);
+    }
+    for (int i = 0; i < 11; i++) {
+        assert(SpscQueue_enq(queue, &element));
+    }
+    assert(SpscQueue_size(queue) == 11);
+    return TEST_SUCCESS;
+}
+
+// Checks clear function works correctly
+int clearQueue() {
+    int element = 5;
+    for (int i = 0; i < 5; i++) {
+        assert(SpscQueue_tryEnq(queue, &element));
+    }
+    SpscQueue_clear(queue);
+    assert(SpscQueue_isEmpty(queue));
+    assert(SpscQueue_tryDeq(queue) == NULL);
+    assert(SpscQueue_tryEnq(queue, &element));
+    assert(SpscQueue_tryDeq(queue) == &element);
+    return TEST_SUCCESS;
+}
+
+/*
+    **************** Edge and exceptional test cases ****************
+*/
+
+// Checks that tryEnq fails once the queue is at its maximum capacity.
+int tryEnqOverMax() {
+    int element = 5;
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(SpscQueue_tryEnq(queue, &element));
+    }
+    assert(!SpscQueue_tryEnq(queue, &element));
+    assert(SpscQueue_size(queue) == DEFAULT_MAX_QUEUE_SIZE);
+    return TEST_SUCCESS;
+}
+
+// Checks that NULL elements are rejected and empty dequeues return NULL.
+int enqNullAndDeqEmpty() {
+    assert(!SpscQueue_tryEnq(queue, NULL));
+    assert(!SpscQueue_enq(queue, NULL));
+    assert(SpscQueue_tryDeq(queue) == NULL);
+    return TEST_SUCCESS;
+}
+
+/*
+    **************** Concurrency test cases ****************
+*/
+
+// Checks that one producer and one consumer transfer every element in order,
+// with the small ring forcing both sides through their blocking paths.
+int producerConsumerOrder() {
+    pthread_t producer;
+    pthread_create(&producer, NULL, producerFunc, NULL);
+
+    int in_order = 1;
+    for (intptr_t i = 1; i <= TRANSFER_COUNT; i++) {
+        if ((intptr_t)SpscQueue_deq(queue) != i) in_order = 0;
+    }
+    pthread_join(producer, NULL);
+
+    assert(in_order);
+    assert(SpscQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+/*
+ * Main function for the SpscQueue tests which will run each user-defined test in turn.
+ */
+
+int main() {
+    runTest(newQueueIsNotNull);
+    runTest(newQueueSizeZero);
+    runTest(enqAndDeqMultipleElements);
+    runTest(sizeAfterWrapping);
+    runTest(clearQueue);
+
+    runTest(tryEnqOverMax);
+    runTest(enqNullAndDeqEmpty);
+
+    runTest(producerConsumerOrder);
+
+    printf("\nSpscQueue Tests complete: %d / %d tests successful.\n----------------\n", success_count, total_count);
+
+}
@@ -0,0 +1,272 @@
+/*
+ * TestTemplateQueue.cpp
+ *
+ * Very simple unit test file for the header-only Queue.hpp and BlockingQueue.hpp functionality.
+ *
+ */
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Queue.hpp"
+#include "BlockingQueue.hpp"
+#include "myassert.h"
+
+
+#define TRANSFER_COUNT 100000
+
+/*
+ * An element type which counts how many of it are alive, to check the queue destroys them
+ */
+struct Tracked {
+    static int live;
+    int value;
+    std::string tag;
+
+    Tracked(int value, std::string tag) : value(value), tag(std::move(tag)) { live++; }
+    Tracked(const Tracked& other) : value(other.value), tag(other.tag) { live++; }
+    Tracked(Tracked&& other) noexcept : value(other.value), tag(std::move(other.tag)) { live++; }
+    Tracked& operator=(Tracked&& other) noexcept = default;
+    ~Tracked() { live--; }
+};
+
+int Tracked::live = 0;
+
+// the ring is part of the object, so a queue of ints is little more than its elements
+static_assert(sizeof(cqueue::Queue<int, 64>) <= 64 * sizeof(int) + 3 * sizeof(std::size_t),
+              "the ring must be stored in place");
+
+/*
+ * The number of tests that succeeded
+ */
+static int success_count = 0;
+
+/*
+ * The total number of tests run
+ */
+static int total_count = 0;
+
+
+/*
+ * Setup function to run prior to each test
+ */
+void setup(){
+    Tracked::live = 0;
+    total_count++;
+}
+
+/*
+ * Teardown function to run after each test
+ */
+void teardown(){
+}
+
+/*
+ * This function is called multiple times from main for each user-defined test function
+ */
+void runTest(int (*testFunction)()) {
+    setup();
+
+    if (testFunction()) success_count++;
+
+    teardown();
+}
+
+/*
+ * Fills queue and nearly empties it again three times over, checking FIFO order across the wraparound.
+ */
+template <std::size_t Capacity>
+static int checkWraparound(cqueue::Queue<int, Capacity>& queue) {
+    int next_in = 0, next_out = 0, out;
+    for (int round = 0; round < 3; round++) {
+        // leave a few elements behind so the indices wrap at a different point each round
+        while (queue.enq(next_in))
+            next_in++;
+        assert(queue.isFull());
+        for (std::size_t i = 0; i < Capacity - 1; i++) {
+            assert(queue.deq(out));
+            assert(out == next_out++);
+        }
+    }
+    while (queue.deq(out)) {
+        assert(out == next_out++);
+    }
+    assert(next_out == next_in);
+    return TEST_SUCCESS;
+}
+
+
+/*
+    **************** Regular test cases ****************
+*/
+
+// Checks that a new Queue is empty and reports its compile-time capacity.
+int newQueueIsEmpty() {
+    cqueue::Queue<int, 16> queue;
+    static_assert(cqueue::Queue<int, 16>::capacity() == 16, "capacity is a constant expression");
+    assert(queue.isEmpty());
+    assert(!queue.isFull());
+    assert(queue.size() == 0);
+    assert(queue.peek() == nullptr);
+    return TEST_SUCCESS;
+}
+
+// Checks FIFO order across the wraparound with a power-of-two capacity, which masks its indices.
+int wraparoundPowerOfTwo() {
+    cqueue::Queue<int, 8> queue;
+    return checkWraparound(queue);
+}
+
+// Checks FIFO order across the wraparound with any other capacity, which compares its indices.
+int wraparoundOtherCapacity() {
+    cqueue::Queue<int, 5> queue;
+    return checkWraparound(queue);
+}
+
+// Checks that move-only elements are moved in and out.
+int moveOnlyElements() {
+    cqueue::Queue<std::unique_ptr<int>, 4> queue;
+    std::unique_ptr<int> out;
+
+    assert(queue.enq(std::make_unique<int>(1)));
+    assert(queue.emplace(new int(2)));
+    assert(queue.deq(out));
+    assert(*out == 1);
+    assert(**queue.peek() == 2);
+    assert(queue.deq(out));
+    assert(*out == 2);
+    return TEST_SUCCESS;
+}
+
+// Checks that emplace constructs elements in place and that pop, clear and the destructor destroy them.
+int elementsConstructedAndDestroyed() {
+    {
+        cqueue::Queue<Tracked, 4> queue;
+        assert(queue.emplace(1, "one"));
+        assert(queue.emplace(2, "two"));
+        assert(queue.emplace(3, "three"));
+        assert(Tracked::live == 3);
+
+        assert(queue.peek()->tag == "one");
+        assert(queue.pop());
+        assert(Tracked::live == 2);
+        queue.clear();
+        assert(Tracked::live == 0);
+
+        assert(queue.emplace(4, "four"));
+        assert(queue.emplace(5, "five"));
+    }
+    assert(Tracked::live == 0);
+    return TEST_SUCCESS;
+}
+
+// Checks that the BlockingQueue keeps FIFO order between a producer and a consumer thread.
+int blockingTransfer() {
+    cqueue::BlockingQueue<std::unique_ptr<int>, 16> queue;
+    bool ordered = true;
+
+    std::thread consumer([&] {
+        for (int i = 0; i < TRANSFER_COUNT; i++) {
+            std::unique_ptr<int> element = queue.deq();
+            ordered = ordered && *element == i;
+        }
+    });
+    for (int i = 0; i < TRANSFER_COUNT; i++) {
+        queue.enq(std::make_unique<int>(i));
+    }
+    consumer.join();
+
+    assert(ordered);
+    assert(queue.isEmpty());
+    return TEST_SUCCESS;
+}
+
+// Checks that several producers and consumers transfer every element exactly once.
+int blockingManyThreads() {
+    const int threads = 4;
+    cqueue::BlockingQueue<int, 10> queue;
+    std::vector<std::thread> workers;
+    std::vector<long> sums(threads, 0);
+
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&queue] {
+            for (int i = 0; i < TRANSFER_COUNT / threads; i++)
+                queue.emplace(i);
+        });
+        workers.emplace_back([&queue, &sums, t] {
+            for (int i = 0; i < TRANSFER_COUNT / threads; i++)
+                sums[t] += queue.deq();
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    long total = 0, per_producer = (long)(TRANSFER_COUNT / threads) * (TRANSFER_COUNT / threads - 1) / 2;
+    for (long sum : sums) {
+        total += sum;
+    }
+    assert(total == per_producer * threads);
+    assert(queue.isEmpty());
+    return TEST_SUCCESS;
+}
+
+/*
+    **************** Exceptional test cases ****************
+*/
+
+// Checks that a full Queue rejects an element without moving from it, and an empty one leaves out alone.
+int fullAndEmptyLeaveArgumentsAlone() {
+    cqueue::Queue<std::unique_ptr<int>, 1> queue;
+    std::unique_ptr<int> element = std::make_unique<int>(7), out = std::make_unique<int>(8);
+
+    assert(queue.enq(std::make_unique<int>(1)));
+    assert(!queue.enq(std::move(element)));
+    assert(element != nullptr && *element == 7);
+
+    queue.clear();
+    assert(!queue.deq(out));
+    assert(*out == 8);
+    assert(!queue.pop());
+    return TEST_SUCCESS;
+}
+
+// Checks that tryEnq and tryDeq fail instead of blocking.
+int tryEnqTryDeqNeverBlock() {
+    cqueue::BlockingQueue<int, 2> queue;
+    int out = -1;
+
+    assert(!queue.tryDeq(out));
+    assert(out == -1);
+    assert(queue.tryEnq(1));
+    assert(queue.tryEnq(2));
+    assert(!queue.tryEnq(3));
+    assert(queue.tryDeq(out));
+    assert(out == 1);
+    queue.clear();
+    assert(queue.isEmpty());
+    return TEST_SUCCESS;
+}
+
+/*
+ * Main function for the template Queue tests which will run each user-defined test in turn.
+ */
+
+int main() {
+    runTest(newQueueIsEmpty);
+    runTest(wraparoundPowerOfTwo);
+    runTest(wraparoundOtherCapacity);
+    runTest(moveOnlyElements);
+    runTest(elementsConstructedAndDestroyed);
+    runTest(blockingTransfer);
+    runTest(blockingManyThreads);
+
+    runTest(fullAndEmptyLeaveArgumentsAlone);
+    runTest(tryEnqTryDeqNeverBlock);
+
+    printf("TemplateQueue Tests complete: %d / %d tests successful.\n----------------\n", success_count, total_count);
+
+}
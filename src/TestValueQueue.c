@@ -0,0 +1,176 @@
+/*
+ * TestValueQueue.c
+ *
+ * Very simple unit test file for ValueQueue functionality.
+ *
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include "myassert.h"
+#include "ValueQueue.h"
+
+
+#define DEFAULT_MAX_QUEUE_SIZE 20
+
+/*
+ * The element type stored in the queue during tests
+ */
+typedef struct {
+    int x;
+    int y;
+    char tag[8];
+} Struc;
+
+/*
+ * The queue to use during tests
+ */
+static ValueQueue *queue;
+
+/*
+ * The number of tests that succeeded
+ */
+static int success_count = 0;
+
+/*
+ * The total number of tests run
+ */
+static int total_count = 0;
+
+
+/*
+ * Setup function to run prior to each test
+ */
+void setup(){
+    queue = new_ValueQueue(DEFAULT_MAX_QUEUE_SIZE, sizeof(Struc));
+    total_count++;
+}
+
+/*
+ * Teardown function to run after each test
+ */
+void teardown(){
+    ValueQueue_destroy(queue);
+}
+
+/*
+ * This function is called multiple times from main for each user-defined test function
+ */
+void runTest(int (*testFunction)()) {
+    setup();
+
+    if (testFunction()) success_count++;
+
+    teardown();
+}
+
+
+/*
+    **************** Regular test cases ****************
+*/
+
+// Checks that the ValueQueue constructor returns a non-NULL pointer.
+int newQueueIsNotNull() {
+    assert(queue != NULL);
+    assert(ValueQueue_size(queue) == 0);
+    assert(ValueQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks that a struct is copied into the queue, so the original can change or go away.
+int queueStoresStructsByValue() {
+    Struc struc = {5, 10, "first"};
+    Struc out;
+
+    assert(ValueQueue_enq(queue, &struc));
+    struc.x = 0;
+    strcpy(struc.tag, "changed");
+
+    assert(ValueQueue_deq(queue, &out));
+    assert(out.x == 5);
+    assert(out.y == 10);
+    assert(strcmp(out.tag, "first") == 0);
+    return TEST_SUCCESS;
+}
+
+// Checks that front returns the oldest element in place without removing it.
+int frontDoesNotRemove() {
+    Struc a = {1, 2, "a"}, b = {3, 4, "b"};
+
+    assert(ValueQueue_enq(queue, &a));
+    assert(ValueQueue_enq(queue, &b));
+    assert(((Struc*)ValueQueue_front(queue))->x == 1);
+    assert(ValueQueue_size(queue) == 2);
+    assert(ValueQueue_deq(queue, NULL));
+    assert(((Struc*)ValueQueue_front(queue))->x == 3);
+    return TEST_SUCCESS;
+}
+
+// Checks that the queue is FIFO across the wrap point.
+int fifoAfterWrapping() {
+    Struc struc = {0, 0, ""};
+    Struc out;
+
+    for (int i = 0; i < 15; i++) {
+        assert(ValueQueue_enq(queue, &struc));
+        assert(ValueQueue_deq(queue, &out));
+    }
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        struc.x = i;
+        assert(ValueQueue_enq(queue, &struc));
+    }
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(ValueQueue_deq(queue, &out));
+        assert(out.x == i);
+    }
+    assert(ValueQueue_isEmpty(queue));
+    return TEST_SUCCESS;
+}
+
+// Checks clear function works correctly
+int clearQueue() {
+    Struc struc = {5, 10, ""};
+    for (int i = 0; i < 5; i++) {
+        assert(ValueQueue_enq(queue, &struc));
+    }
+    ValueQueue_clear(queue);
+    assert(ValueQueue_isEmpty(queue));
+    assert(ValueQueue_front(queue) == NULL);
+    return TEST_SUCCESS;
+}
+
+/*
+    **************** Exceptional test cases ****************
+*/
+
+// Checks that the queue rejects NULL, overfilling, and dequeuing when empty.
+int enqNullOverMaxDeqEmpty() {
+    Struc struc = {5, 10, ""};
+
+    assert(!ValueQueue_enq(queue, NULL));
+    assert(!ValueQueue_deq(queue, &struc));
+    for (int i = 0; i < DEFAULT_MAX_QUEUE_SIZE; i++) {
+        assert(ValueQueue_enq(queue, &struc));
+    }
+    assert(!ValueQueue_enq(queue, &struc));
+    assert(ValueQueue_size(queue) == DEFAULT_MAX_QUEUE_SIZE);
+    return TEST_SUCCESS;
+}
+
+/*
+ * Main function for the ValueQueue tests which will run each user-defined test in turn.
+ */
+
+int main() {
+    runTest(newQueueIsNotNull);
+    runTest(queueStoresStructsByValue);
+    runTest(frontDoesNotRemove);
+    runTest(fifoAfterWrapping);
+    runTest(clearQueue);
+
+    runTest(enqNullOverMaxDeqEmpty);
+
+    printf("ValueQueue Tests complete: %d / %d tests successful.\n----------------\n", success_count, total_count);
+
+}
@@ -0,0 +1,199 @@
+/*
+ * TestWorkStealingDeque.c
+ *
+ * Very simple unit test file for WorkStealingDeque functionality.
+ *
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "WorkStealingDeque.h"
+#include "myassert.h"
+
+
+#define DEFAULT_INITIAL_SIZE 4
+#define THIEF_COUNT 3
+#define TASK_COUNT 50000
+
+/*
+ * The deque to use during tests
+ */
+static WorkStealingDeque *deque;
+
+/*
+ * The number of tests that succeeded
+ */
+static int success_count = 0;
+
+/*
+ * The total number of tests run
+ */
+static int total_count = 0;
+
+/*
+ * Counts how many times each task was taken, and whether the owner has finished
+ */
+static atomic_int taken[TASK_COUNT + 1];
+static atomic_bool owner_done;
+
+
+/*
+ * Setup function to run prior to each test
+ */
+void setup(){
+    deque = new_WorkStealingDeque(DEFAULT_INITIAL_SIZE);
+    total_count++;
+}
+
+/*
+ * Teardown function to run after each test
+ */
+void teardown(){
+    WorkStealingDeque_destroy(deque);
+}
+
+/*
+ * This function is called multiple times from main for each user-defined test function
+ */
+void runTest(int (*testFunction)()) {
+    setup();
+
+    if (testFunction()) success_count++;
+
+    teardown();
+}
+
+// Thief thread which steals until the owner has finished and the deque is drained
+void* thiefFunc(void* arg) {
+    (void)arg;
+    while (!atomic_load(&owner_done) || !WorkStealingDeque_isEmpty(deque)) {
+        void *task = WorkStealingDeque_steal(deque);
+        if (task != NULL)
+            atomic_fetch_add(&taken[(intptr_t)task], 1);
+    }
+    return NULL;
+}
+
+
+/*
+    **************** Regular test cases ****************
+*/
+
+// Checks that the WorkStealingDeque constructor returns an empty deque.
+int newDequeIsEmpty() {
+    assert(deque != NULL);
+    assert(WorkStealingDeque_size(deque) == 0);
+    assert(WorkStealingDeque_isEmpty(deque));
+    return TEST_SUCCESS;
+}
+
+// Checks that the owner pops in LIFO order.
+int popIsLifo() {
+    int arr[3] = {1, 2, 3};
+    for (int i = 0; i < 3; i++) {
+        assert(WorkStealingDeque_push(deque, &arr[i]));
+    }
+    for (int i = 2; i >= 0; i--) {
+        assert(WorkStealingDeque_pop(deque) == &arr[i]);
+    }
+    assert(WorkStealingDeque_pop(deque) == NULL);
+    return TEST_SUCCESS;
+}
+
+// Checks that thieves steal in FIFO order from the other end.
+int stealIsFifo() {
+    int arr[3] = {1, 2, 3};
+    for (int i = 0; i < 3; i++) {
+        assert(WorkStealingDeque_push(deque, &arr[i]));
+    }
+    assert(WorkStealingDeque_steal(deque) == &arr[0]);
+    assert(WorkStealingDeque_pop(deque) == &arr[2]);
+    assert(WorkStealingDeque_steal(deque) == &arr[1]);
+    assert(WorkStealingDeque_steal(deque) == NULL);
+    return TEST_SUCCESS;
+}
+
+// Checks that the deque grows past its initial size and keeps every element.
+int growsWhenFull() {
+    int arr[DEFAULT_INITIAL_SIZE * 10];
+    // move top away from 0 first so the live range wraps when it grows
+    for (int i = 0; i < 3; i++) {
+        assert(WorkStealingDeque_push(deque, &arr[0]));
+        assert(WorkStealingDeque_steal(deque) == &arr[0]);
+    }
+    for (int i = 0; i < DEFAULT_INITIAL_SIZE * 10; i++) {
+        assert(WorkStealingDeque_push(deque, &arr[i]));
+    }
+    assert(WorkStealingDeque_size(deque) == DEFAULT_INITIAL_SIZE * 10);
+    for (int i = 0; i < DEFAULT_INITIAL_SIZE * 5; i++) {
+        assert(WorkStealingDeque_steal(deque) == &arr[i]);
+    }
+    for (int i = DEFAULT_INITIAL_SIZE * 10 - 1; i >= DEFAULT_INITIAL_SIZE * 5; i--) {
+        assert(WorkStealingDeque_pop(deque) == &arr[i]);
+    }
+    assert(WorkStealingDeque_isEmpty(deque));
+    return TEST_SUCCESS;
+}
+
+// Checks that NULL elements are rejected.
+int pushNull() {
+    assert(!WorkStealingDeque_push(deque, NULL));
+    assert(WorkStealingDeque_isEmpty(deque));
+    return TEST_SUCCESS;
+}
+
+/*
+    **************** Concurrency test cases ****************
+*/
+
+// Checks that every task is taken exactly once when the owner pops while thieves steal.
+int ownerAndThievesTakeEachTaskOnce() {
+    pthread_t thieves[THIEF_COUNT];
+
+    atomic_store(&owner_done, false);
+    for (int i = 0; i < THIEF_COUNT; i++) {
+        pthread_create(&thieves[i], NULL, thiefFunc, NULL);
+    }
+    for (intptr_t i = 1; i <= TASK_COUNT; i++) {
+        assert(WorkStealingDeque_push(deque, (void*)i));
+        if (i % 2 == 0) {
+            void *task = WorkStealingDeque_pop(deque);
+            if (task != NULL)
+                atomic_fetch_add(&taken[(intptr_t)task], 1);
+        }
+    }
+    void *task;
+    while ((task = WorkStealingDeque_pop(deque)) != NULL) {
+        atomic_fetch_add(&taken[(intptr_t)task], 1);
+    }
+    atomic_store(&owner_done, true);
+    for (int i = 0; i < THIEF_COUNT; i++) {
+        pthread_join(thieves[i], NULL);
+    }
+
+    for (int i = 1; i <= TASK_COUNT; i++) {
+        assert(atomic_load(&taken[i]) == 1);
+    }
+    return TEST_SUCCESS;
+}
+
+/*
+ * Main function for the WorkStealingDeque tests which will run each user-defined test in turn.
+ */
+
+int main() {
+    runTest(newDequeIsEmpty);
+    runTest(popIsLifo);
+    runTest(stealIsFifo);
+    runTest(growsWhenFull);
+
+    runTest(pushNull);
+
+    runTest(ownerAndThievesTakeEachTaskOnce);
+
+    printf("\nWorkStealingDeque Tests complete: %d / %d tests successful.\n----------------\n", success_count, total_count);
+
+}
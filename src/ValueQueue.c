@@ -0,0 +1,95 @@
+/*
+ * ValueQueue.c
+ *
+ * Fixed-size array-based Queue implementation storing elements by value.
+ *
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ValueQueue.h"
+
+
+ValueQueue *new_ValueQueue(int max_size, size_t elem_size) {
+    if (elem_size == 0) return NULL;
+
+    ValueQueue *Q = malloc(sizeof(ValueQueue));
+    if (Q == NULL) return NULL;
+
+    Q->elem_size = elem_size;
+    Q->max_size = max_size+1; // one extra space to distinguish between full and empty
+    Q->size = 0; // current size
+    Q->head = 0; // write index
+    Q->tail = 0; // read index
+    Q->data = malloc(Q->max_size * elem_size);
+
+    if (Q->data == NULL) {
+        free(Q);
+        return NULL;
+    }
+    return Q;
+}
+
+bool ValueQueue_enq(ValueQueue* this, const void* element) {
+    int next;
+
+    next = (this->head + 1);
+    if (next >= this->max_size)
+        next = 0;
+
+    if (next == this->tail || element == NULL)
+        return false;
+
+    memcpy(this->data + (size_t)this->head * this->elem_size, element, this->elem_size);
+    this->head = next;
+    this->size++;
+    return true;
+}
+
+bool ValueQueue_deq(ValueQueue* this, void* out) {
+    int next;
+
+    if (ValueQueue_isEmpty(this))
+        return false;
+
+    next = (this->tail + 1);
+    if (next >= this->max_size)
+        next = 0;
+
+    if (out != NULL)
+        memcpy(out, this->data + (size_t)this->tail * this->elem_size, this->elem_size);
+    this->tail = next;
+    this->size--;
+    return true;
+}
+
+void* ValueQueue_front(ValueQueue* this) {
+    if (ValueQueue_isEmpty(this))
+        return NULL;
+    return this->data + (size_t)this->tail * this->elem_size;
+}
+
+int ValueQueue_size(ValueQueue* this) {
+    return this->size;
+}
+
+bool ValueQueue_isEmpty(ValueQueue* this) {
+    return (this->tail == this->head);
+}
+
+void ValueQueue_clear(ValueQueue* this) {
+    if(this) {
+        this->head = 0;
+        this->tail = 0;
+        this->size = 0;
+    }
+}
+
+void ValueQueue_destroy(ValueQueue* this) {
+    if(this) {
+        free(this->data);
+        free(this);
+    }
+}
@@ -0,0 +1,71 @@
+/*
+ * ValueQueue.h
+ *
+ * Module interface for a fixed-size Queue which stores elements by value.
+ *
+ * Unlike Queue, which stores void* elements that must stay alive while queued,
+ * a ValueQueue copies each elem_size-byte element into a contiguous slot array,
+ * so callers need no per-element allocation.
+ *
+ */
+
+#ifndef VALUE_QUEUE_H_
+#define VALUE_QUEUE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct ValueQueue ValueQueue;
+
+struct ValueQueue {
+    char* data; // max_size slots of elem_size bytes each
+    size_t elem_size;
+    int max_size, size, head, tail;
+};
+
+/*
+ * Creates a new ValueQueue for at most max_size elements of elem_size bytes each.
+ * Returns a pointer to a new ValueQueue on success and NULL on failure.
+ */
+ValueQueue* new_ValueQueue(int max_size, size_t elem_size);
+
+/*
+ * Copies the elem_size bytes at element to the back of this Queue.
+ * Returns true on success and false on enq failure when element is NULL or queue is full.
+ */
+bool ValueQueue_enq(ValueQueue* this, const void* element);
+
+/*
+ * Dequeues the element at the front of this Queue, copying its elem_size bytes to out.
+ * out may be NULL to discard the element.
+ * Returns true on success or false if queue is empty.
+ */
+bool ValueQueue_deq(ValueQueue* this, void* out);
+
+/*
+ * Returns a pointer to the element at the front of this Queue, or NULL if queue is empty.
+ * The pointer is only valid until the next operation on this Queue.
+ */
+void* ValueQueue_front(ValueQueue* this);
+
+/*
+ * Returns the number of elements currently in this Queue.
+ */
+int ValueQueue_size(ValueQueue* this);
+
+/*
+ * Returns true if this Queue is empty, false otherwise.
+ */
+bool ValueQueue_isEmpty(ValueQueue* this);
+
+/*
+ * Clears this Queue returning it to an empty state.
+ */
+void ValueQueue_clear(ValueQueue* this);
+
+/*
+ * Destroys this Queue by freeing the memory used by the Queue.
+ */
+void ValueQueue_destroy(ValueQueue* this);
+
+#endif /* VALUE_QUEUE_H_ */
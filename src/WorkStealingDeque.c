@@ -0,0 +1,142 @@
+/*
+ * WorkStealingDeque.c
+ *
+ * Growable Chase-Lev work-stealing deque implementation, using the C11 memory
+ * orderings from Le et al., "Correct and Efficient Work-Stealing for Weak Memory Models".
+ *
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "WorkStealingDeque.h"
+
+
+static DequeArray* newArray(long capacity) {
+    DequeArray *a = malloc(sizeof(DequeArray) + capacity * sizeof(_Atomic(void*)));
+    if (a == NULL) return NULL;
+
+    a->retired = NULL;
+    a->mask = capacity - 1;
+    return a;
+}
+
+/*
+ * Replaces the full array with one twice the size, copying the live range [top, bottom).
+ * Indices are never rebased, so index i lives at i & mask in both arrays.
+ */
+static DequeArray* grow(WorkStealingDeque* this, DequeArray* old, long top, long bottom) {
+    DequeArray *a = newArray((old->mask + 1) * 2);
+    if (a == NULL) return NULL;
+
+    for (long i = top; i < bottom; i++) {
+        void *elem = atomic_load_explicit(&old->data[i & old->mask], memory_order_relaxed);
+        atomic_store_explicit(&a->data[i & a->mask], elem, memory_order_relaxed);
+    }
+    a->retired = old;
+    atomic_store_explicit(&this->array, a, memory_order_release);
+    return a;
+}
+
+WorkStealingDeque *new_WorkStealingDeque(int initial_size) {
+    long capacity = 1;
+    while (capacity < initial_size)
+        capacity <<= 1;
+
+    // aligned_alloc needs a size that is a multiple of the alignment
+    size_t bytes = (sizeof(WorkStealingDeque) + DEQUE_CACHE_LINE - 1) / DEQUE_CACHE_LINE * DEQUE_CACHE_LINE;
+    WorkStealingDeque *D = aligned_alloc(DEQUE_CACHE_LINE, bytes);
+    if (D == NULL) return NULL;
+
+    DequeArray *a = newArray(capacity);
+    if (a == NULL) {
+        free(D);
+        return NULL;
+    }
+    atomic_init(&D->top, 0);
+    atomic_init(&D->bottom, 0);
+    atomic_init(&D->array, a);
+    return D;
+}
+
+bool WorkStealingDeque_push(WorkStealingDeque* this, void* element) {
+    if (element == NULL)
+        return false;
+
+    long b = atomic_load_explicit(&this->bottom, memory_order_relaxed);
+    long t = atomic_load_explicit(&this->top, memory_order_acquire);
+    DequeArray *a = atomic_load_explicit(&this->array, memory_order_relaxed);
+
+    if (b - t > a->mask) {
+        a = grow(this, a, t, b);
+        if (a == NULL)
+            return false;
+    }
+    atomic_store_explicit(&a->data[b & a->mask], element, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release); // publish the element before the new bottom
+    atomic_store_explicit(&this->bottom, b + 1, memory_order_relaxed);
+    return true;
+}
+
+void* WorkStealingDeque_pop(WorkStealingDeque* this) {
+    long b = atomic_load_explicit(&this->bottom, memory_order_relaxed) - 1;
+    DequeArray *a = atomic_load_explicit(&this->array, memory_order_relaxed);
+    void *elem = NULL;
+
+    // reserve the bottom element before looking at top, so a thief can't take it unseen
+    atomic_store_explicit(&this->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = atomic_load_explicit(&this->top, memory_order_relaxed);
+
+    if (t <= b) {
+        elem = atomic_load_explicit(&a->data[b & a->mask], memory_order_relaxed);
+        if (t == b) {
+            // last element: race thieves for it through top
+            if (!atomic_compare_exchange_strong_explicit(&this->top, &t, t + 1,
+                                                         memory_order_seq_cst, memory_order_relaxed))
+                elem = NULL;
+            atomic_store_explicit(&this->bottom, b + 1, memory_order_relaxed);
+        }
+    } else {
+        atomic_store_explicit(&this->bottom, b + 1, memory_order_relaxed); // was empty
+    }
+    return elem;
+}
+
+void* WorkStealingDeque_steal(WorkStealingDeque* this) {
+    long t = atomic_load_explicit(&this->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&this->bottom, memory_order_acquire);
+
+    if (t >= b)
+        return NULL;
+
+    DequeArray *a = atomic_load_explicit(&this->array, memory_order_acquire);
+    void *elem = atomic_load_explicit(&a->data[t & a->mask], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&this->top, &t, t + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed))
+        return NULL; // lost the race to the owner or another thief
+    return elem;
+}
+
+int WorkStealingDeque_size(WorkStealingDeque* this) {
+    long b = atomic_load_explicit(&this->bottom, memory_order_relaxed);
+    long t = atomic_load_explicit(&this->top, memory_order_relaxed);
+    return b > t ? (int)(b - t) : 0;
+}
+
+bool WorkStealingDeque_isEmpty(WorkStealingDeque* this) {
+    return WorkStealingDeque_size(this) == 0;
+}
+
+void WorkStealingDeque_destroy(WorkStealingDeque* this) {
+    if(this) {
+        DequeArray *a = atomic_load(&this->array);
+        while (a != NULL) {
+            DequeArray *retired = a->retired;
+            free(a);
+            a = retired;
+        }
+        free(this);
+    }
+}
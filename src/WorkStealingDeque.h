@@ -0,0 +1,80 @@
+/*
+ * WorkStealingDeque.h
+ *
+ * Module interface for a generic Chase-Lev work-stealing deque.
+ *
+ * The owning thread pushes and pops void* elements at the bottom without locks, while
+ * any number of thief threads steal from the top with a single CAS. Elements live in a
+ * power-of-two circular array which the owner doubles when it fills up; replaced arrays
+ * are kept until the deque is destroyed since a thief may still be reading one.
+ *
+ */
+
+#ifndef WORK_STEALING_DEQUE_H_
+#define WORK_STEALING_DEQUE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#define DEQUE_CACHE_LINE 64
+
+typedef struct DequeArray DequeArray;
+typedef struct WorkStealingDeque WorkStealingDeque;
+
+struct DequeArray {
+    DequeArray* retired; // the smaller array this one replaced
+    long mask; // capacity - 1, capacity being a power of two
+    _Atomic(void*) data[];
+};
+
+struct WorkStealingDeque {
+    _Alignas(DEQUE_CACHE_LINE) atomic_long top; // next index to steal from
+    _Alignas(DEQUE_CACHE_LINE) atomic_long bottom; // next index to push to
+    _Atomic(DequeArray*) array;
+};
+
+/*
+ * Creates a new WorkStealingDeque with room for at least initial_size void* elements before growing.
+ * Returns a pointer to a new WorkStealingDeque on success and NULL on failure.
+ */
+WorkStealingDeque* new_WorkStealingDeque(int initial_size);
+
+/*
+ * Pushes the given void* element onto the bottom of this Deque, growing it if full.
+ * Must only be called from the owning thread.
+ * Returns true on success and false when element is NULL or out of memory.
+ */
+bool WorkStealingDeque_push(WorkStealingDeque* this, void* element);
+
+/*
+ * Pops the most recently pushed element from the bottom of this Deque.
+ * Must only be called from the owning thread.
+ * Returns the popped void* element on success or NULL if the deque is empty.
+ */
+void* WorkStealingDeque_pop(WorkStealingDeque* this);
+
+/*
+ * Steals the oldest element from the top of this Deque. May be called from any thread.
+ * Returns the stolen void* element on success, or NULL if the deque is empty or another
+ * thread took the element first.
+ */
+void* WorkStealingDeque_steal(WorkStealingDeque* this);
+
+/*
+ * Returns the number of elements currently in this Deque.
+ * The result is only a snapshot when other threads are using the deque.
+ */
+int WorkStealingDeque_size(WorkStealingDeque* this);
+
+/*
+ * Returns true if this Deque is empty, false otherwise.
+ */
+bool WorkStealingDeque_isEmpty(WorkStealingDeque* this);
+
+/*
+ * Destroys this Deque by freeing the memory used by the Deque and every array it has used.
+ */
+void WorkStealingDeque_destroy(WorkStealingDeque* this);
+
+#endif /* WORK_STEALING_DEQUE_H_ */